@@ -8,6 +8,8 @@
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
 #include "core/core.h"
+#include "core/frame_dumper.h"
+#include "core/frame_feed.h"
 #include "core/settings.h"
 
 namespace AudioCore {
@@ -39,6 +41,12 @@ void DspInterface::EnableStretching(bool enable) {
 }
 
 void DspInterface::OutputFrame(StereoFrame16& frame) {
+    Core::FrameDumper& dumper = Core::System::GetInstance().FrameDumper();
+    if (dumper.IsDumping()) {
+        dumper.AddAudioSamples(frame.data(), frame.size());
+    }
+    Core::System::GetInstance().FrameFeed().AddAudioSamples(frame.data(), frame.size());
+
     if (sink == nullptr) {
         return;
     }
@@ -47,6 +55,12 @@ void DspInterface::OutputFrame(StereoFrame16& frame) {
 }
 
 void DspInterface::OutputSample(std::array<s16, 2> sample) {
+    Core::FrameDumper& dumper = Core::System::GetInstance().FrameDumper();
+    if (dumper.IsDumping()) {
+        dumper.AddAudioSamples(&sample, 1);
+    }
+    Core::System::GetInstance().FrameFeed().AddAudioSamples(&sample, 1);
+
     if (sink == nullptr) {
         return;
     }
@@ -40,7 +40,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <unistd.h>
 #endif
@@ -360,6 +362,33 @@ u64 GetSize(FILE* f) {
     return size;
 }
 
+s64 GetModificationTime(const std::string& filename) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (GetFileAttributesExW(Common::UTF8ToUTF16W(filename).c_str(), GetFileExInfoStandard,
+                             &attributes)) {
+        // FILETIME counts 100 nanosecond intervals since 1601-01-01
+        constexpr s64 EPOCH_DIFFERENCE = 116444736000000000;
+        const s64 intervals =
+            (static_cast<s64>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+            attributes.ftLastWriteTime.dwLowDateTime;
+        return (intervals - EPOCH_DIFFERENCE) * 100;
+    }
+#else
+    struct stat buf;
+    if (stat(filename.c_str(), &buf) == 0) {
+#ifdef __APPLE__
+        const timespec& time = buf.st_mtimespec;
+#else
+        const timespec& time = buf.st_mtim;
+#endif
+        return static_cast<s64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+    }
+#endif
+
+    return 0;
+}
+
 bool CreateEmptyFile(const std::string& filename) {
     LOG_TRACE(Common_Filesystem, "{}", filename);
 
@@ -557,6 +586,7 @@ static void InitUserPaths() {
     user_path = user_path.substr(0, dirname_length);
     user_path += "/user/";
 
+    g_paths[UserPath::CacheDir] = user_path + "cache/";
     g_paths[UserPath::SDMCDir] = user_path + "sdmc/";
     g_paths[UserPath::NANDDir] = user_path + "nand/";
     g_paths[UserPath::SysDataDir] = user_path + "sysdata/";
@@ -813,4 +843,103 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+MappedFile::MappedFile() {}
+
+MappedFile::MappedFile(const std::string& filename) {
+    Open(filename);
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    Swap(other);
+    return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+#ifdef _WIN32
+    std::swap(mapping_handle, other.mapping_handle);
+#endif
+}
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(Common::UTF8ToUTF16W(filename).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mapping_handle = mapping;
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    const u64 file_size = FileUtil::GetSize(fd);
+    if (file_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "mmap failed {}: {}", filename, GetLastErrorMsg());
+        return false;
+    }
+
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(file_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping_handle);
+    mapping_handle = nullptr;
+#else
+    munmap(const_cast<u8*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
 } // namespace FileUtil
@@ -27,6 +27,7 @@ namespace FileUtil {
 
 // User paths for GetUserPath
 enum class UserPath {
+    CacheDir,
     CheatsDir,
     DumpDir,
     LoadDir,
@@ -64,6 +65,10 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in nanoseconds since the epoch, or 0 on failure.
+// The precision depends on the file system, on Windows it's 100 nanoseconds.
+s64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -262,6 +267,41 @@ private:
     bool m_good = true;
 };
 
+// Read-only memory mapping of a whole file. The mapping stays valid until the object is destroyed.
+class MappedFile : public NonCopyable {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    void Swap(MappedFile& other) noexcept;
+
+    bool Open(const std::string& filename);
+    void Close();
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* GetData() const {
+        return data;
+    }
+
+    std::size_t GetSize() const {
+        return size;
+    }
+
+private:
+    const u8* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
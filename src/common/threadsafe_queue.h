@@ -7,6 +7,7 @@
 // a simple lockless thread-safe,
 // single reader, single writer queue
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
@@ -14,6 +15,9 @@
 #include <utility>
 
 namespace Common {
+
+/// Assumed size of a cache line, used to keep data written by different threads apart
+constexpr std::size_t CACHE_LINE_SIZE = 64;
 template <typename T>
 class SPSCQueue {
 public:
@@ -169,4 +173,73 @@ private:
     SPSCQueue<T> spsc_queue;
     std::mutex write_lock;
 };
+
+// a bounded, allocation-free lockless queue,
+// single reader, multiple writers
+
+template <typename T, std::size_t capacity>
+class BoundedMPSCQueue {
+    static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+    static_assert(std::atomic<std::size_t>::is_always_lock_free);
+
+public:
+    BoundedMPSCQueue() {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Adds an element, returns false without blocking if the queue is full
+    template <typename Arg>
+    bool TryPush(Arg&& t) {
+        std::size_t position = write_index.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[position & (capacity - 1)];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                // The slot is free, claim it
+                if (write_index.compare_exchange_weak(position, position + 1,
+                                                      std::memory_order_relaxed)) {
+                    slot.value = std::forward<Arg>(t);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // The reader hasn't popped the element written a lap ago yet
+                return false;
+            } else {
+                // Another writer claimed the slot first
+                position = write_index.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Removes the oldest element, only call from the reader thread
+    bool Pop(T& t) {
+        Slot& slot = slots[read_index & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != read_index + 1) {
+            return false;
+        }
+
+        t = std::move(slot.value);
+        slot.sequence.store(read_index + capacity, std::memory_order_release);
+        ++read_index;
+        return true;
+    }
+
+private:
+    struct Slot {
+        // Equal to the write position the slot is free for, or one past the position it holds
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    // Writers and the reader each get their own cache line
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> write_index{0};
+    alignas(CACHE_LINE_SIZE) std::size_t read_index = 0;
+    alignas(CACHE_LINE_SIZE) std::array<Slot, capacity> slots;
+};
 } // namespace Common
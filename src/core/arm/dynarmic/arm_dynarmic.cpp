@@ -3,14 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <type_traits>
 #include <dynarmic/A32/a32.h>
 #include <dynarmic/A32/context.h>
 #include <dynarmic/exclusive_monitor.h>
 #include "common/assert.h"
+#include "common/atomic_ops.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/cpu_core_threads.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
@@ -74,51 +77,64 @@ public:
         : parent(parent), svc_context(parent.system), memory(parent.memory) {}
     ~DynarmicUserCallbacks() = default;
 
+    std::uint32_t MemoryReadCode(VAddr vaddr) override {
+        // Instruction fetches don't trigger read breakpoints
+        if (const u8* pointer = parent.current_page_table->Get(vaddr)) {
+            u32 value;
+            std::memcpy(&value, pointer, sizeof(value));
+            return value;
+        }
+        return OnSystemThread([&] { return memory.Read32(vaddr); });
+    }
+
     std::uint8_t MemoryRead8(VAddr vaddr) override {
-        return memory.Read8(vaddr);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
+        return OnSystemThread([&] { return memory.Read8(vaddr); });
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
-        return memory.Read16(vaddr);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
+        return OnSystemThread([&] { return memory.Read16(vaddr); });
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
-        return memory.Read32(vaddr);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
+        return OnSystemThread([&] { return memory.Read32(vaddr); });
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
-        return memory.Read64(vaddr);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Read);
+        return OnSystemThread([&] { return memory.Read64(vaddr); });
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
-        memory.Write8(vaddr, value);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
+        OnSystemThread([&] { memory.Write8(vaddr, value); });
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
-        memory.Write16(vaddr, value);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
+        OnSystemThread([&] { memory.Write16(vaddr, value); });
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
-        memory.Write32(vaddr, value);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
+        OnSystemThread([&] { memory.Write32(vaddr, value); });
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
-        memory.Write64(vaddr, value);
+        CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
+        OnSystemThread([&] { memory.Write64(vaddr, value); });
     }
 
-    bool MemoryWriteExclusive8(VAddr vaddr, std::uint8_t value,
-                               [[maybe_unused]] std::uint8_t expected) override {
-        MemoryWrite8(vaddr, value);
-        return true;
+    bool MemoryWriteExclusive8(VAddr vaddr, std::uint8_t value, std::uint8_t expected) override {
+        return WriteExclusive(vaddr, value, expected, &DynarmicUserCallbacks::MemoryWrite8);
     }
     bool MemoryWriteExclusive16(VAddr vaddr, std::uint16_t value,
-                                [[maybe_unused]] std::uint16_t expected) override {
-        MemoryWrite16(vaddr, value);
-        return true;
+                                std::uint16_t expected) override {
+        return WriteExclusive(vaddr, value, expected, &DynarmicUserCallbacks::MemoryWrite16);
     }
     bool MemoryWriteExclusive32(VAddr vaddr, std::uint32_t value,
-                                [[maybe_unused]] std::uint32_t expected) override {
-        MemoryWrite32(vaddr, value);
-        return true;
+                                std::uint32_t expected) override {
+        return WriteExclusive(vaddr, value, expected, &DynarmicUserCallbacks::MemoryWrite32);
     }
     bool MemoryWriteExclusive64(VAddr vaddr, std::uint64_t value,
-                                [[maybe_unused]] std::uint64_t expected) override {
-        MemoryWrite64(vaddr, value);
-        return true;
+                                std::uint64_t expected) override {
+        return WriteExclusive(vaddr, value, expected, &DynarmicUserCallbacks::MemoryWrite64);
     }
 
     void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {
@@ -128,7 +144,7 @@ public:
     }
 
     void CallSVC(std::uint32_t swi) override {
-        svc_context.CallSVC(swi);
+        OnSystemThread([&] { svc_context.CallSVC(swi); });
     }
 
     void ExceptionRaised(VAddr pc, Dynarmic::A32::Exception exception) override {
@@ -165,6 +181,58 @@ public:
         return static_cast<u64>(ticks <= 0 ? 0 : ticks);
     }
 
+    void CheckMemoryBreakpoint(VAddr vaddr, GDBStub::BreakpointType type) {
+        if (parent.check_memory_breakpoints && GDBStub::CheckBreakpoint(vaddr, type)) {
+            // The JIT stops at the end of the current block
+            GDBStub::Break(true);
+            parent.jit->HaltExecution();
+        }
+    }
+
+    /**
+     * Exclusive stores to plain memory compare and swap, as the other cores may store to the same
+     * address on their threads. The global monitor only orders the exclusive accesses.
+     */
+    template <typename T>
+    bool WriteExclusive(VAddr vaddr, T value, T expected,
+                        void (DynarmicUserCallbacks::*write)(VAddr, T)) {
+        if (u8* pointer = parent.current_page_table->Get(vaddr)) {
+            CheckMemoryBreakpoint(vaddr, GDBStub::BreakpointType::Write);
+            return Common::AtomicCompareAndSwap(reinterpret_cast<volatile T*>(pointer), value,
+                                                expected);
+        }
+        (this->*write)(vaddr, value);
+        return true;
+    }
+
+    /**
+     * When the cores run on separate host threads, everything but guest code has to run on the
+     * emulation thread. Memory callbacks are only used for memory that isn't plain RAM. The other
+     * cores may have used the emulation thread since this one started running, so this one is
+     * made the running core again first.
+     */
+    template <typename Function>
+    auto OnSystemThread(Function&& function) -> decltype(function()) {
+        Core::CPUCoreThreads* threads = parent.system.GetCPUCoreThreads();
+        if (threads == nullptr || !threads->IsCoreThread()) {
+            return function();
+        }
+
+        if constexpr (std::is_void_v<decltype(function())>) {
+            threads->CallOnSystemThread([&] {
+                parent.system.SetRunningCore(parent);
+                function();
+            });
+        } else {
+            decltype(function()) result{};
+            threads->CallOnSystemThread([&] {
+                parent.system.SetRunningCore(parent);
+                result = function();
+            });
+            return result;
+        }
+    }
+
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
@@ -181,11 +249,25 @@ ARM_Dynarmic::ARM_Dynarmic(Core::System* system, Memory::MemorySystem& memory, u
 ARM_Dynarmic::~ARM_Dynarmic() = default;
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    ApplyPendingChanges();
+
+    if (GDBStub::HasMemoryBreakpoints() != check_memory_breakpoints) {
+        check_memory_breakpoints = !check_memory_breakpoints;
+        RebuildJits();
+    }
+
     jit->Run();
+
+    ApplyPendingChanges();
+
+    if (GDBStub::IsMemoryBreak()) {
+        ServeBreak();
+    }
 }
 
 void ARM_Dynarmic::Step() {
+    ApplyPendingChanges();
+
     jit->Step();
 
     if (GDBStub::IsConnected()) {
@@ -300,17 +382,60 @@ void ARM_Dynarmic::PrepareReschedule() {
 }
 
 void ARM_Dynarmic::ClearInstructionCache() {
+    if (system.GetCPUCoreThreads() != nullptr) {
+        {
+            std::lock_guard lock(pending_invalidations_mutex);
+            pending_clear = true;
+            pending_invalidations.clear();
+        }
+        jit->HaltExecution();
+        return;
+    }
+
     for (const auto& j : jits) {
         j.second->ClearCache();
     }
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
-    jit->InvalidateCacheRange(start_address, length);
+    if (system.GetCPUCoreThreads() != nullptr) {
+        {
+            std::lock_guard lock(pending_invalidations_mutex);
+            if (!pending_clear) {
+                pending_invalidations.emplace_back(start_address, length);
+            }
+        }
+        jit->HaltExecution();
+        return;
+    }
+
+    // The JITs of the other page tables may have compiled the same code, the memory can be shared
+    for (const auto& j : jits) {
+        j.second->InvalidateCacheRange(start_address, length);
+    }
 }
 
 void ARM_Dynarmic::PageTableChanged() {
-    current_page_table = memory.GetCurrentPageTable();
+    Memory::PageTable* page_table = memory.GetCurrentPageTable();
+
+    // The kernel can switch this core's process while it's in a callback. Its registers are in
+    // the running JIT, so switch when it stops.
+    if (jit != nullptr && jit->IsExecuting()) {
+        if (page_table != current_page_table) {
+            pending_page_table = page_table;
+            jit->HaltExecution();
+        } else {
+            pending_page_table = nullptr;
+        }
+        return;
+    }
+
+    pending_page_table = nullptr;
+    SwitchJit(page_table);
+}
+
+void ARM_Dynarmic::SwitchJit(Memory::PageTable* page_table) {
+    current_page_table = page_table;
 
     auto iter = jits.find(current_page_table);
     if (iter != jits.end()) {
@@ -323,6 +448,42 @@ void ARM_Dynarmic::PageTableChanged() {
     jits.emplace(current_page_table, std::move(new_jit));
 }
 
+void ARM_Dynarmic::ApplyPendingChanges() {
+    if (pending_page_table != nullptr) {
+        std::unique_ptr<ThreadContext> context = NewContext();
+        SaveContext(context);
+
+        SwitchJit(pending_page_table);
+        pending_page_table = nullptr;
+
+        LoadContext(context);
+    }
+
+    std::lock_guard lock(pending_invalidations_mutex);
+    if (pending_clear) {
+        for (const auto& j : jits) {
+            j.second->ClearCache();
+        }
+        pending_clear = false;
+    }
+    for (const auto& [start_address, length] : pending_invalidations) {
+        for (const auto& j : jits) {
+            j.second->InvalidateCacheRange(start_address, length);
+        }
+    }
+    pending_invalidations.clear();
+}
+
+void ARM_Dynarmic::RebuildJits() {
+    std::unique_ptr<ThreadContext> context = NewContext();
+    SaveContext(context);
+
+    jits.clear();
+    SwitchJit(current_page_table);
+
+    LoadContext(context);
+}
+
 void ARM_Dynarmic::ServeBreak() {
     Kernel::Thread* thread = system.Kernel().GetCurrentThreadManager().GetCurrentThread();
     SaveContext(thread->context);
@@ -334,7 +495,9 @@ std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.global_monitor = exclusive_monitor;
     config.callbacks = cb.get();
-    if (current_page_table) {
+    // Without a page table every memory access goes through the callbacks, which check the read
+    // and write breakpoints. Execution breakpoints are traps that don't need this.
+    if (current_page_table && !check_memory_breakpoints) {
         config.page_table = &current_page_table->pointers;
         config.fastmem_pointer = current_page_table->fastmem_base.Get();
     }
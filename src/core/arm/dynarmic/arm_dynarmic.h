@@ -7,6 +7,9 @@
 #include <dynarmic/A32/a32.h>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
@@ -58,6 +61,15 @@ public:
 private:
     void ServeBreak();
 
+    /// Recreates the JITs, keeping the current context
+    void RebuildJits();
+
+    /// Makes the JIT for the page table the current one
+    void SwitchJit(Memory::PageTable* page_table);
+
+    /// Applies the page table change and the cache invalidations requested while running
+    void ApplyPendingChanges();
+
     friend class DynarmicUserCallbacks;
     Core::System& system;
     Memory::MemorySystem& memory;
@@ -68,7 +80,17 @@ private:
     CP15State cp15_state;
 
     Dynarmic::A32::Jit* jit = nullptr;
+    /// The page table of this core's JIT. The memory system's one belongs to the running core.
     Memory::PageTable* current_page_table = nullptr;
+    /// Page table to switch to when the JIT stops, nullptr if it didn't change while running
+    Memory::PageTable* pending_page_table = nullptr;
+    bool check_memory_breakpoints = false;
     std::map<Memory::PageTable*, std::unique_ptr<Dynarmic::A32::Jit>> jits;
     Dynarmic::ExclusiveMonitor* exclusive_monitor;
+
+    // When the cores run on their own threads, other threads can't touch the JITs, so they queue
+    // the cache invalidations here and the core's thread applies them before it runs again.
+    std::mutex pending_invalidations_mutex;
+    std::vector<std::pair<u32, std::size_t>> pending_invalidations;
+    bool pending_clear = false;
 };
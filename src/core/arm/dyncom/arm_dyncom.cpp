@@ -88,6 +88,7 @@ void ARM_DynCom::Step() {
 void ARM_DynCom::ClearInstructionCache() {
     state->instruction_cache.clear();
     trans_cache_buf_top = 0;
+    ++trans_cache_buf_resets;
 }
 
 void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
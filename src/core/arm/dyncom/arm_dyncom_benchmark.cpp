@@ -0,0 +1,101 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "core/arm/dyncom/arm_dyncom_benchmark.h"
+#include "core/arm/dyncom/arm_dyncom_interpreter.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "core/memory.h"
+
+namespace {
+
+constexpr VAddr CODE_ADDRESS = 0x00100000;
+constexpr VAddr DATA_ADDRESS = 0x00200000;
+
+/// Instructions run per call to InterpreterMainLoop, like a slice of emulation
+constexpr u64 SLICE_INSTRUCTIONS = 100000;
+
+// Both loops load two words from DATA_ADDRESS, add and subtract them from a sum, and count until
+// the counter wraps around:
+//     loop: ldr r2, [r0]
+//           add r3, r3, r2
+//           ldr r2, [r0, #4]
+//           sub r3, r3, r2
+//           add r1, r1, #1
+//           cmp r1, #0
+//           bne loop
+//           b loop
+
+constexpr std::array<u32, 11> ARM_CODE = {
+    0xE3A00602, // mov r0, #0x200000
+    0xE3A01000, // mov r1, #0
+    0xE3A03000, // mov r3, #0
+    0xE5902000, 0xE0833002, 0xE5902004, 0xE0433002, 0xE2811001, 0xE3510000, 0x1AFFFFF8, 0xEAFFFFF7,
+};
+
+constexpr std::array<u16, 12> THUMB_CODE = {
+    0x2001, // movs r0, #1
+    0x0540, // lsls r0, r0, #21
+    0x2100, // movs r1, #0
+    0x2300, // movs r3, #0
+    0x6802, 0x189B, 0x6842, 0x1A9B, 0x3101, 0x2900, 0xD1F8, 0xE7F7,
+};
+
+} // namespace
+
+InterpreterBenchmarkResult BenchmarkInterpreter(u64 instruction_count, bool thumb) {
+    Memory::MemorySystem memory;
+    auto page_table = std::make_unique<Memory::PageTable>();
+    memory.ResetPageTable(*page_table);
+
+    std::vector<u8> code(Memory::PAGE_SIZE);
+    std::vector<u8> data(Memory::PAGE_SIZE);
+    if (thumb) {
+        std::memcpy(code.data(), THUMB_CODE.data(), sizeof(THUMB_CODE));
+    } else {
+        std::memcpy(code.data(), ARM_CODE.data(), sizeof(ARM_CODE));
+    }
+    memory.MapMemoryRegion(*page_table, CODE_ADDRESS, Memory::PAGE_SIZE, code.data());
+    memory.MapMemoryRegion(*page_table, DATA_ADDRESS, Memory::PAGE_SIZE, data.data());
+    memory.SetCurrentPageTable(page_table.get());
+
+    ARMul_State state(nullptr, memory, USER32MODE);
+    state.Reg[15] = CODE_ADDRESS;
+    if (thumb) {
+        state.Cpsr |= 1 << 5;
+    }
+
+    // The cache is shared by all interpreters, it can't have blocks of other address spaces
+    state.instruction_cache.clear();
+    trans_cache_buf_top = 0;
+    ++trans_cache_buf_resets;
+
+    InterpreterBenchmarkResult result;
+    const auto start = std::chrono::steady_clock::now();
+    while (result.instructions < instruction_count) {
+        state.NumInstrsToExecute =
+            std::min(SLICE_INSTRUCTIONS, instruction_count - result.instructions);
+        const unsigned executed = InterpreterMainLoop(&state);
+        if (executed == 0) {
+            break;
+        }
+        result.instructions += executed;
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (result.seconds > 0.0) {
+        result.mips = result.instructions / result.seconds / 1000000.0;
+    }
+
+    trans_cache_buf_top = 0;
+    ++trans_cache_buf_resets;
+
+    return result;
+}
@@ -0,0 +1,21 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+struct InterpreterBenchmarkResult {
+    u64 instructions = 0; ///< Instructions executed
+    double seconds = 0.0;
+    double mips = 0.0; ///< Millions of instructions per second
+};
+
+/**
+ * Runs a loop of loads, arithmetic, compares and branches through the dyncom interpreter without
+ * an emulated system, and measures how fast it goes. Empties the translation cache.
+ * @param instruction_count how many instructions to execute
+ * @param thumb whether to run the Thumb version of the loop
+ */
+InterpreterBenchmarkResult BenchmarkInterpreter(u64 instruction_count, bool thumb);
@@ -837,12 +837,50 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
+// Indices of the superinstructions, they follow the DISPATCH, INIT_INST_LENGTH and END labels
+// after the instructions in InstLabel
+enum : u16 {
+    CMP_BBL_INDEX = ARM_INSTRUCTION_TRANS_LEN + 3,
+    CMP_B_COND_THUMB_INDEX,
+    LDR_ADD_INDEX,
+    LDR_SUB_INDEX,
+};
+
+/**
+ * Turns an instruction into a superinstruction if it's commonly followed by next. A
+ * superinstruction runs the instruction and jumps straight to the label of the next one, which
+ * saves a jump through InstLabel. Both instructions keep their creams.
+ */
+static void FuseInstructions(arm_inst* inst, const arm_inst* next) {
+    if (inst->br != TransExtData::NON_BRANCH) {
+        return;
+    }
+
+    switch (inst->idx) {
+    case CMP_INDEX:
+        if (next->idx == BBL_INDEX) {
+            inst->idx = CMP_BBL_INDEX;
+        } else if (next->idx == B_COND_THUMB_INDEX) {
+            inst->idx = CMP_B_COND_THUMB_INDEX;
+        }
+        break;
+    case LDR_INDEX:
+        if (next->idx == ADD_INDEX) {
+            inst->idx = LDR_ADD_INDEX;
+        } else if (next->idx == SUB_INDEX) {
+            inst->idx = LDR_SUB_INDEX;
+        }
+        break;
+    }
+}
+
 static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
     // Decode instruction, get index
     // Allocate memory and init InsCream
     // Go on next, until terminal instruction
     // Save start addr of basicblock in CreamCache
     ARM_INST_PTR inst_base = nullptr;
+    ARM_INST_PTR prev_inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
     int size = 0; // instruction size of basic block
     bb_start = trans_cache_buf_top;
@@ -853,6 +891,11 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     while (ret == TransExtData::NON_BRANCH) {
         unsigned int inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
+        if (prev_inst_base != nullptr) {
+            FuseInstructions(prev_inst_base, inst_base);
+        }
+        prev_inst_base = inst_base;
+
         size++;
 
         phys_addr += inst_size;
@@ -939,8 +982,8 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         goto DISPATCH;                                                                             \
     inst_base = (arm_inst*)&trans_cache_buf[ptr]
 
-#define INC_PC(l) ptr += sizeof(arm_inst) + l
-#define INC_PC_STUB ptr += sizeof(arm_inst)
+#define INC_PC(l) ptr += GetTranslatedInstructionSize(l)
+#define INC_PC_STUB ptr += GetTranslatedInstructionSize(0)
 
 #define GDB_BP_CHECK                                                                               \
     cpu->Cpsr &= ~(1 << 5);                                                                        \
@@ -1381,9 +1424,40 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         goto INIT_INST_LENGTH;                                                                     \
     case 204:                                                                                      \
         goto END;                                                                                  \
+    case CMP_BBL_INDEX:                                                                            \
+        goto CMP_BBL_INST;                                                                         \
+    case CMP_B_COND_THUMB_INDEX:                                                                   \
+        goto CMP_B_COND_THUMB_INST;                                                                \
+    case LDR_ADD_INDEX:                                                                            \
+        goto LDR_ADD_INST;                                                                         \
+    case LDR_SUB_INDEX:                                                                            \
+        goto LDR_SUB_INST;                                                                         \
     }
 #endif
 
+// Runs the instruction after a superinstruction, which is always at the given label
+#define GOTO_FUSED_INST(label)                                                                     \
+    GDB_BP_CHECK;                                                                                  \
+    if (num_instrs >= cpu->NumInstrsToExecute)                                                     \
+        goto END;                                                                                  \
+    num_instrs++;                                                                                  \
+    goto label
+
+// Continues at the block a direct branch goes to. The block is looked up in DISPATCH the first
+// time and linked to the branch, later jumps skip DISPATCH unless an interrupt is pending, a GDB
+// client is connected (DISPATCH finds the breakpoints of each block) or the link is stale.
+#define GOTO_LINKED_BLOCK(link)                                                                    \
+    if (links_resets == trans_cache_buf_resets) {                                                  \
+        if (link != NO_BLOCK_LINK && (cpu->NirqSig || (cpu->Cpsr & 0x80)) &&                       \
+            !GDBStub::IsConnected()) {                                                             \
+            ptr = link;                                                                            \
+            inst_base = (arm_inst*)&trans_cache_buf[ptr];                                          \
+            GOTO_NEXT_INST;                                                                        \
+        }                                                                                          \
+        pending_link = &link;                                                                      \
+    }                                                                                              \
+    goto DISPATCH
+
 #define UPDATE_NFLAG(dst) (cpu->NFlag = BIT(dst, 31) ? 1 : 0)
 #define UPDATE_ZFLAG(dst) (cpu->ZFlag = dst ? 0 : 1)
 #define UPDATE_CFLAG_WITH_SC (cpu->CFlag = cpu->shifter_carry_out)
@@ -1608,7 +1682,12 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
                          &&BLX_1_THUMB,
                          &&DISPATCH,
                          &&INIT_INST_LENGTH,
-                         &&END};
+                         &&END,
+                         &&CMP_BBL_INST,
+                         &&CMP_B_COND_THUMB_INST,
+                         &&LDR_ADD_INST,
+                         &&LDR_SUB_INST};
+    static_assert(sizeof(InstLabel) / sizeof(void*) == LDR_SUB_INDEX + 1);
 #endif
     arm_inst* inst_base;
     unsigned int addr;
@@ -1616,6 +1695,12 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 
     std::size_t ptr;
 
+    // Link of the direct branch that went to DISPATCH, set to the block DISPATCH finds
+    std::size_t* pending_link = nullptr;
+    // Value of trans_cache_buf_resets when the current block was found, the links in it are stale
+    // if the buffer was emptied since
+    u64 links_resets = trans_cache_buf_resets;
+
     LOAD_NZCVT;
 DISPATCH : {
     if (!cpu->NirqSig) {
@@ -1641,6 +1726,14 @@ DISPATCH : {
             goto END;
     }
 
+    if (pending_link != nullptr) {
+        if (links_resets == trans_cache_buf_resets) {
+            *pending_link = ptr;
+        }
+        pending_link = nullptr;
+    }
+    links_resets = trans_cache_buf_resets;
+
     // Find breakpoint if one exists within the block
     if (GDBStub::IsConnected()) {
         breakpoint_data =
@@ -1750,18 +1843,18 @@ AND_INST : {
     GOTO_NEXT_INST;
 }
 BBL_INST : {
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
     if ((inst_base->cond == ConditionCode::AL) || CondPassed(cpu, inst_base->cond)) {
-        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
         if (inst_cream->L) {
             LINK_RTN_ADDR;
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
-        goto DISPATCH;
+        GOTO_LINKED_BLOCK(inst_cream->taken_link);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(bbl_inst));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->not_taken_link);
 }
 BIC_INST : {
     bic_inst* inst_cream = (bic_inst*)inst_base->component;
@@ -4312,18 +4405,20 @@ B_2_THUMB : {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
     INC_PC(sizeof(b_2_thumb));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->taken_link);
 }
 B_COND_THUMB : {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
-        cpu->Reg[15] += 2;
+        INC_PC(sizeof(b_cond_thumb));
+        GOTO_LINKED_BLOCK(inst_cream->taken_link);
+    }
 
+    cpu->Reg[15] += 2;
     INC_PC(sizeof(b_cond_thumb));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->not_taken_link);
 }
 BL_1_THUMB : {
     bl_1_thumb* inst_cream = (bl_1_thumb*)inst_base->component;
@@ -4352,6 +4447,53 @@ BLX_1_THUMB : {
     goto DISPATCH;
 }
 
+// Superinstructions, see FuseInstructions. The first instruction is never the last one of its
+// block, so they don't need FETCH_INST.
+CMP_BBL_INST:
+CMP_B_COND_THUMB_INST : {
+    if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
+        cmp_inst* const inst_cream = (cmp_inst*)inst_base->component;
+
+        u32 rn_val = RN;
+        if (inst_cream->Rn == 15)
+            rn_val += 2 * cpu->GetInstructionSize();
+
+        bool carry;
+        bool overflow;
+        u32 result = AddWithCarry(rn_val, ~SHIFTER_OPERAND, 1, &carry, &overflow);
+
+        UPDATE_NFLAG(result);
+        UPDATE_ZFLAG(result);
+        cpu->CFlag = carry;
+        cpu->VFlag = overflow;
+    }
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    const bool thumb_branch = inst_base->idx == CMP_B_COND_THUMB_INDEX;
+    INC_PC(sizeof(cmp_inst));
+    inst_base = (arm_inst*)&trans_cache_buf[ptr];
+    if (thumb_branch) {
+        GOTO_FUSED_INST(B_COND_THUMB);
+    }
+    GOTO_FUSED_INST(BBL_INST);
+}
+LDR_ADD_INST:
+LDR_SUB_INST : {
+    ldst_inst* inst_cream = (ldst_inst*)inst_base->component;
+    inst_cream->get_addr(cpu, inst_cream->inst, addr);
+
+    // Rd isn't PC, as LDR to PC ends the block
+    cpu->Reg[BITS(inst_cream->inst, 12, 15)] = cpu->ReadMemory32(addr);
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    const bool sub = inst_base->idx == LDR_SUB_INDEX;
+    INC_PC(sizeof(ldst_inst));
+    inst_base = (arm_inst*)&trans_cache_buf[ptr];
+    if (sub) {
+        GOTO_FUSED_INST(SUB_INST);
+    }
+    GOTO_FUSED_INST(ADD_INST);
+}
+
 UQADD8_INST:
 UQADD16_INST:
 UQADDSUBX_INST:
@@ -6,12 +6,14 @@
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 
-char trans_cache_buf[TRANS_CACHE_SIZE];
+alignas(TRANS_CACHE_ALIGNMENT) char trans_cache_buf[TRANS_CACHE_SIZE];
 size_t trans_cache_buf_top = 0;
+u64 trans_cache_buf_resets = 0;
 
+// size is sizeof(arm_inst) plus the size of the cream
 static void* AllocBuffer(std::size_t size) {
     std::size_t start = trans_cache_buf_top;
-    trans_cache_buf_top += size;
+    trans_cache_buf_top += GetTranslatedInstructionSize(size - sizeof(arm_inst));
     ASSERT_MSG(trans_cache_buf_top <= TRANS_CACHE_SIZE, "Translation cache is full!");
     return static_cast<void*>(&trans_cache_buf[start]);
 }
@@ -99,6 +101,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bbl)(unsigned int inst, int index) {
 
     inst_cream->L = BIT(inst, 24);
     inst_cream->signed_immed_24 = BIT(inst, 23) ? NEGBRANCH : POSBRANCH;
+    inst_cream->taken_link = NO_BLOCK_LINK;
+    inst_cream->not_taken_link = NO_BLOCK_LINK;
 
     return inst_base;
 }
@@ -1646,6 +1650,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_2_thumb)(unsigned int tinst, int ind
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
 
     inst_cream->imm = ((tinst & 0x3FF) << 1) | ((tinst & (1 << 10)) ? 0xFFFFF800 : 0);
+    inst_cream->taken_link = NO_BLOCK_LINK;
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -1659,6 +1664,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_cond_thumb)(unsigned int tinst, int
 
     inst_cream->imm = (((tinst & 0x7F) << 1) | ((tinst & (1 << 7)) ? 0xFFFFFF00 : 0));
     inst_cream->cond = ((tinst >> 8) & 0xf);
+    inst_cream->taken_link = NO_BLOCK_LINK;
+    inst_cream->not_taken_link = NO_BLOCK_LINK;
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
 
@@ -1807,7 +1814,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(yield)(unsigned int inst, int index) {
 #include "core/arm/skyeye_common/vfp/vfpinstr.cpp"
 #undef VFP_INTERPRETER_TRANS
 
-const transop_fp_t arm_instruction_trans[] = {
+constexpr transop_fp_t arm_instruction_trans[] = {
     INTERPRETER_TRANSLATE(vmla),
     INTERPRETER_TRANSLATE(vmls),
     INTERPRETER_TRANSLATE(vnmla),
@@ -2016,3 +2023,11 @@ const transop_fp_t arm_instruction_trans[] = {
 };
 
 const std::size_t arm_instruction_trans_len = sizeof(arm_instruction_trans) / sizeof(transop_fp_t);
+
+static_assert(sizeof(arm_instruction_trans) / sizeof(transop_fp_t) == ARM_INSTRUCTION_TRANS_LEN);
+static_assert(arm_instruction_trans[CMP_INDEX] == INTERPRETER_TRANSLATE(cmp));
+static_assert(arm_instruction_trans[ADD_INDEX] == INTERPRETER_TRANSLATE(add));
+static_assert(arm_instruction_trans[SUB_INDEX] == INTERPRETER_TRANSLATE(sub));
+static_assert(arm_instruction_trans[LDR_INDEX] == INTERPRETER_TRANSLATE(ldr));
+static_assert(arm_instruction_trans[BBL_INDEX] == INTERPRETER_TRANSLATE(bbl));
+static_assert(arm_instruction_trans[B_COND_THUMB_INDEX] == INTERPRETER_TRANSLATE(b_cond_thumb));
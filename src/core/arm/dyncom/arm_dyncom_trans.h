@@ -22,12 +22,26 @@ enum class TransExtData {
     SINGLE_STEP = (1 << 8)
 };
 
+// Instructions are kept 8 byte aligned in trans_cache_buf, with an 8 byte header, so that the
+// pointers in the creams are aligned and more instructions fit in a cache line
 struct arm_inst {
-    unsigned int idx;
-    unsigned int cond;
+    u16 idx;
+    u16 cond;
     TransExtData br;
     char component[0];
 };
+static_assert(sizeof(arm_inst) == 8, "arm_inst has incorrect size");
+
+constexpr std::size_t TRANS_CACHE_ALIGNMENT = 8;
+
+/// Returns the size of an instruction with a cream of cream_size bytes in trans_cache_buf
+constexpr std::size_t GetTranslatedInstructionSize(std::size_t cream_size) {
+    return (sizeof(arm_inst) + cream_size + TRANS_CACHE_ALIGNMENT - 1) &
+           ~(TRANS_CACHE_ALIGNMENT - 1);
+}
+
+/// Block link of a direct branch whose target wasn't looked up yet
+constexpr std::size_t NO_BLOCK_LINK = ~std::size_t{0};
 
 struct generic_arm_inst {
     u32 Ra;
@@ -86,8 +100,9 @@ struct eor_inst {
 struct bbl_inst {
     unsigned int L;
     int signed_immed_24;
-    unsigned int next_addr;
-    unsigned int jmp_addr;
+    // Offsets in trans_cache_buf of the blocks at the target and after the branch
+    std::size_t taken_link;
+    std::size_t not_taken_link;
 };
 
 struct bx_inst {
@@ -451,10 +466,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    std::size_t taken_link;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    std::size_t taken_link;
+    std::size_t not_taken_link;
 };
 
 struct bl_1_thumb {
@@ -493,6 +511,22 @@ typedef ARM_INST_PTR (*transop_fp_t)(unsigned int, int);
 extern const transop_fp_t arm_instruction_trans[];
 extern const std::size_t arm_instruction_trans_len;
 
+// Number of entries in arm_instruction_trans, checked against the table
+constexpr std::size_t ARM_INSTRUCTION_TRANS_LEN = 202;
+
+// Indices in arm_instruction_trans of the instructions that are fused into superinstructions,
+// checked against the table
+enum : u16 {
+    CMP_INDEX = 130,
+    ADD_INDEX = 148,
+    SUB_INDEX = 153,
+    LDR_INDEX = 180,
+    BBL_INDEX = 196,
+    B_COND_THUMB_INDEX = 198,
+};
+
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
 extern std::size_t trans_cache_buf_top;
+/// Incremented every time trans_cache_buf is emptied, which makes the block links in it stale
+extern u64 trans_cache_buf_resets;
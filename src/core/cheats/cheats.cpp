@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <fmt/format.h>
+#include <algorithm>
 #include <fstream>
+#include <fmt/format.h>
 #include <functional>
+#include <limits>
 #include "common/file_util.h"
 #include "core/cheats/cheats.h"
 #include "core/cheats/gateway_cheat.h"
@@ -12,19 +14,16 @@
 #include "core/core_timing.h"
 #include "core/hle/kernel/process.h"
 #include "core/hw/gpu.h"
+#include "core/settings.h"
 
 namespace Cheats {
 
-// Luma3DS uses this interval for applying cheats, so to keep consistent behavior
-// we use the same value
-constexpr u64 run_interval_ticks = 50'000'000;
-
 CheatEngine::CheatEngine(Core::System& system_) : system(system_) {
     LoadCheatsFromFile();
     event = system.CoreTiming().RegisterEvent(
         "CheatCore::run_event",
         [this](u64 thread_id, s64 cycle_late) { RunCallback(thread_id, cycle_late); });
-    system.CoreTiming().ScheduleEvent(run_interval_ticks, event);
+    ScheduleNextRun(0);
 }
 
 CheatEngine::~CheatEngine() {
@@ -126,7 +125,21 @@ void CheatEngine::RunCallback([[maybe_unused]] std::uintptr_t user_data, int cyc
             }
         }
     }
-    system.CoreTiming().ScheduleEvent(run_interval_ticks - cycles_late, event);
+    ScheduleNextRun(cycles_late);
+}
+
+void CheatEngine::ScheduleNextRun(int cycles_late) {
+    Core::Timing& timing = system.CoreTiming();
+    if (Settings::values.run_cheats_on_vblank) {
+        // VBlanks happen every GPU::frame_ticks since boot. Events scheduled for the same tick run
+        // in scheduling order, so this runs right after the VBlank callback.
+        timing.ScheduleEvent(GPU::frame_ticks - timing.GetTicks() % GPU::frame_ticks, event);
+    } else {
+        // With an interval of 0 the event would keep rescheduling itself on the same tick
+        const s64 interval = static_cast<s64>(std::clamp<u64>(
+            Settings::values.cheats_run_interval, 1, std::numeric_limits<s64>::max()));
+        timing.ScheduleEvent(std::max<s64>(interval - cycles_late, 0), event);
+    }
 }
 
 } // namespace Cheats
@@ -39,6 +39,7 @@ public:
 
 private:
     void RunCallback(std::uintptr_t user_data, int cycles_late);
+    void ScheduleNextRun(int cycles_late);
 
     std::vector<std::shared_ptr<CheatBase>> cheats_list;
     mutable std::shared_mutex cheats_list_mutex;
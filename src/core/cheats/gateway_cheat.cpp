@@ -3,7 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <string>
@@ -28,36 +28,138 @@ struct State {
     bool loop_flag = false;
 };
 
-template <typename T, typename ReadFunction, typename WriteFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(const GatewayCheat::CheatLine& line,
+/// Accesses guest memory through host pointers resolved once per page, falling back to
+/// MemorySystem for pages that need special handling. JIT cache invalidations are batched until
+/// the cheat finished executing.
+class MemoryAccessor {
+public:
+    explicit MemoryAccessor(Core::System& system) : system(system), memory(system.Memory()) {}
+
+    ~MemoryAccessor() {
+        for (const auto& [start, end] : invalidated_ranges) {
+            system.InvalidateCacheRange(static_cast<u32>(start), end - start);
+        }
+    }
+
+    template <typename T>
+    T Read(VAddr addr) {
+        if (const u8* pointer = GetHostPointer(addr, sizeof(T))) {
+            T value;
+            std::memcpy(&value, pointer, sizeof(T));
+            return value;
+        }
+
+        if constexpr (sizeof(T) == 1) {
+            return memory.Read8(addr);
+        } else if constexpr (sizeof(T) == 2) {
+            return memory.Read16(addr);
+        } else {
+            return memory.Read32(addr);
+        }
+    }
+
+    template <typename T>
+    void Write(VAddr addr, T value) {
+        if (u8* pointer = GetHostPointer(addr, sizeof(T))) {
+            // Most cheats write the same value every time, don't invalidate code for those
+            if (std::memcmp(pointer, &value, sizeof(T)) == 0) {
+                return;
+            }
+            std::memcpy(pointer, &value, sizeof(T));
+        } else if constexpr (sizeof(T) == 1) {
+            memory.Write8(addr, value);
+        } else if constexpr (sizeof(T) == 2) {
+            memory.Write16(addr, value);
+        } else {
+            memory.Write32(addr, value);
+        }
+
+        Invalidate(addr, sizeof(T));
+    }
+
+    void WriteBlock(VAddr addr, const u8* data, std::size_t size) {
+        while (size > 0) {
+            const std::size_t page_size =
+                std::min<std::size_t>(size, Memory::PAGE_SIZE - (addr & Memory::PAGE_MASK));
+            if (u8* pointer = GetHostPointer(addr, page_size)) {
+                if (std::memcmp(pointer, data, page_size) != 0) {
+                    std::memcpy(pointer, data, page_size);
+                    Invalidate(addr, page_size);
+                }
+            } else {
+                for (std::size_t i = 0; i < page_size; ++i) {
+                    memory.Write8(addr + static_cast<u32>(i), data[i]);
+                }
+                Invalidate(addr, page_size);
+            }
+
+            addr += static_cast<u32>(page_size);
+            data += page_size;
+            size -= page_size;
+        }
+    }
+
+private:
+    u8* GetHostPointer(VAddr addr, std::size_t size) {
+        if ((addr & Memory::PAGE_MASK) + size > Memory::PAGE_SIZE) {
+            return nullptr;
+        }
+
+        const u32 page = addr >> Memory::PAGE_BITS;
+        if (page != cached_page) {
+            cached_page = page;
+            cached_page_pointer = memory.GetDirectPointer(page << Memory::PAGE_BITS);
+        }
+
+        if (cached_page_pointer == nullptr) {
+            return nullptr;
+        }
+        return cached_page_pointer + (addr & Memory::PAGE_MASK);
+    }
+
+    void Invalidate(VAddr addr, std::size_t size) {
+        const u64 end = static_cast<u64>(addr) + size;
+        if (!invalidated_ranges.empty()) {
+            auto& [last_start, last_end] = invalidated_ranges.back();
+            if (addr <= last_end && end >= last_start) {
+                last_start = std::min<u64>(last_start, addr);
+                last_end = std::max(last_end, end);
+                return;
+            }
+        }
+        invalidated_ranges.emplace_back(addr, end);
+    }
+
+    Core::System& system;
+    Memory::MemorySystem& memory;
+    u32 cached_page = 0xFFFFFFFF;
+    u8* cached_page_pointer = nullptr;
+    std::vector<std::pair<u64, u64>> invalidated_ranges;
+};
+
+template <typename T>
+static inline std::enable_if_t<std::is_integral_v<T>> WriteOp(u32 address, u32 value,
                                                               const State& state,
-                                                              ReadFunction read_func,
-                                                              WriteFunction write_func,
-                                                              Core::System& system) {
-    u32 addr = line.address + state.offset;
-    write_func(addr, static_cast<T>(line.value));
-    system.InvalidateCacheRange(addr, sizeof(T));
+                                                              MemoryAccessor& memory) {
+    memory.Write<T>(address + state.offset, static_cast<T>(value));
 }
 
-template <typename T, typename ReadFunction, typename CompareFunc>
-static inline std::enable_if_t<std::is_integral_v<T>> CompOp(const GatewayCheat::CheatLine& line,
-                                                             State& state, ReadFunction read_func,
+template <typename T, typename CompareFunc>
+static inline std::enable_if_t<std::is_integral_v<T>> CompOp(u32 address, State& state,
+                                                             MemoryAccessor& memory,
                                                              CompareFunc comp) {
-    u32 addr = line.address + state.offset;
-    T val = read_func(addr);
+    T val = memory.Read<T>(address + state.offset);
     if (!comp(val)) {
         state.if_flag++;
     }
 }
 
-static inline void LoadOffsetOp(Memory::MemorySystem& memory, const GatewayCheat::CheatLine& line,
-                                State& state) {
-    u32 addr = line.address + state.offset;
-    state.offset = memory.Read32(addr);
+static inline void LoadOffsetOp(u32 address, State& state, MemoryAccessor& memory) {
+    state.offset = memory.Read<u32>(address + state.offset);
 }
 
-static inline void LoopOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.loop_flag = state.loop_count < line.value;
+static inline void LoopOp(u32 value, State& state) {
+    state.loop_flag = state.loop_count < value;
     state.loop_count++;
     state.loop_back_line = state.current_line_nr;
 }
@@ -88,88 +190,50 @@ static inline void FullTerminateOp(State& state) {
     }
 }
 
-static inline void SetOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.offset = line.value;
+static inline void SetOffsetOp(u32 value, State& state) {
+    state.offset = value;
 }
 
-static inline void AddValueOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.reg += line.value;
+static inline void AddValueOp(u32 value, State& state) {
+    state.reg += value;
 }
 
-static inline void SetValueOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.reg = line.value;
+static inline void SetValueOp(u32 value, State& state) {
+    state.reg = value;
 }
 
-template <typename T, typename ReadFunction, typename WriteFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(
-    const GatewayCheat::CheatLine& line, State& state, ReadFunction read_func,
-    WriteFunction write_func, Core::System& system) {
-    u32 addr = line.value + state.offset;
-    write_func(addr, static_cast<T>(state.reg));
-    system.InvalidateCacheRange(addr, sizeof(T));
+template <typename T>
+static inline std::enable_if_t<std::is_integral_v<T>> IncrementiveWriteOp(u32 value, State& state,
+                                                                          MemoryAccessor& memory) {
+    memory.Write<T>(value + state.offset, static_cast<T>(state.reg));
     state.offset += sizeof(T);
 }
 
-template <typename T, typename ReadFunction>
-static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat::CheatLine& line,
-                                                             State& state, ReadFunction read_func) {
-
-    u32 addr = line.value + state.offset;
-    state.reg = read_func(addr);
+template <typename T>
+static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(u32 value, State& state,
+                                                             MemoryAccessor& memory) {
+    state.reg = memory.Read<T>(value + state.offset);
 }
 
-static inline void AddOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.offset += line.value;
+static inline void AddOffsetOp(u32 value, State& state) {
+    state.offset += value;
 }
 
-static inline void JokerOp(const GatewayCheat::CheatLine& line, State& state,
-                           const Core::System& system) {
+static inline void JokerOp(u32 value, State& state, const Core::System& system) {
     const u32 pad_state = system.ServiceManager()
                               .GetService<Service::HID::Module::Interface>("hid:USER")
                               ->GetModule()
                               ->GetPadState()
                               .hex;
-    bool pressed = (pad_state & line.value) == line.value;
+    bool pressed = (pad_state & value) == value;
     if (!pressed) {
         state.if_flag++;
     }
 }
 
-static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Core::System& system,
-                           const std::vector<GatewayCheat::CheatLine>& cheat_lines) {
-    if (state.if_flag > 0) {
-        // Skip over the additional patch lines
-        state.current_line_nr += static_cast<int>(std::ceil(line.value / 8.0));
-        return;
-    }
-    u32 num_bytes = line.value;
-    u32 addr = line.address + state.offset;
-    system.InvalidateCacheRange(addr, num_bytes);
-
-    bool first = true;
-    u32 bit_offset = 0;
-    if (num_bytes > 0)
-        state.current_line_nr++; // skip over the current code
-    while (num_bytes >= 4) {
-        u32 tmp = first ? cheat_lines[state.current_line_nr].first
-                        : cheat_lines[state.current_line_nr].value;
-        if (!first && num_bytes > 4) {
-            state.current_line_nr++;
-        }
-        first = !first;
-        system.Memory().Write32(addr, tmp);
-        addr += 4;
-        num_bytes -= 4;
-    }
-    while (num_bytes > 0) {
-        u32 tmp = (first ? cheat_lines[state.current_line_nr].first
-                         : cheat_lines[state.current_line_nr].value) >>
-                  bit_offset;
-        system.Memory().Write8(addr, tmp);
-        addr += 1;
-        num_bytes -= 1;
-        bit_offset += 8;
-    }
+static inline void PatchOp(u32 address, u32 size, const u8* data, const State& state,
+                           MemoryAccessor& memory) {
+    memory.WriteBlock(address + state.offset, data, size);
 }
 
 GatewayCheat::CheatLine::CheatLine(const std::string& line) {
@@ -203,6 +267,7 @@ GatewayCheat::CheatLine::CheatLine(const std::string& line) {
 GatewayCheat::GatewayCheat(std::string name_, std::vector<CheatLine> cheat_lines_,
                            std::string comments_)
     : name(std::move(name_)), cheat_lines(std::move(cheat_lines_)), comments(std::move(comments_)) {
+    Compile();
 }
 
 GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comments_)
@@ -217,24 +282,52 @@ GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comm
         }
     }
     cheat_lines = std::move(temp_cheat_lines);
+    Compile();
 }
 
 GatewayCheat::~GatewayCheat() = default;
 
+void GatewayCheat::Compile() {
+    instructions.clear();
+    patch_data.clear();
+
+    for (std::size_t i = 0; i < cheat_lines.size(); ++i) {
+        const CheatLine& line = cheat_lines[i];
+        if (line.type == CheatType::Null) {
+            continue;
+        }
+
+        Instruction instruction{line.type, line.address, line.value, 0};
+        if (line.type == CheatType::Patch) {
+            // EXXXXXXX YYYYYYYY
+            // The YYYYYYYY bytes to copy follow in the next lines, read as little endian words
+            instruction.patch_offset = static_cast<u32>(patch_data.size());
+            u32 remaining = line.value;
+            while (remaining > 0 && i + 1 < cheat_lines.size()) {
+                const CheatLine& data_line = cheat_lines[++i];
+                for (const u32 word : {data_line.first, data_line.value}) {
+                    const u32 count = std::min<u32>(remaining, 4);
+                    for (u32 byte = 0; byte < count; ++byte) {
+                        patch_data.push_back(
+                            data_line.valid ? static_cast<u8>(word >> (byte * 8)) : 0);
+                    }
+                    remaining -= count;
+                }
+            }
+            instruction.value = static_cast<u32>(patch_data.size()) - instruction.patch_offset;
+        }
+
+        instructions.push_back(instruction);
+    }
+}
+
 void GatewayCheat::Execute(Core::System& system) const {
     State state;
+    MemoryAccessor memory(system);
 
-    Memory::MemorySystem& memory = system.Memory();
-    auto Read8 = [&memory](VAddr addr) { return memory.Read8(addr); };
-    auto Read16 = [&memory](VAddr addr) { return memory.Read16(addr); };
-    auto Read32 = [&memory](VAddr addr) { return memory.Read32(addr); };
-    auto Write8 = [&memory](VAddr addr, u8 value) { memory.Write8(addr, value); };
-    auto Write16 = [&memory](VAddr addr, u16 value) { memory.Write16(addr, value); };
-    auto Write32 = [&memory](VAddr addr, u32 value) { memory.Write32(addr, value); };
-
-    for (state.current_line_nr = 0; state.current_line_nr < cheat_lines.size();
+    for (state.current_line_nr = 0; state.current_line_nr < instructions.size();
          state.current_line_nr++) {
-        auto line = cheat_lines[state.current_line_nr];
+        const Instruction& line = instructions[state.current_line_nr];
         if (state.if_flag > 0) {
             switch (line.type) {
             case CheatType::GreaterThan32:
@@ -249,12 +342,6 @@ void GatewayCheat::Execute(Core::System& system) const {
                 // Increment the if_flag to handle the end if correctly
                 state.if_flag++;
                 break;
-            case CheatType::Patch:
-                // EXXXXXXX YYYYYYYY
-                // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-                // We need to call this here to skip the additional patch lines
-                PatchOp(line, state, system, cheat_lines);
-                break;
             case CheatType::Terminator:
                 // D0000000 00000000 - ENDIF
                 TerminateOp(state);
@@ -274,66 +361,68 @@ void GatewayCheat::Execute(Core::System& system) const {
             break;
         case CheatType::Write32:
             // 0XXXXXXX YYYYYYYY - word[XXXXXXX+offset] = YYYYYYYY
-            WriteOp<u32>(line, state, Read32, Write32, system);
+            WriteOp<u32>(line.address, line.value, state, memory);
             break;
         case CheatType::Write16:
             // 1XXXXXXX 0000YYYY - half[XXXXXXX+offset] = YYYY
-            WriteOp<u16>(line, state, Read16, Write16, system);
+            WriteOp<u16>(line.address, line.value, state, memory);
             break;
         case CheatType::Write8:
             // 2XXXXXXX 000000YY - byte[XXXXXXX+offset] = YY
-            WriteOp<u8>(line, state, Read8, Write8, system);
+            WriteOp<u8>(line.address, line.value, state, memory);
             break;
         case CheatType::GreaterThan32:
             // 3XXXXXXX YYYYYYYY - Execute next block IF YYYYYYYY > word[XXXXXXX]   ;unsigned
-            CompOp<u32>(line, state, Read32, [&line](u32 val) -> bool { return line.value > val; });
+            CompOp<u32>(line.address, state, memory,
+                        [&line](u32 val) -> bool { return line.value > val; });
             break;
         case CheatType::LessThan32:
             // 4XXXXXXX YYYYYYYY - Execute next block IF YYYYYYYY < word[XXXXXXX]   ;unsigned
-            CompOp<u32>(line, state, Read32, [&line](u32 val) -> bool { return line.value < val; });
+            CompOp<u32>(line.address, state, memory,
+                        [&line](u32 val) -> bool { return line.value < val; });
             break;
         case CheatType::EqualTo32:
             // 5XXXXXXX YYYYYYYY - Execute next block IF YYYYYYYY == word[XXXXXXX]   ;unsigned
-            CompOp<u32>(line, state, Read32,
+            CompOp<u32>(line.address, state, memory,
                         [&line](u32 val) -> bool { return line.value == val; });
             break;
         case CheatType::NotEqualTo32:
             // 6XXXXXXX YYYYYYYY - Execute next block IF YYYYYYYY != word[XXXXXXX]   ;unsigned
-            CompOp<u32>(line, state, Read32,
+            CompOp<u32>(line.address, state, memory,
                         [&line](u32 val) -> bool { return line.value != val; });
             break;
         case CheatType::GreaterThan16WithMask:
             // 7XXXXXXX ZZZZYYYY - Execute next block IF YYYY > ((not ZZZZ) AND half[XXXXXXX])
-            CompOp<u16>(line, state, Read16, [&line](u16 val) -> bool {
+            CompOp<u16>(line.address, state, memory, [&line](u16 val) -> bool {
                 return static_cast<u16>(line.value) > (static_cast<u16>(~line.value >> 16) & val);
             });
             break;
         case CheatType::LessThan16WithMask:
             // 8XXXXXXX ZZZZYYYY - Execute next block IF YYYY < ((not ZZZZ) AND half[XXXXXXX])
-            CompOp<u16>(line, state, Read16, [&line](u16 val) -> bool {
+            CompOp<u16>(line.address, state, memory, [&line](u16 val) -> bool {
                 return static_cast<u16>(line.value) < (static_cast<u16>(~line.value >> 16) & val);
             });
             break;
         case CheatType::EqualTo16WithMask:
             // 9XXXXXXX ZZZZYYYY - Execute next block IF YYYY = ((not ZZZZ) AND half[XXXXXXX])
-            CompOp<u16>(line, state, Read16, [&line](u16 val) -> bool {
+            CompOp<u16>(line.address, state, memory, [&line](u16 val) -> bool {
                 return static_cast<u16>(line.value) == (static_cast<u16>(~line.value >> 16) & val);
             });
             break;
         case CheatType::NotEqualTo16WithMask:
             // AXXXXXXX ZZZZYYYY - Execute next block IF YYYY <> ((not ZZZZ) AND half[XXXXXXX])
-            CompOp<u16>(line, state, Read16, [&line](u16 val) -> bool {
+            CompOp<u16>(line.address, state, memory, [&line](u16 val) -> bool {
                 return static_cast<u16>(line.value) != (static_cast<u16>(~line.value >> 16) & val);
             });
             break;
         case CheatType::LoadOffset:
             // BXXXXXXX 00000000 - offset = word[XXXXXXX+offset]
-            LoadOffsetOp(system.Memory(), line, state);
+            LoadOffsetOp(line.address, state, memory);
             break;
         case CheatType::Loop: {
             // C0000000 YYYYYYYY - LOOP next block YYYYYYYY times
             // TODO(B3N30): Support nested loops if necessary
-            LoopOp(line, state);
+            LoopOp(line.value, state);
             break;
         }
         case CheatType::Terminator: {
@@ -353,63 +442,64 @@ void GatewayCheat::Execute(Core::System& system) const {
         }
         case CheatType::SetOffset: {
             // D3000000 XXXXXXXX – Sets the offset to XXXXXXXX
-            SetOffsetOp(line, state);
+            SetOffsetOp(line.value, state);
             break;
         }
         case CheatType::AddValue: {
             // D4000000 XXXXXXXX – reg += XXXXXXXX
-            AddValueOp(line, state);
+            AddValueOp(line.value, state);
             break;
         }
         case CheatType::SetValue: {
             // D5000000 XXXXXXXX – reg = XXXXXXXX
-            SetValueOp(line, state);
+            SetValueOp(line.value, state);
             break;
         }
         case CheatType::IncrementiveWrite32: {
             // D6000000 XXXXXXXX – (32bit) [XXXXXXXX+offset] = reg ; offset += 4
-            IncrementiveWriteOp<u32>(line, state, Read32, Write32, system);
+            IncrementiveWriteOp<u32>(line.value, state, memory);
             break;
         }
         case CheatType::IncrementiveWrite16: {
             // D7000000 XXXXXXXX – (16bit) [XXXXXXXX+offset] = reg & 0xffff ; offset += 2
-            IncrementiveWriteOp<u16>(line, state, Read16, Write16, system);
+            IncrementiveWriteOp<u16>(line.value, state, memory);
             break;
         }
         case CheatType::IncrementiveWrite8: {
             // D8000000 XXXXXXXX – (16bit) [XXXXXXXX+offset] = reg & 0xff ; offset++
-            IncrementiveWriteOp<u8>(line, state, Read8, Write8, system);
+            IncrementiveWriteOp<u8>(line.value, state, memory);
             break;
         }
         case CheatType::Load32: {
             // D9000000 XXXXXXXX – reg = [XXXXXXXX+offset]
-            LoadOp<u32>(line, state, Read32);
+            LoadOp<u32>(line.value, state, memory);
             break;
         }
         case CheatType::Load16: {
             // DA000000 XXXXXXXX – reg = [XXXXXXXX+offset] & 0xFFFF
-            LoadOp<u16>(line, state, Read16);
+            LoadOp<u16>(line.value, state, memory);
             break;
         }
         case CheatType::Load8: {
             // DB000000 XXXXXXXX – reg = [XXXXXXXX+offset] & 0xFF
-            LoadOp<u8>(line, state, Read8);
+            LoadOp<u8>(line.value, state, memory);
             break;
         }
         case CheatType::AddOffset: {
             // DC000000 XXXXXXXX – offset + XXXXXXXX
-            AddOffsetOp(line, state);
+            AddOffsetOp(line.value, state);
             break;
         }
         case CheatType::Joker: {
             // DD000000 XXXXXXXX – if KEYPAD has value XXXXXXXX execute next block
-            JokerOp(line, state, system);
+            JokerOp(line.value, state, system);
             break;
         }
         case CheatType::Patch: {
             // EXXXXXXX YYYYYYYY
             // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-            PatchOp(line, state, system, cheat_lines);
+            PatchOp(line.address, line.value, patch_data.data() + line.patch_offset, state,
+                    memory);
             break;
         }
         }
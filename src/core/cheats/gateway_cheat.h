@@ -7,6 +7,8 @@
 #include <atomic>
 #include <istream>
 #include <memory>
+#include <vector>
+#include "common/common_types.h"
 #include "core/cheats/cheat_base.h"
 
 namespace Cheats {
@@ -79,9 +81,23 @@ public:
     static std::vector<std::unique_ptr<CheatBase>> Load(std::istream& is);
 
 private:
+    /// A cheat line with its operands decoded. Patch payload lines are folded into patch_data.
+    struct Instruction {
+        CheatType type;
+        u32 address;
+        u32 value;        ///< For Patch, the number of payload bytes
+        u32 patch_offset; ///< For Patch, the offset of the payload in patch_data
+    };
+
+    /// Decodes cheat_lines into instructions. Cheats are immutable, so this runs only once.
+    void Compile();
+
     std::atomic<bool> enabled = false;
     const std::string name;
     std::vector<CheatLine> cheat_lines;
     const std::string comments;
+
+    std::vector<Instruction> instructions;
+    std::vector<u8> patch_data;
 };
 } // namespace Cheats
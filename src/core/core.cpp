@@ -19,8 +19,12 @@
 #include "core/cheats/cheats.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/cpu_core_threads.h"
 #include "core/custom_tex_cache.h"
+#include "core/frame_dumper.h"
+#include "core/frame_feed.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/gpu_trace.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
@@ -143,29 +147,51 @@ System::ResultStatus System::Run() {
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
 
-        for (std::shared_ptr<ARM_Interface>& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            const u64 start_ticks = cpu_core->GetTimer().GetTicks();
+        if (cpu_core_threads != nullptr && !GDBStub::IsServerEnabled()) {
+            // Every core runs the whole slice, the delayed core path catches up the ones that
+            // stopped early
+            u32 core_mask = 0;
+            for (const auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                SetRunningCore(*cpu_core);
+
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
+                } else {
+                    LOG_TRACE(Core_ARM11, "Core {} running for {} ticks on its thread",
+                              cpu_core->GetID(), cpu_core->GetTimer().GetDowncount());
+                    core_mask |= 1U << cpu_core->GetID();
+                }
+            }
 
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
+            cpu_core_threads->RunSlice(core_mask);
+        } else {
+            for (std::shared_ptr<ARM_Interface>& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                const u64 start_ticks = cpu_core->GetTimer().GetTicks();
 
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
+                LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                          cpu_core->GetTimer().GetDowncount());
 
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (step) {
-                    cpu_core->Step();
+                running_core = cpu_core.get();
+                kernel->SetRunningCPU(running_core);
+
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
                 } else {
-                    cpu_core->Run();
+                    if (step) {
+                        cpu_core->Step();
+                    } else {
+                        cpu_core->Run();
+                    }
                 }
-            }
 
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
+                max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
+            }
         }
     }
 
@@ -324,6 +350,13 @@ void System::PrepareReschedule() {
     reschedule_pending = true;
 }
 
+void System::SetRunningCore(ARM_Interface& core) {
+    running_core = &core;
+    if (kernel->current_cpu != &core) {
+        kernel->SetRunningCPU(&core);
+    }
+}
+
 void System::Reschedule() {
     if (!reschedule_pending) {
         return;
@@ -336,9 +369,23 @@ void System::Reschedule() {
     }
 }
 
+System::ResultStatus System::InitForGPUTraceReplay(Frontend::EmuWindow& emu_window) {
+    // The system mode only matters to applications
+    const ResultStatus init_result = Init(emu_window, 0);
+    if (init_result != ResultStatus::Success) {
+        LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                     static_cast<u32>(init_result));
+        System::Shutdown();
+    }
+    return init_result;
+}
+
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mode) {
     memory = std::make_unique<Memory::MemorySystem>();
     timing = std::make_unique<Timing>();
+    frame_dumper = std::make_unique<Core::FrameDumper>();
+    frame_feed = std::make_unique<Core::FrameFeed>();
+    gpu_trace_recorder = std::make_unique<Core::GPUTraceRecorder>();
 
     kernel = std::make_unique<Kernel::KernelSystem>(
         *memory, *timing, [this] { PrepareReschedule(); }, system_mode);
@@ -379,6 +426,14 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     kernel->SetCPUs(cpu_cores);
     kernel->SetRunningCPU(cpu_cores[0].get());
 
+#ifdef ARCHITECTURE_x86_64
+    // Only the Dynarmic cores hand their SVCs and memory callbacks to the emulation thread
+    if (Settings::values.run_cores_on_separate_threads && Settings::values.use_cpu_jit &&
+        cpu_cores.size() > 1) {
+        cpu_core_threads = std::make_unique<CPUCoreThreads>(cpu_cores);
+    }
+#endif
+
     if (Settings::values.enable_dsp_lle) {
         dsp_core = std::make_shared<AudioCore::DspLle>(*memory,
                                                        Settings::values.enable_dsp_lle_multithread);
@@ -463,6 +518,30 @@ const Core::CustomTexCache& System::CustomTexCache() const {
     return *custom_tex_cache;
 }
 
+Core::FrameDumper& System::FrameDumper() {
+    return *frame_dumper;
+}
+
+const Core::FrameDumper& System::FrameDumper() const {
+    return *frame_dumper;
+}
+
+Core::FrameFeed& System::FrameFeed() {
+    return *frame_feed;
+}
+
+const Core::FrameFeed& System::FrameFeed() const {
+    return *frame_feed;
+}
+
+Core::GPUTraceRecorder& System::GPUTraceRecorder() {
+    return *gpu_trace_recorder;
+}
+
+const Core::GPUTraceRecorder& System::GPUTraceRecorder() const {
+    return *gpu_trace_recorder;
+}
+
 Network::RoomMember& System::RoomMember() {
     return *room_member;
 }
@@ -482,11 +561,15 @@ void System::RegisterSoftwareKeyboard(std::shared_ptr<Frontend::SoftwareKeyboard
 void System::Shutdown() {
     GDBStub::Shutdown();
     VideoCore::Shutdown();
+    frame_dumper.reset();
+    frame_feed.reset();
+    gpu_trace_recorder.reset();
     perf_stats.reset();
     cheat_engine.reset();
     archive_manager.reset();
     service_manager.reset();
     dsp_core.reset();
+    cpu_core_threads.reset();
     cpu_cores.clear();
     kernel.reset();
     timing.reset();
@@ -62,6 +62,10 @@ class RendererBase;
 
 namespace Core {
 
+class CPUCoreThreads;
+class FrameDumper;
+class FrameFeed;
+class GPUTraceRecorder;
 class Timing;
 
 class System {
@@ -121,6 +125,13 @@ public:
      */
     ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath);
 
+    /**
+     * Initialize the emulated system without loading an application, used to replay GPU traces.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    ResultStatus InitForGPUTraceReplay(Frontend::EmuWindow& emu_window);
+
     bool IsInitialized() const;
     void PrepareReschedule();
 
@@ -128,6 +139,14 @@ public:
         return *running_core;
     }
 
+    /// Makes the core the running one for the kernel and Core::Timing too
+    void SetRunningCore(ARM_Interface& core);
+
+    /// Gets the host threads the cores run on, nullptr if they run on the emulation thread
+    CPUCoreThreads* GetCPUCoreThreads() {
+        return cpu_core_threads.get();
+    }
+
     ARM_Interface& GetCore(u32 core_id) {
         return *cpu_cores[core_id];
     }
@@ -200,6 +219,24 @@ public:
     /// Gets a const reference to the custom texture cache system
     const Core::CustomTexCache& CustomTexCache() const;
 
+    /// Gets a reference to the frame dumper
+    Core::FrameDumper& FrameDumper();
+
+    /// Gets a const reference to the frame dumper
+    const Core::FrameDumper& FrameDumper() const;
+
+    /// Gets a reference to the shared memory frame and audio feed
+    Core::FrameFeed& FrameFeed();
+
+    /// Gets a const reference to the shared memory frame and audio feed
+    const Core::FrameFeed& FrameFeed() const;
+
+    /// Gets a reference to the GPU trace recorder
+    Core::GPUTraceRecorder& GPUTraceRecorder();
+
+    /// Gets a const reference to the GPU trace recorder
+    const Core::GPUTraceRecorder& GPUTraceRecorder() const;
+
     /// Gets a reference to the room member
     Network::RoomMember& RoomMember();
 
@@ -250,6 +287,7 @@ private:
     /// ARM11 CPU cores
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
+    std::unique_ptr<CPUCoreThreads> cpu_core_threads;
 #ifdef ARCHITECTURE_x86_64
     std::shared_ptr<Dynarmic::ExclusiveMonitor> exclusive_monitor;
 #endif
@@ -273,6 +311,15 @@ private:
     /// Custom texture cache system
     std::unique_ptr<Core::CustomTexCache> custom_tex_cache;
 
+    /// Frame and audio dumper
+    std::unique_ptr<Core::FrameDumper> frame_dumper;
+
+    /// Shared memory frame and audio feed
+    std::unique_ptr<Core::FrameFeed> frame_feed;
+
+    /// GPU trace recorder
+    std::unique_ptr<Core::GPUTraceRecorder> gpu_trace_recorder;
+
     std::unique_ptr<Service::FS::ArchiveManager> archive_manager;
 
     std::unique_ptr<Memory::MemorySystem> memory;
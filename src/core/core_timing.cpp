@@ -56,39 +56,27 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             timer->ForceExceptionCheck(cycles_into_future);
         }
 
-        timer->event_queue.emplace_back(
-            Event{timeout, timer->event_fifo_id++, userdata, event_type});
-        std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+        timer->event_queue.Push(Event{
+            timeout, timer->event_fifo_id.fetch_add(1, std::memory_order_relaxed), userdata,
+            event_type});
     } else {
-        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                   userdata, event_type});
+        const Event event{timeout, timer->event_fifo_id.fetch_add(1, std::memory_order_relaxed),
+                          userdata, event_type};
+        if (!timer->ts_queue.TryPush(event)) {
+            timer->ts_overflow_queue.Push(event);
+        }
     }
 }
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.userdata == userdata; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->event_queue.Remove(event_type, userdata);
     }
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->event_queue.Remove(event_type);
     }
 }
 
@@ -116,9 +104,136 @@ std::shared_ptr<Timing::Timer> Timing::GetTimer(std::size_t cpu_id) {
     return timers[cpu_id];
 }
 
+void Timing::EventQueue::Push(const Event& event) {
+    u32 node_index;
+    if (free_nodes.empty()) {
+        node_index = static_cast<u32>(nodes.size());
+        nodes.emplace_back();
+    } else {
+        node_index = free_nodes.back();
+        free_nodes.pop_back();
+    }
+
+    // Link it in front of the other events of its type
+    auto [itr, inserted] = first_of_type.try_emplace(event.type, INVALID_INDEX);
+    Node& node = nodes[node_index];
+    node.event = event;
+    node.previous_of_type = INVALID_INDEX;
+    node.next_of_type = itr->second;
+    if (itr->second != INVALID_INDEX) {
+        nodes[itr->second].previous_of_type = node_index;
+    }
+    itr->second = node_index;
+
+    heap.push_back(node_index);
+    node.heap_index = static_cast<u32>(heap.size() - 1);
+    SiftUp(heap.size() - 1);
+}
+
+Timing::Event Timing::EventQueue::Pop() {
+    const u32 node_index = heap.front();
+    const Event event = nodes[node_index].event;
+    RemoveNode(node_index);
+    return event;
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* type, u64 userdata) {
+    const auto itr = first_of_type.find(type);
+    if (itr == first_of_type.end()) {
+        return;
+    }
+
+    for (u32 node_index = itr->second; node_index != INVALID_INDEX;) {
+        const u32 next = nodes[node_index].next_of_type;
+        if (nodes[node_index].event.userdata == userdata) {
+            RemoveNode(node_index);
+        }
+        node_index = next;
+    }
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* type) {
+    const auto itr = first_of_type.find(type);
+    if (itr == first_of_type.end()) {
+        return;
+    }
+
+    while (itr->second != INVALID_INDEX) {
+        RemoveNode(itr->second);
+    }
+}
+
+void Timing::EventQueue::Place(std::size_t heap_index, u32 node_index) {
+    heap[heap_index] = node_index;
+    nodes[node_index].heap_index = static_cast<u32>(heap_index);
+}
+
+void Timing::EventQueue::SiftUp(std::size_t heap_index) {
+    const u32 node_index = heap[heap_index];
+    const Event& event = nodes[node_index].event;
+    while (heap_index > 0) {
+        const std::size_t parent = (heap_index - 1) / 2;
+        if (!(event < nodes[heap[parent]].event)) {
+            break;
+        }
+        Place(heap_index, heap[parent]);
+        heap_index = parent;
+    }
+    Place(heap_index, node_index);
+}
+
+void Timing::EventQueue::SiftDown(std::size_t heap_index) {
+    const u32 node_index = heap[heap_index];
+    const Event& event = nodes[node_index].event;
+    while (true) {
+        std::size_t child = heap_index * 2 + 1;
+        if (child >= heap.size()) {
+            break;
+        }
+        if (child + 1 < heap.size() && IsBefore(child + 1, child)) {
+            ++child;
+        }
+        if (!(nodes[heap[child]].event < event)) {
+            break;
+        }
+        Place(heap_index, heap[child]);
+        heap_index = child;
+    }
+    Place(heap_index, node_index);
+}
+
+void Timing::EventQueue::RemoveNode(u32 node_index) {
+    Node& node = nodes[node_index];
+
+    // Fill the hole with the last event and restore the heap around it
+    const std::size_t heap_index = node.heap_index;
+    const u32 last = heap.back();
+    heap.pop_back();
+    if (heap_index < heap.size()) {
+        Place(heap_index, last);
+        if (heap_index > 0 && IsBefore(heap_index, (heap_index - 1) / 2)) {
+            SiftUp(heap_index);
+        } else {
+            SiftDown(heap_index);
+        }
+    }
+
+    if (node.previous_of_type != INVALID_INDEX) {
+        nodes[node.previous_of_type].next_of_type = node.next_of_type;
+    } else {
+        first_of_type[node.event.type] = node.next_of_type;
+    }
+    if (node.next_of_type != INVALID_INDEX) {
+        nodes[node.next_of_type].previous_of_type = node.previous_of_type;
+    }
+
+    free_nodes.push_back(node_index);
+}
+
 Timing::Timer::Timer() {
     slice_length = Settings::values.set_slice_length_to_this_in_core_timing_timer_timer;
-    downcount = Settings::values.set_downcount_to_this_in_core_timing_timer_timer;
+    downcount.store(Settings::values.set_downcount_to_this_in_core_timing_timer_timer,
+                    std::memory_order_relaxed);
 }
 
 Timing::Timer::~Timer() {
@@ -128,15 +243,20 @@ Timing::Timer::~Timer() {
 u64 Timing::Timer::GetTicks() const {
     u64 ticks = static_cast<u64>(executed_ticks);
     if (!is_timer_sane) {
-        ticks += slice_length - downcount;
+        ticks += slice_length - downcount.load(std::memory_order_relaxed);
     }
     return ticks;
 }
 
 void Timing::Timer::AddTicks(u64 ticks) {
-    downcount -= static_cast<u64>(
-        (Settings::values.use_custom_cpu_ticks ? Settings::values.custom_cpu_ticks : ticks) *
-        (100.0 / Settings::values.cpu_clock_percentage));
+    // A load and a store instead of a read-modify-write, as only this core's thread writes it
+    downcount.store(
+        downcount.load(std::memory_order_relaxed) -
+            static_cast<s64>(
+                (Settings::values.use_custom_cpu_ticks ? Settings::values.custom_cpu_ticks
+                                                       : ticks) *
+                (100.0 / Settings::values.cpu_clock_percentage)),
+        std::memory_order_relaxed);
 }
 
 u64 Timing::Timer::GetIdleTicks() const {
@@ -145,25 +265,29 @@ u64 Timing::Timer::GetIdleTicks() const {
 
 void Timing::Timer::ForceExceptionCheck(s64 cycles) {
     cycles = std::max<s64>(0, cycles);
-    if (downcount > cycles) {
-        slice_length -= downcount - cycles;
-        downcount = cycles;
+    const s64 current_downcount = downcount.load(std::memory_order_relaxed);
+    if (current_downcount > cycles) {
+        slice_length -= current_downcount - cycles;
+        downcount.store(cycles, std::memory_order_relaxed);
     }
 }
 
 void Timing::Timer::MoveEvents() {
+    // The events were given their fifo_order when they were scheduled, so the order they're
+    // drained in doesn't matter
     for (Event ev; ts_queue.Pop(ev);) {
-        ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Push(ev);
+    }
+    for (Event ev; ts_overflow_queue.Pop(ev);) {
+        event_queue.Push(ev);
     }
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
-        ASSERT(next_event->time - executed_ticks > 0);
-        return next_event->time - executed_ticks;
+    if (!event_queue.empty()) {
+        const Event& next_event = event_queue.front();
+        ASSERT(next_event.time - executed_ticks > 0);
+        return next_event.time - executed_ticks;
     }
     return Settings::values.return_this_if_the_event_queue_is_empty_in_core_timing_timer_getmaxslicelength;
 }
@@ -171,18 +295,16 @@ s64 Timing::Timer::GetMaxSliceLength() const {
 void Timing::Timer::Advance() {
     MoveEvents();
 
-    s64 cycles_executed = slice_length - downcount;
+    s64 cycles_executed = slice_length - downcount.load(std::memory_order_relaxed);
     idled_cycles = 0;
     executed_ticks += cycles_executed;
     slice_length = 0;
-    downcount = 0;
+    downcount.store(0, std::memory_order_relaxed);
 
     is_timer_sane = true;
 
     while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+        const Event evt = event_queue.Pop();
         evt.type->callback(evt.userdata, executed_ticks - evt.time);
     }
 
@@ -198,16 +320,16 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
             std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
     }
 
-    downcount = slice_length;
+    downcount.store(slice_length, std::memory_order_relaxed);
 }
 
 void Timing::Timer::Idle() {
-    idled_cycles += downcount;
-    downcount = 0;
+    idled_cycles += downcount.load(std::memory_order_relaxed);
+    downcount.store(0, std::memory_order_relaxed);
 }
 
 s64 Timing::Timer::GetDowncount() const {
-    return downcount;
+    return downcount.load(std::memory_order_relaxed);
 }
 
 } // namespace Core
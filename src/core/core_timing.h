@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <limits>
@@ -131,6 +132,60 @@ public:
         bool operator<(const Event& right) const;
     };
 
+    /**
+     * Min-heap of events that also links the events of each type together, so that they can be
+     * removed in O(log n) without searching and rebuilding the whole heap. Events are stored in a
+     * pool and the heap only moves their indices around.
+     */
+    class EventQueue {
+    public:
+        bool empty() const {
+            return heap.empty();
+        }
+
+        /// Returns the event that fires first
+        const Event& front() const {
+            return nodes[heap.front()].event;
+        }
+
+        void Push(const Event& event);
+
+        /// Removes and returns the event that fires first
+        Event Pop();
+
+        /// Removes every event of the type with the given userdata
+        void Remove(const TimingEventType* type, u64 userdata);
+
+        /// Removes every event of the type
+        void Remove(const TimingEventType* type);
+
+    private:
+        static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+        struct Node {
+            Event event;
+            u32 heap_index;
+            u32 previous_of_type;
+            u32 next_of_type;
+        };
+
+        bool IsBefore(std::size_t a, std::size_t b) const {
+            return nodes[heap[a]].event < nodes[heap[b]].event;
+        }
+
+        void Place(std::size_t heap_index, u32 node_index);
+        void SiftUp(std::size_t heap_index);
+        void SiftDown(std::size_t heap_index);
+        void RemoveNode(u32 node_index);
+
+        std::vector<Node> nodes;
+        std::vector<u32> free_nodes;
+        std::vector<u32> heap;
+
+        // First node of each type's list, INVALID_INDEX once all of them fired
+        std::unordered_map<const TimingEventType*, u32> first_of_type;
+    };
+
     class Timer {
     public:
         Timer();
@@ -157,16 +212,17 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
-        std::vector<Event> event_queue;
-        u64 event_fifo_id = 0;
+        // Events are ordered by time, then by fifo_order, so the order they fire in doesn't depend
+        // on how the queue is implemented. fifo_order is taken when an event is scheduled, also
+        // from other threads, so events keep their order whichever queue they went through.
+        EventQueue event_queue;
+        std::atomic<u64> event_fifo_id{0};
 
         // The queue for storing the events from other threads threadsafe until they will be added
-        // to the event_queue by the emu thread
-        Common::MPSCQueue<Event> ts_queue;
+        // to the event_queue by the emu thread. It doesn't allocate or lock; if it's ever full,
+        // events go to the locked overflow queue instead.
+        Common::BoundedMPSCQueue<Event, 1024> ts_queue;
+        Common::MPSCQueue<Event> ts_overflow_queue;
 
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
@@ -178,7 +234,9 @@ public:
         bool is_timer_sane = true;
 
         s64 slice_length;
-        s64 downcount;
+        // When the cores run on their own threads, the emulation thread reads the downcount of
+        // running cores to get their ticks. Only the core's thread writes it during a slice.
+        std::atomic<s64> downcount;
         s64 executed_ticks = 0;
         u64 idled_cycles = 0;
     };
@@ -0,0 +1,216 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+#include "common/threadsafe_queue.h"
+#include "core/core_timing.h"
+#include "core/core_timing_benchmark.h"
+
+namespace Core {
+
+namespace {
+
+using Event = Timing::Event;
+
+/**
+ * Starts the producers at the same time, drains the events on the calling thread until all of
+ * them arrived, and returns how long it took in seconds
+ */
+template <typename PushFunction, typename DrainFunction>
+double RunProducers(u32 producer_count, u64 events_per_producer, PushFunction push,
+                    DrainFunction drain) {
+    std::atomic<bool> start{false};
+    std::vector<std::thread> producers;
+    producers.reserve(producer_count);
+    for (u32 i = 0; i < producer_count; ++i) {
+        producers.emplace_back([&, i] {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (u64 j = 0; j < events_per_producer; ++j) {
+                push(Event{static_cast<s64>(j), 0, i, nullptr});
+            }
+        });
+    }
+
+    const u64 total = producer_count * events_per_producer;
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (u64 received = 0; received < total;) {
+        const u64 drained = drain();
+        if (drained == 0) {
+            std::this_thread::yield();
+        }
+        received += drained;
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+/// The std::vector binary heap Timing::Timer used before Timing::EventQueue
+class HeapEventQueue {
+public:
+    bool empty() const {
+        return heap.empty();
+    }
+
+    void Push(const Event& event) {
+        heap.push_back(event);
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+
+    Event Pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        const Event event = heap.back();
+        heap.pop_back();
+        return event;
+    }
+
+    void Remove(const TimingEventType* type, u64 userdata) {
+        const auto itr = std::remove_if(heap.begin(), heap.end(), [&](const Event& e) {
+            return e.type == type && e.userdata == userdata;
+        });
+        if (itr != heap.end()) {
+            heap.erase(itr, heap.end());
+            std::make_heap(heap.begin(), heap.end(), std::greater<>());
+        }
+    }
+
+private:
+    std::vector<Event> heap;
+};
+
+constexpr std::size_t EVENT_TYPE_COUNT = 32;
+
+/// Pushes, pops and cancels events in a random order that only depends on the seed, writing the
+/// fifo_order of every popped event to popped, and returns how long it took in seconds
+template <typename Queue>
+double RunEventQueue(Queue& queue, const std::array<TimingEventType, EVENT_TYPE_COUNT>& types,
+                     u64 operations, u32 userdata_per_type, std::vector<u64>& popped) {
+    std::mt19937_64 random(0x3D5);
+    std::uniform_int_distribution<u32> operation(0, 3);
+    std::uniform_int_distribution<std::size_t> type(0, EVENT_TYPE_COUNT - 1);
+    std::uniform_int_distribution<u64> userdata(0, userdata_per_type - 1);
+    std::uniform_int_distribution<s64> delay(0, 100000);
+    s64 now = 0;
+    u64 fifo_order = 0;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (u64 i = 0; i < operations; ++i) {
+        switch (operation(random)) {
+        case 0:
+        case 1:
+            queue.Push(Event{now + delay(random), fifo_order++, userdata(random),
+                             &types[type(random)]});
+            break;
+        case 2:
+            if (!queue.empty()) {
+                const Event event = queue.Pop();
+                now = event.time;
+                popped.push_back(event.fifo_order);
+            }
+            break;
+        case 3:
+            queue.Remove(&types[type(random)], userdata(random));
+            break;
+        }
+    }
+    while (!queue.empty()) {
+        popped.push_back(queue.Pop().fifo_order);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+} // namespace
+
+TimingQueueBenchmarkResult BenchmarkTimingQueue(u32 producer_count, u64 events_per_producer) {
+    TimingQueueBenchmarkResult result;
+    result.events = producer_count * events_per_producer;
+
+    {
+        Common::BoundedMPSCQueue<Event, 1024> queue;
+        Common::MPSCQueue<Event> overflow_queue;
+        std::atomic<u64> overflowed_events{0};
+        result.bounded_seconds = RunProducers(
+            producer_count, events_per_producer,
+            [&](const Event& event) {
+                if (!queue.TryPush(event)) {
+                    overflow_queue.Push(event);
+                    overflowed_events.fetch_add(1, std::memory_order_relaxed);
+                }
+            },
+            [&] {
+                u64 drained = 0;
+                for (Event event; queue.Pop(event);) {
+                    ++drained;
+                }
+                for (Event event; overflow_queue.Pop(event);) {
+                    ++drained;
+                }
+                return drained;
+            });
+        result.overflowed_events = overflowed_events;
+    }
+
+    {
+        Common::MPSCQueue<Event> queue;
+        result.locked_seconds = RunProducers(
+            producer_count, events_per_producer, [&](const Event& event) { queue.Push(event); },
+            [&] {
+                u64 drained = 0;
+                for (Event event; queue.Pop(event);) {
+                    ++drained;
+                }
+                return drained;
+            });
+    }
+
+    if (result.bounded_seconds > 0.0) {
+        result.bounded_events_per_second = result.events / result.bounded_seconds;
+    }
+    if (result.locked_seconds > 0.0) {
+        result.locked_events_per_second = result.events / result.locked_seconds;
+    }
+
+    return result;
+}
+
+EventQueueBenchmarkResult BenchmarkEventQueue(u64 operations, u32 userdata_per_type) {
+    EventQueueBenchmarkResult result;
+    result.operations = operations;
+
+    std::array<TimingEventType, EVENT_TYPE_COUNT> types{};
+    userdata_per_type = std::max<u32>(userdata_per_type, 1);
+
+    std::vector<u64> indexed_popped;
+    std::vector<u64> heap_popped;
+    indexed_popped.reserve(operations);
+    heap_popped.reserve(operations);
+
+    Timing::EventQueue indexed_queue;
+    result.indexed_seconds =
+        RunEventQueue(indexed_queue, types, operations, userdata_per_type, indexed_popped);
+    HeapEventQueue heap_queue;
+    result.heap_seconds =
+        RunEventQueue(heap_queue, types, operations, userdata_per_type, heap_popped);
+    result.same_order = indexed_popped == heap_popped;
+
+    return result;
+}
+
+} // namespace Core
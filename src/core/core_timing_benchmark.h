@@ -0,0 +1,44 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Core {
+
+struct TimingQueueBenchmarkResult {
+    u64 events = 0;                         ///< Events pushed by all producers together
+    double bounded_seconds = 0.0;           ///< Time the bounded queue took
+    double bounded_events_per_second = 0.0; ///< Events per second through the bounded queue
+    double locked_seconds = 0.0;            ///< Time the locked queue took
+    double locked_events_per_second = 0.0;  ///< Events per second through the locked queue
+    u64 overflowed_events = 0;              ///< Events that didn't fit in the bounded queue
+};
+
+/**
+ * Has producer_count threads schedule events for another thread at the same time, like audio,
+ * input and plugin threads do, once through the bounded queue with the locked overflow queue that
+ * Timing::ScheduleEvent uses, and once through the locked queue alone. The calling thread drains
+ * the queues like Timing::Timer::MoveEvents.
+ */
+TimingQueueBenchmarkResult BenchmarkTimingQueue(u32 producer_count, u64 events_per_producer);
+
+struct EventQueueBenchmarkResult {
+    u64 operations = 0;           ///< Pushes, pops and cancellations done on each queue
+    double indexed_seconds = 0.0; ///< Time Timing::EventQueue took
+    double heap_seconds = 0.0;    ///< Time the std::vector heap with remove_if took
+    bool same_order = false;      ///< Whether both queues popped the events in the same order
+};
+
+/**
+ * Runs the same random sequence of pushes, pops and cancellations of single events, like the
+ * rescheduling HID, DSP and kernel timers do, through Timing::EventQueue and through the
+ * std::vector heap it replaced, and checks that both pop the events in the same order.
+ * @param userdata_per_type how many different userdata values each of the event types is
+ * scheduled with, more makes every cancellation remove fewer of the events of its type
+ */
+EventQueueBenchmarkResult BenchmarkEventQueue(u64 operations, u32 userdata_per_type);
+
+} // namespace Core
@@ -0,0 +1,124 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "core/arm/arm_interface.h"
+#include "core/cpu_core_threads.h"
+
+namespace Core {
+
+thread_local CPUCoreThreads::CoreThread* CPUCoreThreads::current_core_thread = nullptr;
+
+CPUCoreThreads::CPUCoreThreads(const std::vector<std::shared_ptr<ARM_Interface>>& cores) {
+    for (const auto& core : cores) {
+        auto core_thread = std::make_unique<CoreThread>();
+        core_thread->core = core.get();
+        threads.push_back(std::move(core_thread));
+    }
+
+    for (auto& core_thread : threads) {
+        core_thread->thread = std::thread(&CPUCoreThreads::ThreadFunction, this,
+                                          std::ref(*core_thread));
+    }
+}
+
+CPUCoreThreads::~CPUCoreThreads() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    core_condition.notify_all();
+
+    for (auto& core_thread : threads) {
+        core_thread->thread.join();
+    }
+}
+
+void CPUCoreThreads::RunSlice(u32 core_mask) {
+    std::unique_lock lock(mutex);
+    for (auto& core_thread : threads) {
+        if ((core_mask >> core_thread->core->GetID()) & 1) {
+            core_thread->running = true;
+            ++running_count;
+        }
+    }
+    if (running_count == 0) {
+        return;
+    }
+    ++slice;
+    core_condition.notify_all();
+
+    while (true) {
+        system_condition.wait(lock, [this] {
+            return running_count == 0 ||
+                   std::any_of(threads.begin(), threads.end(),
+                               [](const auto& core_thread) { return core_thread->call; });
+        });
+
+        bool called = false;
+        for (auto& core_thread : threads) {
+            if (core_thread->call == nullptr) {
+                continue;
+            }
+
+            const std::function<void()>& call = *core_thread->call;
+            lock.unlock();
+            call();
+            lock.lock();
+            core_thread->call = nullptr;
+            called = true;
+        }
+        if (called) {
+            core_condition.notify_all();
+        }
+
+        if (running_count == 0) {
+            return;
+        }
+    }
+}
+
+bool CPUCoreThreads::IsCoreThread() const {
+    return current_core_thread != nullptr;
+}
+
+void CPUCoreThreads::CallOnSystemThread(const std::function<void()>& function) {
+    CoreThread* core_thread = current_core_thread;
+    ASSERT(core_thread != nullptr);
+
+    std::unique_lock lock(mutex);
+    core_thread->call = &function;
+    system_condition.notify_one();
+    core_condition.wait(lock, [core_thread] { return core_thread->call == nullptr; });
+}
+
+void CPUCoreThreads::ThreadFunction(CoreThread& core_thread) {
+    current_core_thread = &core_thread;
+
+    u64 last_slice = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            core_condition.wait(lock, [&] {
+                return stop || (slice != last_slice && core_thread.running);
+            });
+            if (stop) {
+                return;
+            }
+            last_slice = slice;
+        }
+
+        core_thread.core->Run();
+
+        {
+            std::lock_guard lock(mutex);
+            core_thread.running = false;
+            --running_count;
+        }
+        system_condition.notify_one();
+    }
+}
+
+} // namespace Core
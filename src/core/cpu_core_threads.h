@@ -0,0 +1,77 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+
+class ARM_Interface;
+
+namespace Core {
+
+/**
+ * Runs the emulated ARM11 cores on their own host threads, one Core::Timing slice at a time.
+ *
+ * Only guest code runs on the core threads. Everything else a core needs during a slice (SVCs, so
+ * the kernel and the HLE services, and accesses to memory that isn't plain RAM, which can reach
+ * the renderer or MMIO) is handed to the thread that called RunSlice, which executes these calls
+ * one at a time while the cores run. The kernel, the timing event queues and the renderer are
+ * therefore still only touched by one thread. The cores queue JIT cache invalidations and page
+ * table switches requested meanwhile and apply them on their own threads.
+ */
+class CPUCoreThreads {
+public:
+    explicit CPUCoreThreads(const std::vector<std::shared_ptr<ARM_Interface>>& cores);
+    ~CPUCoreThreads();
+
+    /**
+     * Runs the cores in core_mask for one slice on their threads, and executes their calls until
+     * all of them are done. The slices must have been set up already.
+     * @param core_mask bit N is set if core N has to run
+     */
+    void RunSlice(u32 core_mask);
+
+    /// Returns true if the calling thread is one of the core threads
+    bool IsCoreThread() const;
+
+    /**
+     * Runs the function on the thread that called RunSlice and waits for it to finish. Must only
+     * be called from a core thread.
+     */
+    void CallOnSystemThread(const std::function<void()>& function);
+
+private:
+    struct CoreThread {
+        ARM_Interface* core = nullptr;
+        std::thread thread;
+
+        /// Set while the core has to run in the current slice
+        bool running = false;
+
+        /// Call the core is waiting for, if any
+        const std::function<void()>* call = nullptr;
+    };
+
+    void ThreadFunction(CoreThread& core_thread);
+
+    /// The CoreThread of the calling thread, nullptr on other threads
+    static thread_local CoreThread* current_core_thread;
+
+    std::vector<std::unique_ptr<CoreThread>> threads;
+
+    std::mutex mutex;
+    std::condition_variable system_condition; ///< Signaled on new calls and when a core is done
+    std::condition_variable core_condition;   ///< Signaled on new slices and finished calls
+    u64 slice = 0;
+    std::size_t running_count = 0;
+    bool stop = false;
+};
+
+} // namespace Core
@@ -4,13 +4,16 @@
 
 #include <algorithm>
 #include <cstring>
+#include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/patch.h"
+#include "core/loader/loader.h"
 
 namespace FileSys {
 
@@ -18,8 +21,15 @@ struct FileRelocationInfo {
     int type;                      // 0 - none, 1 - replaced / created, 2 - patched, 3 - removed
     u64 original_offset;           // Type 0. Offset is absolute
     std::string replace_file_path; // Type 1
+    std::string patch_file_path;   // Type 2
     std::vector<u8> patched_file;  // Type 2
     u64 size;                      // Relocated file size
+    u64 original_size;             // File size in the original RomFS
+
+    // Types 1 and 2, used to validate the cache
+    u64 source_size;
+    s64 source_modification_time;
+    u64 original_hash; // Type 2, hash of the original data the patch was applied to
 };
 struct LayeredFS::File {
     std::string name;
@@ -50,6 +60,47 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+// Version 2 stores modification times in nanoseconds instead of seconds, version 3 stores the hash
+// of the original data of patched files
+constexpr u32 CACHE_VERSION = 3;
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le key;
+    u64_le metadata_size;
+    u64_le string_pool_size;
+    u64_le patched_data_size;
+    u32_le directory_count;
+    u32_le file_count;
+};
+static_assert(sizeof(CacheHeader) == 0x30, "Size of CacheHeader is not correct");
+
+struct CacheDirectoryEntry {
+    u32_le path_offset;
+    u32_le path_length;
+    s64_le modification_time;
+};
+static_assert(sizeof(CacheDirectoryEntry) == 0x10, "Size of CacheDirectoryEntry is not correct");
+
+// Files are stored in data order, their data offsets are recomputed from the sizes on load
+struct CacheFileEntry {
+    u64_le size;
+    u64_le original_offset;
+    u64_le original_size;
+    u64_le source_size;
+    s64_le source_modification_time;
+    u64_le patched_data_offset;
+    u64_le original_hash;
+    u32_le metadata_offset;
+    u32_le type;
+    u32_le path_offset;
+    u32_le path_length;
+    u32_le source_path_offset;
+    u32_le source_path_length;
+};
+static_assert(sizeof(CacheFileEntry) == 0x50, "Size of CacheFileEntry is not correct");
+
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
                      std::string patch_ext_path_, bool load_relocations)
     : romfs(std::move(romfs_)), patch_path(std::move(patch_path_)),
@@ -61,6 +112,14 @@ LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path
 
     // TODO: is root always the first directory in table?
     root.parent = &root;
+
+    if (load_relocations) {
+        cache_key = ComputeCacheKey();
+        if (LoadCache()) {
+            return;
+        }
+    }
+
     LoadDirectory(root, 0);
 
     if (load_relocations) {
@@ -69,6 +128,17 @@ LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path
     }
 
     RebuildMetadata();
+
+    if (load_relocations) {
+        const auto& new_header = *reinterpret_cast<const RomFSHeader*>(metadata.data());
+        std::vector<u32> metadata_offsets;
+        metadata_offsets.reserve(file_list.size());
+        for (const auto& file : file_list) {
+            metadata_offsets.push_back(new_header.file_metadata_table.offset +
+                                       file_metadata_offset_map.at(file));
+        }
+        SaveCache(file_list, metadata_offsets);
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
@@ -111,6 +181,7 @@ u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     file->path = parent.path + file->name;
     file->relocation.original_offset = header.file_data_offset + metadata.file_data_offset;
     file->relocation.size = metadata.file_data_length;
+    file->relocation.original_size = metadata.file_data_length;
     file->parent = &parent;
 
     file_path_map.emplace(file->path, file.get());
@@ -130,7 +201,12 @@ std::string LayeredFS::ReadName(u32 offset, u32 name_length) {
     return Common::UTF16ToUTF8(name);
 }
 
+void LayeredFS::WatchDirectory(const std::string& path) {
+    watched_directories.emplace_back(path, FileUtil::GetModificationTime(path));
+}
+
 void LayeredFS::LoadRelocations() {
+    WatchDirectory(patch_path);
     if (!FileUtil::Exists(patch_path)) {
         return;
     }
@@ -151,6 +227,7 @@ void LayeredFS::LoadRelocations() {
                     parent->directories.emplace_back(std::move(directory));
                     LOG_INFO(Service_FS, "LayeredFS created directory {}", path);
                 }
+                WatchDirectory(directory + virtual_name + "/");
                 return FileUtil::ForeachDirectoryEntry(nullptr, directory + virtual_name + "/",
                                                        callback);
             }
@@ -170,6 +247,9 @@ void LayeredFS::LoadRelocations() {
             file->relocation.type = 1;
             file->relocation.replace_file_path = directory + virtual_name;
             file->relocation.size = FileUtil::GetSize(directory + virtual_name);
+            file->relocation.source_size = file->relocation.size;
+            file->relocation.source_modification_time =
+                FileUtil::GetModificationTime(directory + virtual_name);
             LOG_INFO(Service_FS, "LayeredFS replacement file in use for {}", path);
             return true;
         };
@@ -178,6 +258,7 @@ void LayeredFS::LoadRelocations() {
 }
 
 void LayeredFS::LoadExtRelocations() {
+    WatchDirectory(patch_ext_path);
     if (!FileUtil::Exists(patch_ext_path)) {
         return;
     }
@@ -220,43 +301,53 @@ void LayeredFS::LoadExtRelocations() {
                 continue;
             }
 
-            FileUtil::IOFile patch_file(entry.physical_name, "rb");
-            if (!patch_file) {
-                LOG_ERROR(Service_FS, "LayeredFS Could not open file {}", entry.physical_name);
-                continue;
-            }
+            ApplyPatch(*file_path_map[file_path], entry.physical_name);
+        } else {
+            LOG_WARNING(Service_FS, "LayeredFS unknown ext file {}", path);
+        }
+    }
+}
 
-            const auto size = patch_file.GetSize();
-            std::vector<u8> patch(size);
-            if (patch_file.ReadBytes(patch.data(), size) != size) {
-                LOG_ERROR(Service_FS, "LayeredFS Could not read file {}", entry.physical_name);
-                continue;
-            }
+bool LayeredFS::ApplyPatch(File& file, const std::string& patch_file_path) {
+    FileUtil::IOFile patch_file(patch_file_path, "rb");
+    if (!patch_file) {
+        LOG_ERROR(Service_FS, "LayeredFS Could not open file {}", patch_file_path);
+        return false;
+    }
 
-            auto& file = *file_path_map[file_path];
-            std::vector<u8> buffer(file.relocation.size); // Original size
-            romfs->ReadFile(file.relocation.original_offset, buffer.size(), buffer.data());
+    const auto size = patch_file.GetSize();
+    std::vector<u8> patch(size);
+    if (patch_file.ReadBytes(patch.data(), size) != size) {
+        LOG_ERROR(Service_FS, "LayeredFS Could not read file {}", patch_file_path);
+        return false;
+    }
 
-            bool ret = false;
-            if (extension == ".ips") {
-                ret = Patch::ApplyIpsPatch(patch, buffer);
-            } else {
-                ret = Patch::ApplyBpsPatch(patch, buffer);
-            }
+    std::vector<u8> buffer(file.relocation.original_size);
+    romfs->ReadFile(file.relocation.original_offset, buffer.size(), buffer.data());
+    const u64 original_hash = Common::ComputeHash64(buffer.data(), buffer.size());
 
-            if (ret) {
-                LOG_INFO(Service_FS, "LayeredFS patched file {}", file_path);
+    bool ret = false;
+    if (FileUtil::GetExtension(patch_file_path) == "ips") {
+        ret = Patch::ApplyIpsPatch(patch, buffer);
+    } else {
+        ret = Patch::ApplyBpsPatch(patch, buffer);
+    }
 
-                file.relocation.type = 2;
-                file.relocation.size = buffer.size();
-                file.relocation.patched_file = std::move(buffer);
-            } else {
-                LOG_ERROR(Service_FS, "LayeredFS failed to patch file {}", file_path);
-            }
-        } else {
-            LOG_WARNING(Service_FS, "LayeredFS unknown ext file {}", path);
-        }
+    if (!ret) {
+        LOG_ERROR(Service_FS, "LayeredFS failed to patch file {}", file.path);
+        return false;
     }
+
+    LOG_INFO(Service_FS, "LayeredFS patched file {}", file.path);
+
+    file.relocation.type = 2;
+    file.relocation.size = buffer.size();
+    file.relocation.patched_file = std::move(buffer);
+    file.relocation.patch_file_path = patch_file_path;
+    file.relocation.source_size = size;
+    file.relocation.source_modification_time = FileUtil::GetModificationTime(patch_file_path);
+    file.relocation.original_hash = original_hash;
+    return true;
 }
 
 static std::size_t GetNameSize(const std::string& name) {
@@ -471,24 +562,318 @@ void LayeredFS::RebuildMetadata() {
                 header.file_hash_table.length);
     std::memcpy(metadata.data() + header.file_metadata_table.offset, file_metadata_table.data(),
                 header.file_metadata_table.length);
+
+    metadata_data = metadata.data();
+    metadata_size = metadata.size();
+}
+
+u64 LayeredFS::ComputeCacheKey() {
+    std::vector<u8> base_metadata(header.file_data_offset);
+    romfs->ReadFile(0, base_metadata.size(), base_metadata.data());
+
+    const std::string paths = patch_path + '\0' + patch_ext_path;
+    return Common::ComputeHash64(base_metadata.data(), base_metadata.size()) ^
+           (Common::ComputeHash64(paths.data(), paths.size()) * 0x9E3779B97F4A7C15);
+}
+
+std::string LayeredFS::GetCachePath() const {
+    return fmt::format("{}layered_fs/{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), cache_key);
+}
+
+bool LayeredFS::LoadCache() {
+    FileUtil::MappedFile file(GetCachePath());
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    const u8* data = file.GetData();
+    const std::size_t size = file.GetSize();
+
+    CacheHeader cache_header;
+    if (size < sizeof(cache_header)) {
+        return false;
+    }
+    std::memcpy(&cache_header, data, sizeof(cache_header));
+    if (cache_header.magic != Loader::MakeMagic('L', 'F', 'S', 'C') ||
+        cache_header.version != CACHE_VERSION || cache_header.key != cache_key) {
+        LOG_INFO(Service_FS, "LayeredFS cache is outdated");
+        return false;
+    }
+
+    const std::size_t directories_offset = sizeof(cache_header);
+    const std::size_t files_offset =
+        directories_offset + cache_header.directory_count * sizeof(CacheDirectoryEntry);
+    const std::size_t string_pool_offset =
+        files_offset + cache_header.file_count * sizeof(CacheFileEntry);
+    const std::size_t metadata_offset =
+        Common::AlignUp(string_pool_offset + cache_header.string_pool_size, 16);
+    const std::size_t patched_data_offset = metadata_offset + cache_header.metadata_size;
+    if (patched_data_offset + cache_header.patched_data_size != size) {
+        LOG_ERROR(Service_FS, "LayeredFS cache is corrupted");
+        return false;
+    }
+
+    const auto read_string = [&](u32 offset, u32 length) {
+        if (static_cast<u64>(offset) + length > cache_header.string_pool_size) {
+            return std::string{};
+        }
+        return std::string(reinterpret_cast<const char*>(data + string_pool_offset + offset),
+                           length);
+    };
+
+    // Any added, removed or renamed entry changes the whole layout
+    std::vector<std::pair<std::string, s64>> directories;
+    directories.reserve(cache_header.directory_count);
+    for (u32 i = 0; i < cache_header.directory_count; ++i) {
+        CacheDirectoryEntry entry;
+        std::memcpy(&entry, data + directories_offset + i * sizeof(entry), sizeof(entry));
+
+        auto path = read_string(entry.path_offset, entry.path_length);
+        if (FileUtil::GetModificationTime(path) != entry.modification_time) {
+            LOG_INFO(Service_FS, "LayeredFS directory {} changed, rebuilding", path);
+            return false;
+        }
+        directories.emplace_back(std::move(path), entry.modification_time);
+    }
+
+    // Only redo the relocations whose source changed
+    bool dirty = false;
+    std::vector<std::unique_ptr<File>> files;
+    std::vector<u32> metadata_offsets;
+    files.reserve(cache_header.file_count);
+    metadata_offsets.reserve(cache_header.file_count);
+    for (u32 i = 0; i < cache_header.file_count; ++i) {
+        CacheFileEntry entry;
+        std::memcpy(&entry, data + files_offset + i * sizeof(entry), sizeof(entry));
+        if (entry.metadata_offset + sizeof(FileMetadata) > cache_header.metadata_size) {
+            LOG_ERROR(Service_FS, "LayeredFS cache is corrupted");
+            return false;
+        }
+
+        auto new_file = std::make_unique<File>();
+        new_file->path = read_string(entry.path_offset, entry.path_length);
+        new_file->name = new_file->path.substr(new_file->path.rfind('/') + 1);
+        new_file->parent = nullptr;
+
+        auto& relocation = new_file->relocation;
+        relocation.type = entry.type;
+        relocation.original_offset = entry.original_offset;
+        relocation.original_size = entry.original_size;
+        relocation.size = entry.size;
+        relocation.source_size = entry.source_size;
+        relocation.source_modification_time = entry.source_modification_time;
+        relocation.original_hash = entry.original_hash;
+
+        const auto source_path = read_string(entry.source_path_offset, entry.source_path_length);
+        const bool source_changed =
+            relocation.type != 0 &&
+            (FileUtil::GetModificationTime(source_path) != relocation.source_modification_time ||
+             FileUtil::GetSize(source_path) != relocation.source_size);
+
+        if (relocation.type == 1) {
+            relocation.replace_file_path = source_path;
+            if (source_changed) {
+                LOG_INFO(Service_FS, "LayeredFS replacement file for {} changed", new_file->path);
+                relocation.size = FileUtil::GetSize(source_path);
+                relocation.source_size = relocation.size;
+                relocation.source_modification_time = FileUtil::GetModificationTime(source_path);
+                dirty = true;
+            }
+        } else if (relocation.type == 2) {
+            // The layout of the RomFS is in the cache key, but its data can change without it,
+            // for example with an update
+            bool original_changed = false;
+            if (!source_changed) {
+                std::vector<u8> original(relocation.original_size);
+                romfs->ReadFile(relocation.original_offset, original.size(), original.data());
+                original_changed = Common::ComputeHash64(original.data(), original.size()) !=
+                                   relocation.original_hash;
+                if (original_changed) {
+                    LOG_INFO(Service_FS, "LayeredFS original data of {} changed", new_file->path);
+                }
+            }
+
+            if (source_changed || original_changed) {
+                if (source_changed) {
+                    LOG_INFO(Service_FS, "LayeredFS patch for {} changed", new_file->path);
+                }
+                if (!ApplyPatch(*new_file, source_path)) {
+                    relocation = {};
+                    relocation.original_offset = entry.original_offset;
+                    relocation.original_size = entry.original_size;
+                    relocation.size = entry.original_size;
+                }
+                dirty = true;
+            } else {
+                if (entry.patched_data_offset + entry.size > cache_header.patched_data_size) {
+                    LOG_ERROR(Service_FS, "LayeredFS cache is corrupted");
+                    return false;
+                }
+                const u8* patched = data + patched_data_offset + entry.patched_data_offset;
+                relocation.patch_file_path = source_path;
+                relocation.patched_file.assign(patched, patched + entry.size);
+            }
+        }
+
+        files.push_back(std::move(new_file));
+        metadata_offsets.push_back(entry.metadata_offset);
+    }
+
+    current_data_offset = 0;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        auto* current = files[i].get();
+        if (current->relocation.size != 0) {
+            data_offset_map.emplace(current_data_offset, current);
+        }
+        current_data_offset += Common::AlignUp(current->relocation.size, 16);
+    }
+
+    watched_directories = std::move(directories);
+    cached_files = std::move(files);
+
+    if (!dirty) {
+        cache_file = std::move(file);
+        metadata_data = cache_file.GetData() + metadata_offset;
+        metadata_size = cache_header.metadata_size;
+        LOG_INFO(Service_FS, "LayeredFS loaded {} files from cache", cached_files.size());
+        return true;
+    }
+
+    // Only file data offsets and lengths depend on file contents, patch them in place
+    metadata.assign(data + metadata_offset, data + patched_data_offset);
+    u64 data_offset = 0;
+    for (std::size_t i = 0; i < cached_files.size(); ++i) {
+        const auto offset = metadata_offsets[i];
+        FileMetadata file_metadata;
+        std::memcpy(&file_metadata, metadata.data() + offset, sizeof(file_metadata));
+        file_metadata.file_data_offset = data_offset;
+        file_metadata.file_data_length = cached_files[i]->relocation.size;
+        std::memcpy(metadata.data() + offset, &file_metadata, sizeof(file_metadata));
+
+        data_offset += Common::AlignUp(cached_files[i]->relocation.size, 16);
+    }
+    metadata_data = metadata.data();
+    metadata_size = metadata.size();
+
+    file.Close();
+
+    std::vector<File*> file_pointers(cached_files.size());
+    std::transform(cached_files.begin(), cached_files.end(), file_pointers.begin(),
+                   [](const auto& file) { return file.get(); });
+    SaveCache(file_pointers, metadata_offsets);
+
+    LOG_INFO(Service_FS, "LayeredFS updated cache with {} files", cached_files.size());
+    return true;
+}
+
+void LayeredFS::SaveCache(const std::vector<File*>& files, const std::vector<u32>& metadata_offsets) {
+    const std::string path = GetCachePath();
+    const auto directory = path.substr(0, path.rfind('/') + 1);
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Service_FS, "Could not create path {}", directory);
+        return;
+    }
+
+    std::string string_pool;
+    const auto add_string = [&string_pool](const std::string& str) {
+        const auto offset = static_cast<u32>(string_pool.size());
+        string_pool += str;
+        return offset;
+    };
+
+    std::vector<CacheDirectoryEntry> directory_entries;
+    directory_entries.reserve(watched_directories.size());
+    for (const auto& [directory, modification_time] : watched_directories) {
+        CacheDirectoryEntry entry;
+        entry.path_offset = add_string(directory);
+        entry.path_length = static_cast<u32>(directory.size());
+        entry.modification_time = modification_time;
+        directory_entries.push_back(entry);
+    }
+
+    std::vector<u8> patched_data;
+    std::vector<CacheFileEntry> file_entries;
+    file_entries.reserve(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const auto& relocation = files[i]->relocation;
+        std::string source_path;
+        if (relocation.type == 1) {
+            source_path = relocation.replace_file_path;
+        } else if (relocation.type == 2) {
+            source_path = relocation.patch_file_path;
+        }
+
+        CacheFileEntry entry;
+        entry.size = relocation.size;
+        entry.original_offset = relocation.original_offset;
+        entry.original_size = relocation.original_size;
+        entry.source_size = relocation.type != 0 ? relocation.source_size : 0;
+        entry.source_modification_time =
+            relocation.type != 0 ? relocation.source_modification_time : 0;
+        entry.patched_data_offset = patched_data.size();
+        entry.original_hash = relocation.type == 2 ? relocation.original_hash : 0;
+        entry.metadata_offset = metadata_offsets[i];
+        entry.type = relocation.type;
+        entry.path_offset = add_string(files[i]->path);
+        entry.path_length = static_cast<u32>(files[i]->path.size());
+        entry.source_path_offset = add_string(source_path);
+        entry.source_path_length = static_cast<u32>(source_path.size());
+        file_entries.push_back(entry);
+
+        if (relocation.type == 2) {
+            patched_data.insert(patched_data.end(), relocation.patched_file.begin(),
+                                relocation.patched_file.end());
+        }
+    }
+
+    CacheHeader cache_header;
+    cache_header.magic = Loader::MakeMagic('L', 'F', 'S', 'C');
+    cache_header.version = CACHE_VERSION;
+    cache_header.key = cache_key;
+    cache_header.metadata_size = metadata_size;
+    cache_header.string_pool_size = string_pool.size();
+    cache_header.patched_data_size = patched_data.size();
+    cache_header.directory_count = static_cast<u32>(directory_entries.size());
+    cache_header.file_count = static_cast<u32>(file_entries.size());
+
+    const std::size_t string_pool_end = sizeof(cache_header) +
+                                        directory_entries.size() * sizeof(CacheDirectoryEntry) +
+                                        file_entries.size() * sizeof(CacheFileEntry) +
+                                        string_pool.size();
+    const std::vector<u8> padding(Common::AlignUp(string_pool_end, 16) - string_pool_end);
+
+    FileUtil::IOFile file(path, "wb");
+    if (file.WriteObject(cache_header) != 1 ||
+        file.WriteArray(directory_entries.data(), directory_entries.size()) !=
+            directory_entries.size() ||
+        file.WriteArray(file_entries.data(), file_entries.size()) != file_entries.size() ||
+        file.WriteString(string_pool) != string_pool.size() ||
+        file.WriteBytes(padding.data(), padding.size()) != padding.size() ||
+        file.WriteBytes(metadata_data, metadata_size) != metadata_size ||
+        file.WriteBytes(patched_data.data(), patched_data.size()) != patched_data.size()) {
+        LOG_ERROR(Service_FS, "Could not write LayeredFS cache {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
 }
 
 std::size_t LayeredFS::GetSize() const {
-    return metadata.size() + current_data_offset;
+    return metadata_size + current_data_offset;
 }
 
 std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     ASSERT_MSG(offset + length <= GetSize(), "Out of bound");
 
     std::size_t read_size = 0;
-    if (offset < metadata.size()) {
+    if (offset < metadata_size) {
         // First read the metadata
-        const auto to_read = std::min(metadata.size() - offset, length);
-        std::memcpy(buffer, metadata.data() + offset, to_read);
+        const auto to_read = std::min(metadata_size - offset, length);
+        std::memcpy(buffer, metadata_data + offset, to_read);
         read_size += to_read;
         offset = 0;
     } else {
-        offset -= metadata.size();
+        offset -= metadata_size;
     }
 
     // Read files
@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "common/swap.h"
 #include "core/file_sys/romfs_reader.h"
 
@@ -37,6 +38,11 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ *
+ * When relocations are loaded, the rebuilt metadata is cached in user/cache/layered_fs/, keyed by
+ * the base RomFS metadata and the patch paths. The cache is memory-mapped on the next boot and
+ * stays valid as long as no patch directory was modified. Edited replacement or patch files only
+ * cause their own relocation to be redone.
  */
 class LayeredFS : public RomFSReader {
 public:
@@ -75,6 +81,12 @@ private:
     // Load patch/remove relocations
     void LoadExtRelocations();
 
+    // Apply the IPS/BPS patch at patch_file_path to the original contents of file
+    bool ApplyPatch(File& file, const std::string& patch_file_path);
+
+    // Remember a patch directory so that changes to its entries invalidate the cache
+    void WatchDirectory(const std::string& path);
+
     // Calculate the offset of a single directory add it to the map and list of directories
     void PrepareBuildDirectory(Directory& current);
 
@@ -94,6 +106,17 @@ private:
 
     void RebuildMetadata();
 
+    u64 ComputeCacheKey();
+    std::string GetCachePath() const;
+
+    // Restore the file layout and metadata from the cache.
+    // Returns false if the cache is missing or the directory structure has changed.
+    bool LoadCache();
+
+    // Save the cache. files are in data order, metadata_offsets are absolute offsets of
+    // their FileMetadata entries in metadata.
+    void SaveCache(const std::vector<File*>& files, const std::vector<u32>& metadata_offsets);
+
     std::shared_ptr<RomFSReader> romfs;
     std::string patch_path;
     std::string patch_ext_path;
@@ -105,6 +128,15 @@ private:
     std::map<u64, File*> data_offset_map; // assigned data offset -> file
     std::vector<u8> metadata;             // Includes header, hash table and metadata
 
+    // Points to either metadata or the memory-mapped cache
+    const u8* metadata_data{};
+    std::size_t metadata_size{};
+
+    u64 cache_key{};
+    FileUtil::MappedFile cache_file;
+    std::vector<std::unique_ptr<File>> cached_files; // files restored from the cache
+    std::vector<std::pair<std::string, s64>> watched_directories; // path -> modification time
+
     // Used for rebuilding header
     std::vector<u32_le> directory_hash_table;
     std::vector<u32_le> file_hash_table;
@@ -9,7 +9,10 @@
 #include <cstring>
 #include <memory>
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/swap.h"
 #include "core/core.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/ncch_container.h"
@@ -62,8 +65,11 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
     u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
     u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
 
-    memset(decompressed, 0, decompressed_size);
-    memcpy(decompressed, compressed, compressed_size);
+    if (decompressed_size < compressed_size)
+        return false;
+
+    std::memcpy(decompressed, compressed, compressed_size);
+    std::memset(decompressed + compressed_size, 0, decompressed_size - compressed_size);
 
     while (index > stop_index) {
         u8 control = compressed[--index];
@@ -88,29 +94,117 @@ static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decom
                 segment_offset += 2;
 
                 // Check if compression is out of bounds
-                if (out < segment_size)
+                if (out < segment_size || out + segment_offset >= decompressed_size)
                     return false;
 
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed_size)
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
+                // The source is `distance` bytes above the destination. Copy in chunks of at most
+                // `distance` bytes so that overlapping references repeat the bytes written by the
+                // previous chunk, like a byte-wise copy would.
+                const u32 distance = segment_offset + 1;
+                u32 remaining = segment_size;
+                while (remaining > 0) {
+                    const u32 chunk = std::min(remaining, distance);
+                    out -= chunk;
+                    std::memcpy(&decompressed[out], &decompressed[out + distance], chunk);
+                    remaining -= chunk;
                 }
+                control <<= 1;
             } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
-                decompressed[--out] = compressed[--index];
+                // Copy the whole run of literals selected by consecutive clear control bits
+                u32 run = 1;
+                while (i + run < 8 && (control & (0x80 >> run)) == 0)
+                    run++;
+                run = std::min({run, index - stop_index, out});
+
+                out -= run;
+                index -= run;
+                std::memcpy(&decompressed[out], &compressed[index], run);
+                control <<= run;
+                i += run - 1;
             }
-            control <<= 1;
         }
     }
     return true;
 }
 
+constexpr u32 CODE_CACHE_VERSION = 1;
+
+/// Header of a decompressed .code section cache file, followed by the decompressed code
+struct CodeCacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le key;
+    u64_le code_size;
+};
+static_assert(sizeof(CodeCacheHeader) == 0x18, "Size of CodeCacheHeader is not correct");
+
+static std::string GetCodeCachePath(u64 program_id) {
+    return fmt::format("{}code/{:016X}.bin", FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                       program_id);
+}
+
+/**
+ * Load a decompressed .code section from the code cache
+ * @param program_id Program ID of the title
+ * @param key Key of the compressed section, see NCCHContainer::ComputeCodeCacheKey
+ * @param code Vector to read the decompressed code into
+ * @returns True if the cache was valid
+ */
+static bool LoadCodeCache(u64 program_id, u64 key, std::vector<u8>& code) {
+    FileUtil::MappedFile file(GetCodeCachePath(program_id));
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    CodeCacheHeader cache_header;
+    if (file.GetSize() < sizeof(cache_header)) {
+        return false;
+    }
+    std::memcpy(&cache_header, file.GetData(), sizeof(cache_header));
+    if (cache_header.magic != Loader::MakeMagic('C', 'O', 'D', 'C') ||
+        cache_header.version != CODE_CACHE_VERSION || cache_header.key != key) {
+        LOG_INFO(Service_FS, "Code cache is outdated");
+        return false;
+    }
+    if (sizeof(cache_header) + cache_header.code_size != file.GetSize()) {
+        LOG_ERROR(Service_FS, "Code cache is corrupted");
+        return false;
+    }
+
+    const u8* data = file.GetData() + sizeof(cache_header);
+    code.assign(data, data + cache_header.code_size);
+    return true;
+}
+
+/**
+ * Save a decompressed .code section to the code cache
+ * @param program_id Program ID of the title
+ * @param key Key of the compressed section, see NCCHContainer::ComputeCodeCacheKey
+ * @param code The decompressed code
+ */
+static void SaveCodeCache(u64 program_id, u64 key, const std::vector<u8>& code) {
+    const std::string path = GetCodeCachePath(program_id);
+    const auto directory = path.substr(0, path.rfind('/') + 1);
+    if (!FileUtil::CreateFullPath(directory)) {
+        LOG_ERROR(Service_FS, "Could not create path {}", directory);
+        return;
+    }
+
+    CodeCacheHeader cache_header;
+    cache_header.magic = Loader::MakeMagic('C', 'O', 'D', 'C');
+    cache_header.version = CODE_CACHE_VERSION;
+    cache_header.key = key;
+    cache_header.code_size = code.size();
+
+    FileUtil::IOFile file(path, "wb");
+    if (file.WriteObject(cache_header) != 1 ||
+        file.WriteBytes(code.data(), code.size()) != code.size()) {
+        LOG_ERROR(Service_FS, "Could not write code cache {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+}
+
 NCCHContainer::NCCHContainer(const std::string& filepath, u32 ncch_offset, u32 partition)
     : ncch_offset(ncch_offset), partition(partition), filepath(filepath) {
     file = FileUtil::IOFile(filepath, "rb");
@@ -537,6 +631,13 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
             dec.Seek(section.offset + sizeof(ExeFs_Header));
 
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
+                // Skip reading, decrypting and decompressing the section if it's cached
+                const u64 cache_key = ComputeCodeCacheKey();
+                if (LoadCodeCache(ncch_header.program_id, cache_key, buffer)) {
+                    LOG_DEBUG(Service_FS, "Loaded .code from cache");
+                    return Loader::ResultStatus::Success;
+                }
+
                 // Section is compressed, read compressed .code section...
                 std::unique_ptr<u8[]> temp_buffer;
                 try {
@@ -560,6 +661,8 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                                      decompressed_size)) {
                     return Loader::ResultStatus::ErrorInvalidFormat;
                 }
+
+                SaveCodeCache(ncch_header.program_id, cache_key, buffer);
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
@@ -577,6 +680,16 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
     return Loader::ResultStatus::ErrorNotUsed;
 }
 
+u64 NCCHContainer::ComputeCodeCacheKey() const {
+    // The ExeFS header contains the SHA-256 hash of every section, including the one of an
+    // override ExeFS
+    constexpr u64 MULTIPLIER = 0x9E3779B97F4A7C15;
+    u64 key = Common::ComputeHash64(&ncch_header, sizeof(ncch_header));
+    key = key * MULTIPLIER ^ Common::ComputeHash64(&exheader_header, sizeof(exheader_header));
+    key = key * MULTIPLIER ^ Common::ComputeHash64(&exefs_header, sizeof(exefs_header));
+    return key;
+}
+
 Loader::ResultStatus NCCHContainer::ApplyCodePatch(std::vector<u8>& code) const {
     struct PatchLocation {
         std::string path;
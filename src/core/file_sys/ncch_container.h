@@ -334,6 +334,13 @@ public:
     ExHeader_Header exheader_header;
 
 private:
+    /**
+     * Computes the key of the decompressed .code section in the code cache, which changes
+     * whenever the NCCH header, the exheader or the ExeFS header (with the section hashes) do.
+     * @returns the cache key
+     */
+    u64 ComputeCodeCacheKey() const;
+
     bool has_header = false;
     bool has_exheader = false;
     bool has_exefs = false;
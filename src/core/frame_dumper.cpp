@@ -0,0 +1,363 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include <stb_image_write.h>
+#include "audio_core/audio_types.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/core_timing.h"
+#include "core/frame_dumper.h"
+#include "core/hw/gpu.h"
+
+namespace Core {
+
+namespace {
+
+// Flush buffered audio to disk about once per second of emulated time
+constexpr std::size_t AUDIO_FLUSH_SAMPLES = AudioCore::native_sample_rate * 2;
+
+struct WavHeader {
+    std::array<char, 4> riff_magic{'R', 'I', 'F', 'F'};
+    u32_le riff_size;
+    std::array<char, 4> wave_magic{'W', 'A', 'V', 'E'};
+    std::array<char, 4> fmt_magic{'f', 'm', 't', ' '};
+    u32_le fmt_size = 16;
+    u16_le audio_format = 1; // PCM
+    u16_le num_channels = 2;
+    u32_le sample_rate = AudioCore::native_sample_rate;
+    u32_le byte_rate = AudioCore::native_sample_rate * 2 * sizeof(s16);
+    u16_le block_align = 2 * sizeof(s16);
+    u16_le bits_per_sample = 16;
+    std::array<char, 4> data_magic{'d', 'a', 't', 'a'};
+    u32_le data_size;
+};
+static_assert(sizeof(WavHeader) == 44, "WavHeader has incorrect size");
+
+void WriteWavHeader(FileUtil::IOFile& file, u64 samples) {
+    WavHeader header{};
+    header.data_size = static_cast<u32>(samples * sizeof(s16));
+    header.riff_size = header.data_size + sizeof(WavHeader) - 8;
+    file.Seek(0, SEEK_SET);
+    file.WriteObject(header);
+}
+
+/// Converts bottom-up BGRA8 pixels to a top-down RGB8 PNG
+std::vector<u8> EncodePNG(const std::vector<u8>& pixels, u32 width, u32 height) {
+    std::vector<u8> rgb(width * height * 3);
+    for (u32 y = 0; y < height; ++y) {
+        const u8* src = &pixels[(height - 1 - y) * width * 4];
+        u8* dst = &rgb[y * width * 3];
+        for (u32 x = 0; x < width; ++x, src += 4, dst += 3) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+
+    std::vector<u8> png;
+    stbi_write_png_to_func(
+        [](void* context, void* data, int size) {
+            auto& out = *static_cast<std::vector<u8>*>(context);
+            const u8* bytes = static_cast<const u8*>(data);
+            out.insert(out.end(), bytes, bytes + size);
+        },
+        &png, static_cast<int>(width), static_cast<int>(height), 3, rgb.data(),
+        static_cast<int>(width * 3));
+    return png;
+}
+
+/// Converts bottom-up BGRA8 pixels to a top-down full range BT.601 YUV 4:4:4 Y4M frame
+std::vector<u8> EncodeY4M(const std::vector<u8>& pixels, u32 width, u32 height) {
+    static constexpr char frame_header[] = "FRAME\n";
+    constexpr std::size_t header_size = sizeof(frame_header) - 1;
+    const std::size_t plane_size = width * height;
+
+    std::vector<u8> frame(header_size + plane_size * 3);
+    std::memcpy(frame.data(), frame_header, header_size);
+    u8* y_plane = frame.data() + header_size;
+    u8* u_plane = y_plane + plane_size;
+    u8* v_plane = u_plane + plane_size;
+
+    const auto clamp = [](int value) { return static_cast<u8>(std::clamp(value, 0, 255)); };
+
+    for (u32 y = 0; y < height; ++y) {
+        const u8* src = &pixels[(height - 1 - y) * width * 4];
+        const std::size_t row = y * width;
+        for (u32 x = 0; x < width; ++x, src += 4) {
+            const int b = src[0];
+            const int g = src[1];
+            const int r = src[2];
+            y_plane[row + x] = clamp((77 * r + 150 * g + 29 * b + 128) >> 8);
+            u_plane[row + x] = clamp(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+            v_plane[row + x] = clamp(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+        }
+    }
+
+    return frame;
+}
+
+} // namespace
+
+FrameDumper::FrameDumper() = default;
+
+FrameDumper::~FrameDumper() {
+    StopDumping();
+}
+
+bool FrameDumper::StartDumping(const std::string& directory, Format format,
+                               const Layout::FramebufferLayout& layout) {
+    if (dumping) {
+        StopDumping();
+    }
+
+    this->directory = directory;
+    if (!this->directory.empty() && this->directory.back() != '/' &&
+        this->directory.back() != '\\') {
+        this->directory += '/';
+    }
+    if (!FileUtil::CreateFullPath(this->directory)) {
+        LOG_ERROR(Core, "Failed to create frame dumping directory {}", this->directory);
+        return false;
+    }
+
+    this->format = format;
+    this->layout = layout;
+
+    if (format == Format::Y4M) {
+        if (!video_file.Open(this->directory + "video.y4m", "wb")) {
+            LOG_ERROR(Core, "Failed to open {}video.y4m", this->directory);
+            return false;
+        }
+        video_file.WriteString(fmt::format(
+            "YUV4MPEG2 W{} H{} F{}:{} Ip A1:1 C444 XCOLORRANGE=FULL\n", layout.width,
+            layout.height, BASE_CLOCK_RATE_ARM11, GPU::frame_ticks));
+    }
+
+    if (!audio_file.Open(this->directory + "audio.wav", "wb")) {
+        LOG_ERROR(Core, "Failed to open {}audio.wav", this->directory);
+        video_file.Close();
+        return false;
+    }
+    WriteWavHeader(audio_file, 0);
+    audio_samples_written = 0;
+    {
+        std::lock_guard lock(audio_mutex);
+        audio_buffer.clear();
+    }
+
+    next_index = 0;
+    next_commit_index = 0;
+    last_encoded_frame.clear();
+    leading_repeats = 0;
+    dropped_frames = 0;
+    ++session;
+
+    stop_workers = false;
+    const unsigned worker_count = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+    for (unsigned i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&FrameDumper::WorkerThread, this);
+    }
+
+    dumping = true;
+    LOG_INFO(Core, "Started dumping frames to {} with {} workers", this->directory,
+             worker_count);
+    return true;
+}
+
+void FrameDumper::StopDumping() {
+    if (!dumping) {
+        return;
+    }
+
+    dumping = false;
+
+    PushJob([this] { FlushAudio(); });
+
+    {
+        std::unique_lock lock(jobs_mutex);
+        jobs_done_cv.wait(lock, [this] { return jobs.empty() && busy_workers == 0; });
+        stop_workers = true;
+    }
+    jobs_cv.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    ++session;
+
+    // Samples added while the final flush was running would otherwise leak into the next dump
+    {
+        std::lock_guard lock(audio_mutex);
+        audio_buffer.clear();
+    }
+
+    {
+        std::lock_guard lock(commit_mutex);
+        if (!pending_frames.empty()) {
+            LOG_WARNING(Core, "Discarding {} frames that were still in flight",
+                        pending_frames.size());
+            pending_frames.clear();
+        }
+        video_file.Close();
+    }
+
+    {
+        std::lock_guard lock(audio_file_mutex);
+        WriteWavHeader(audio_file, audio_samples_written);
+        audio_file.Close();
+    }
+
+    LOG_INFO(Core, "Stopped dumping frames, {} frames written, {} repeated",
+             next_commit_index, dropped_frames.load());
+}
+
+FrameDumper::FrameToken FrameDumper::ReserveFrame() {
+    return FrameToken{session, next_index++};
+}
+
+void FrameDumper::AddVideoFrame(const FrameToken& token, const u8* data) {
+    if (!dumping || token.session != session) {
+        return;
+    }
+
+    if (data == nullptr) {
+        RepeatFrame(token);
+        return;
+    }
+
+    std::vector<u8> pixels(data, data + layout.width * layout.height * 4);
+    PushJob([this, token, pixels = std::move(pixels)]() mutable {
+        EncodeFrame(token.session, token.index, std::move(pixels));
+    });
+}
+
+void FrameDumper::RepeatFrame(const FrameToken& token) {
+    if (!dumping || token.session != session) {
+        return;
+    }
+
+    ++dropped_frames;
+    PushJob([this, token] { CommitFrame(token.session, token.index, {}, true); });
+}
+
+void FrameDumper::AddAudioSamples(const std::array<s16, 2>* samples, std::size_t count) {
+    if (!dumping) {
+        return;
+    }
+
+    bool flush;
+    {
+        std::lock_guard lock(audio_mutex);
+        const s16* begin = samples->data();
+        audio_buffer.insert(audio_buffer.end(), begin, begin + count * 2);
+        flush = audio_buffer.size() >= AUDIO_FLUSH_SAMPLES;
+    }
+
+    if (flush) {
+        PushJob([this] { FlushAudio(); });
+    }
+}
+
+void FrameDumper::WorkerThread() {
+    std::unique_lock lock(jobs_mutex);
+    while (true) {
+        jobs_cv.wait(lock, [this] { return stop_workers || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        ++busy_workers;
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        --busy_workers;
+        if (jobs.empty() && busy_workers == 0) {
+            jobs_done_cv.notify_all();
+        }
+    }
+}
+
+void FrameDumper::PushJob(std::function<void()> job) {
+    {
+        std::lock_guard lock(jobs_mutex);
+        if (stop_workers) {
+            return;
+        }
+        jobs.push_back(std::move(job));
+    }
+    jobs_cv.notify_one();
+}
+
+void FrameDumper::EncodeFrame(u32 frame_session, u64 index, std::vector<u8> pixels) {
+    std::vector<u8> encoded = format == Format::PNG
+                                  ? EncodePNG(pixels, layout.width, layout.height)
+                                  : EncodeY4M(pixels, layout.width, layout.height);
+    CommitFrame(frame_session, index, std::move(encoded), false);
+}
+
+void FrameDumper::CommitFrame(u32 frame_session, u64 index, std::vector<u8> encoded,
+                              bool repeat) {
+    std::lock_guard lock(commit_mutex);
+    if (frame_session != session) {
+        return;
+    }
+
+    pending_frames.emplace(index, std::make_pair(std::move(encoded), repeat));
+
+    // Write every frame that is now contiguous with what's already on disk
+    auto it = pending_frames.begin();
+    while (it != pending_frames.end() && it->first == next_commit_index) {
+        auto& [frame, is_repeat] = it->second;
+        if (!is_repeat) {
+            last_encoded_frame = std::move(frame);
+
+            // Without them the video would start early and be out of sync with the audio
+            for (; leading_repeats > 0; --leading_repeats) {
+                WriteFrame(next_commit_index - leading_repeats, last_encoded_frame);
+            }
+        }
+        if (last_encoded_frame.empty()) {
+            ++leading_repeats;
+        } else {
+            WriteFrame(next_commit_index, last_encoded_frame);
+        }
+        ++next_commit_index;
+        it = pending_frames.erase(it);
+    }
+}
+
+void FrameDumper::WriteFrame(u64 index, const std::vector<u8>& encoded) {
+    if (format == Format::Y4M) {
+        video_file.WriteBytes(encoded.data(), encoded.size());
+        return;
+    }
+
+    const std::string path = fmt::format("{}frame_{:08}.png", directory, index);
+    FileUtil::IOFile file(path, "wb");
+    if (file.WriteBytes(encoded.data(), encoded.size()) != encoded.size()) {
+        LOG_ERROR(Core, "Failed to write {}", path);
+    }
+}
+
+void FrameDumper::FlushAudio() {
+    std::lock_guard file_lock(audio_file_mutex);
+
+    std::vector<s16> samples;
+    {
+        std::lock_guard lock(audio_mutex);
+        samples.swap(audio_buffer);
+    }
+
+    audio_file.WriteBytes(samples.data(), samples.size() * sizeof(s16));
+    audio_samples_written += samples.size();
+}
+
+} // namespace Core
@@ -0,0 +1,131 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/frontend/framebuffer_layout.h"
+
+namespace Core {
+
+/**
+ * Writes emulated frames (and the DSP output) to disk without blocking the emulation thread.
+ * Frames are reserved in presentation order by the renderer, filled in once their asynchronous
+ * readback completes, encoded on a pool of worker threads, and written out in order.
+ */
+class FrameDumper {
+public:
+    enum class Format {
+        PNG, ///< Lossless image sequence, one file per frame
+        Y4M, ///< Raw YUV 4:4:4 video stream
+    };
+
+    /// Identifies a frame slot reserved by the renderer
+    struct FrameToken {
+        u32 session = 0;
+        u64 index = 0;
+    };
+
+    FrameDumper();
+    ~FrameDumper();
+
+    /**
+     * Starts dumping to a directory. Audio is always written to audio.wav in that directory.
+     * @param directory the output directory, created if it doesn't exist
+     * @param format the video format
+     * @param layout the layout every dumped frame is rendered with
+     * @returns true on success
+     */
+    bool StartDumping(const std::string& directory, Format format,
+                      const Layout::FramebufferLayout& layout);
+
+    /// Stops dumping, waits for the workers to finish and finalizes the output files
+    void StopDumping();
+
+    bool IsDumping() const {
+        return dumping;
+    }
+
+    const Layout::FramebufferLayout& GetLayout() const {
+        return layout;
+    }
+
+    /// Reserves the next frame in presentation order. Must be followed by AddVideoFrame or
+    /// RepeatFrame with the same token.
+    FrameToken ReserveFrame();
+
+    /**
+     * Hands a read back frame to the encoder.
+     * @param token the token returned by ReserveFrame
+     * @param data bottom-up BGRA8 pixels matching the dumping layout, nullptr if the readback
+     * failed
+     */
+    void AddVideoFrame(const FrameToken& token, const u8* data);
+
+    /// Marks a reserved frame as a copy of the previous one, used when the readback was dropped
+    void RepeatFrame(const FrameToken& token);
+
+    /// Appends DSP output samples
+    void AddAudioSamples(const std::array<s16, 2>* samples, std::size_t count);
+
+    /// Returns the number of frames that were repeated because a readback was dropped
+    u64 GetDroppedFrames() const {
+        return dropped_frames;
+    }
+
+private:
+    void WorkerThread();
+    void PushJob(std::function<void()> job);
+
+    void EncodeFrame(u32 frame_session, u64 index, std::vector<u8> pixels);
+    void CommitFrame(u32 frame_session, u64 index, std::vector<u8> encoded, bool repeat);
+    void WriteFrame(u64 index, const std::vector<u8>& encoded);
+    void FlushAudio();
+
+    std::atomic<bool> dumping{false};
+    std::atomic<u32> session{0};
+    std::string directory;
+    Format format = Format::PNG;
+    Layout::FramebufferLayout layout{};
+    u64 next_index = 0;
+    std::atomic<u64> dropped_frames{0};
+
+    // Worker pool
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_cv;
+    std::condition_variable jobs_done_cv;
+    std::size_t busy_workers = 0;
+    bool stop_workers = false;
+
+    // Frames are encoded out of order and committed in order
+    std::mutex commit_mutex;
+    std::map<u64, std::pair<std::vector<u8>, bool>> pending_frames;
+    u64 next_commit_index = 0;
+    std::vector<u8> last_encoded_frame;
+    /// Repeats committed before the first encoded frame, they're written as that frame
+    u64 leading_repeats = 0;
+    FileUtil::IOFile video_file;
+
+    // Audio is buffered on the emulation thread and written by the workers
+    std::mutex audio_mutex;
+    std::vector<s16> audio_buffer;
+    std::mutex audio_file_mutex;
+    FileUtil::IOFile audio_file;
+    u64 audio_samples_written = 0;
+};
+
+} // namespace Core
@@ -0,0 +1,244 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include "audio_core/audio_types.h"
+#include "common/alignment.h"
+#include "common/logging/log.h"
+#include "core/frame_feed.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include "common/string_util.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Core {
+
+FrameFeed::FrameFeed() = default;
+
+FrameFeed::~FrameFeed() {
+    Stop();
+}
+
+bool FrameFeed::Start(const std::string& name, const Layout::FramebufferLayout& layout) {
+    std::lock_guard lock(mutex);
+    StopLocked();
+
+    const u64 frame_slot_size =
+        Common::AlignUp(sizeof(FrameFeedSlot) + layout.width * layout.height * 4, 64);
+    const u64 frame_slots_offset = Common::AlignUp(sizeof(FrameFeedHeader), 64);
+    const u64 audio_offset = frame_slots_offset + frame_slot_size * FRAME_SLOT_COUNT;
+    const u64 size = audio_offset + AUDIO_CAPACITY * sizeof(std::array<s16, 2>);
+
+    if (!CreateMemory(name, size)) {
+        return false;
+    }
+
+    FrameFeedHeader* header = new (memory) FrameFeedHeader;
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->frame_width = layout.width;
+    header->frame_height = layout.height;
+    header->frame_slot_count = FRAME_SLOT_COUNT;
+    header->audio_sample_rate = AudioCore::native_sample_rate;
+    header->frame_slot_size = frame_slot_size;
+    header->frame_slots_offset = frame_slots_offset;
+    header->audio_offset = audio_offset;
+    header->audio_capacity = AUDIO_CAPACITY;
+    header->reserved = 0;
+    header->latest_frame.store(0, std::memory_order_relaxed);
+    header->audio_write_position.store(0, std::memory_order_relaxed);
+
+    u8* slots = static_cast<u8*>(memory) + frame_slots_offset;
+    for (u32 i = 0; i < FRAME_SLOT_COUNT; ++i) {
+        FrameFeedSlot* slot = new (slots + i * frame_slot_size) FrameFeedSlot;
+        slot->sequence.store(0, std::memory_order_relaxed);
+        slot->emulated_time_us = 0;
+        slot->host_time_ns = 0;
+        slot->reserved = 0;
+    }
+
+    this->layout = layout;
+    next_sequence = 1;
+    ++session;
+    active = true;
+
+    LOG_INFO(Core, "Started the frame feed ({}x{}, {} bytes{}{})", layout.width, layout.height,
+             size, name.empty() ? "" : ", shared memory ", name);
+    return true;
+}
+
+void FrameFeed::Stop() {
+    std::lock_guard lock(mutex);
+    StopLocked();
+}
+
+void FrameFeed::StopLocked() {
+    if (!active) {
+        return;
+    }
+
+    active = false;
+    ++session;
+    DestroyMemory();
+
+    LOG_INFO(Core, "Stopped the frame feed");
+}
+
+Layout::FramebufferLayout FrameFeed::GetLayout() const {
+    std::lock_guard lock(mutex);
+    return layout;
+}
+
+FrameFeed::FrameToken FrameFeed::ReserveFrame(u64 emulated_time_us) {
+    std::lock_guard lock(mutex);
+    return FrameToken{session, next_sequence++, emulated_time_us, layout};
+}
+
+void FrameFeed::PublishFrame(const FrameToken& token, const u8* data) {
+    if (!active || data == nullptr) {
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    if (memory == nullptr || token.session != session) {
+        return;
+    }
+
+    FrameFeedHeader& header = Header();
+    u8* slot_data = static_cast<u8*>(memory) + header.frame_slots_offset +
+                    (token.sequence % FRAME_SLOT_COUNT) * header.frame_slot_size;
+    FrameFeedSlot& slot = *reinterpret_cast<FrameFeedSlot*>(slot_data);
+
+    // Readers that see a 0 or a different sequence after reading discard the frame
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(slot_data + sizeof(FrameFeedSlot), data, layout.width * layout.height * 4);
+    slot.emulated_time_us = token.emulated_time_us;
+    slot.host_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+
+    slot.sequence.store(token.sequence, std::memory_order_release);
+    header.latest_frame.store(token.sequence, std::memory_order_release);
+}
+
+void FrameFeed::AddAudioSamples(const std::array<s16, 2>* samples, std::size_t count) {
+    if (!active) {
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    if (memory == nullptr) {
+        return;
+    }
+
+    FrameFeedHeader& header = Header();
+    auto* ring = reinterpret_cast<std::array<s16, 2>*>(static_cast<u8*>(memory) +
+                                                       header.audio_offset);
+    u64 position = header.audio_write_position.load(std::memory_order_relaxed);
+
+    // Only the newest AUDIO_CAPACITY frames can be kept anyway
+    if (count > AUDIO_CAPACITY) {
+        samples += count - AUDIO_CAPACITY;
+        position += count - AUDIO_CAPACITY;
+        count = AUDIO_CAPACITY;
+    }
+
+    const std::size_t start = static_cast<std::size_t>(position % AUDIO_CAPACITY);
+    const std::size_t first = std::min<std::size_t>(count, AUDIO_CAPACITY - start);
+    std::memcpy(ring + start, samples, first * sizeof(std::array<s16, 2>));
+    std::memcpy(ring, samples + first, (count - first) * sizeof(std::array<s16, 2>));
+
+    header.audio_write_position.store(position + count, std::memory_order_release);
+}
+
+bool FrameFeed::CreateMemory(const std::string& name, std::size_t size) {
+#ifdef _WIN32
+    const std::wstring wide_name = Common::UTF8ToUTF16W(name);
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<u64>(size) >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFF),
+                                        name.empty() ? nullptr : wide_name.c_str());
+    if (mapping == nullptr) {
+        LOG_ERROR(Core, "Failed to create the frame feed shared memory {}", name);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        LOG_ERROR(Core, "Failed to map the frame feed shared memory {}", name);
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mapping_handle = mapping;
+#else
+    void* view;
+    if (name.empty()) {
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    } else {
+        // Replace a region left behind by a crashed instance
+        const std::string path = '/' + name;
+        shm_unlink(path.c_str());
+        const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1) {
+            LOG_ERROR(Core, "Failed to create the frame feed shared memory {}", name);
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            LOG_ERROR(Core, "Failed to resize the frame feed shared memory {}", name);
+            close(fd);
+            shm_unlink(path.c_str());
+            return false;
+        }
+        view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED) {
+            shm_unlink(path.c_str());
+        }
+    }
+    if (view == MAP_FAILED) {
+        LOG_ERROR(Core, "Failed to map the frame feed shared memory {}", name);
+        return false;
+    }
+#endif
+
+    memory = view;
+    memory_size = size;
+    shared_memory_name = name;
+    return true;
+}
+
+void FrameFeed::DestroyMemory() {
+    if (memory == nullptr) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(memory);
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+    mapping_handle = nullptr;
+#else
+    munmap(memory, memory_size);
+    if (!shared_memory_name.empty()) {
+        // Processes that still have the region mapped keep it until they unmap it
+        shm_unlink(('/' + shared_memory_name).c_str());
+    }
+#endif
+
+    memory = nullptr;
+    memory_size = 0;
+    shared_memory_name.clear();
+}
+
+} // namespace Core
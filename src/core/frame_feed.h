@@ -0,0 +1,148 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "common/common_types.h"
+#include "core/frontend/framebuffer_layout.h"
+
+namespace Core {
+
+/**
+ * Publishes emulated frames and the DSP output to a shared memory region, so that plugins and
+ * external processes (for example encoders) can consume them in place without stalling emulation.
+ *
+ * The region starts with a FrameFeedHeader, followed by FRAME_SLOT_COUNT frame slots and the
+ * audio ring, at the offsets stored in the header. Every frame slot starts with a FrameFeedSlot
+ * and is followed by bottom-up BGRA8 pixels.
+ *
+ * Frames are written round-robin to the slots (frame N goes to slot N % FRAME_SLOT_COUNT), so the
+ * newest frame is never overwritten before FRAME_SLOT_COUNT - 1 more frames are published. Each
+ * slot is a seqlock: its sequence is 0 while the frame is being written. Readers load the sequence,
+ * read the frame, load the sequence again and discard the frame if it's 0 or changed.
+ *
+ * The audio ring holds interleaved stereo s16 samples at the native sample rate. The writer
+ * publishes the total number of stereo frames ever written in audio_write_position, a reader that
+ * falls behind by more than audio_capacity frames lost samples.
+ */
+class FrameFeed {
+public:
+    static constexpr u32 MAGIC = 0x44464656; // VFFD
+    static constexpr u32 VERSION = 1;
+    static constexpr u32 FRAME_SLOT_COUNT = 3;
+    static constexpr u32 AUDIO_CAPACITY = 1 << 15;
+
+    struct FrameFeedHeader {
+        u32 magic;
+        u32 version;
+        u32 frame_width;
+        u32 frame_height;
+        u32 frame_slot_count;
+        u32 audio_sample_rate;
+        u64 frame_slot_size; ///< Including the FrameFeedSlot
+        u64 frame_slots_offset;
+        u64 audio_offset;
+        u32 audio_capacity; ///< In stereo frames
+        u32 reserved;
+        std::atomic<u64> latest_frame;         ///< Sequence of the newest frame, 0 if none
+        std::atomic<u64> audio_write_position; ///< Stereo frames written since the feed started
+    };
+    static_assert(sizeof(FrameFeedHeader) == 0x48, "FrameFeedHeader has incorrect size");
+
+    struct FrameFeedSlot {
+        std::atomic<u64> sequence; ///< Frame number starting at 1, 0 while being written
+        u64 emulated_time_us;      ///< Emulated time when the frame was presented
+        u64 host_time_ns;          ///< Host steady clock time when the frame was published
+        u64 reserved;
+    };
+    static_assert(sizeof(FrameFeedSlot) == 0x20, "FrameFeedSlot has incorrect size");
+
+    static_assert(std::atomic<u64>::is_always_lock_free,
+                  "Atomics in shared memory must be lock free");
+
+    /// Identifies a frame presented by the renderer whose readback is in flight
+    struct FrameToken {
+        u32 session = 0;
+        u64 sequence = 0;
+        u64 emulated_time_us = 0;
+        Layout::FramebufferLayout layout{}; ///< The layout of the session the frame belongs to
+    };
+
+    FrameFeed();
+    ~FrameFeed();
+
+    /**
+     * Creates the shared memory region and starts publishing.
+     * @param name name of the shared memory object, if empty the region is only visible to this
+     * process (and thus plugins)
+     * @param layout the layout every frame is rendered with
+     * @returns true on success
+     */
+    bool Start(const std::string& name, const Layout::FramebufferLayout& layout);
+
+    /// Stops publishing and releases the shared memory region
+    void Stop();
+
+    bool IsActive() const {
+        return active;
+    }
+
+    /// Returns the start of the shared memory region, nullptr if the feed isn't active
+    void* GetMemory() const {
+        return memory;
+    }
+
+    std::size_t GetMemorySize() const {
+        return memory_size;
+    }
+
+    /// Returns a copy, since the feed can be restarted with another layout by plugin threads
+    Layout::FramebufferLayout GetLayout() const;
+
+    /**
+     * Assigns the next sequence number to a presented frame, must be followed by PublishFrame.
+     * The frame must be read back with the layout in the returned token.
+     */
+    FrameToken ReserveFrame(u64 emulated_time_us);
+
+    /**
+     * Copies a read back frame into its slot.
+     * @param token the token returned by ReserveFrame
+     * @param data bottom-up BGRA8 pixels matching the layout, nullptr if the readback failed
+     */
+    void PublishFrame(const FrameToken& token, const u8* data);
+
+    /// Appends DSP output samples to the audio ring
+    void AddAudioSamples(const std::array<s16, 2>* samples, std::size_t count);
+
+private:
+    void StopLocked();
+    bool CreateMemory(const std::string& name, std::size_t size);
+    void DestroyMemory();
+
+    FrameFeedHeader& Header() const {
+        return *static_cast<FrameFeedHeader*>(memory);
+    }
+
+    std::atomic<bool> active{false};
+    std::atomic<u32> session{0};
+    Layout::FramebufferLayout layout{};
+    u64 next_sequence = 1;
+
+    // Held while writing to the region, so that it can't be released under a writer, and while
+    // accessing the layout and the sequence, which plugin threads change by restarting the feed
+    mutable std::mutex mutex;
+    void* memory = nullptr;
+    std::size_t memory_size = 0;
+    std::string shared_memory_name;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace Core
@@ -15,6 +15,8 @@
 #include <fmt/format.h>
 #include <map>
 #include <numeric>
+#include <string>
+#include <string_view>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -31,6 +33,11 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_BENCHMARKS
+#include <chrono>
+#include <random>
+#endif
+
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -41,7 +48,10 @@
 
 namespace GDBStub {
 namespace {
-constexpr int GDB_BUFFER_SIZE = 10000;
+// Largest packet gdb may send or receive, advertised through qSupported. Large packets let bulk
+// memory transfers use fewer round trips.
+constexpr u32 MAX_PACKET_SIZE = 0x10000;
+constexpr int GDB_BUFFER_SIZE = MAX_PACKET_SIZE + 4;
 
 constexpr char GDB_STUB_START = '$';
 constexpr char GDB_STUB_END = '#';
@@ -56,10 +66,6 @@ constexpr u32 SIGTRAP = 5;
 constexpr u32 SIGTERM = 15;
 #endif
 
-#ifndef MSG_WAITALL
-constexpr u32 MSG_WAITALL = 8;
-#endif
-
 constexpr u32 SP_REGISTER = 13;
 constexpr u32 LR_REGISTER = 14;
 constexpr u32 PC_REGISTER = 15;
@@ -126,6 +132,11 @@ bool defer_start = false;
 u8 command_buffer[GDB_BUFFER_SIZE];
 u32 command_length;
 
+// Socket input is read in chunks instead of one recv per byte
+std::array<u8, 0x4000> receive_buffer;
+std::size_t receive_position = 0;
+std::size_t receive_size = 0;
+
 u32 latest_signal = 0;
 bool memory_break = false;
 
@@ -158,6 +169,11 @@ using BreakpointMap = std::map<VAddr, Breakpoint>;
 BreakpointMap breakpoints_execute;
 BreakpointMap breakpoints_read;
 BreakpointMap breakpoints_write;
+
+// Lengths of the longest read and write breakpoints set, the breakpoints that cover an address
+// start at most this far below it
+u32 longest_breakpoint_read = 0;
+u32 longest_breakpoint_write = 0;
 } // Anonymous namespace
 
 static Kernel::Thread* FindThreadById(int id) {
@@ -262,6 +278,16 @@ static u8 NibbleToHex(u8 n) {
     }
 }
 
+/// Hex characters of every byte value, used to convert memory in bulk
+constexpr auto HEX_TABLE = [] {
+    std::array<std::array<u8, 2>, 256> table{};
+    constexpr char digits[] = "0123456789abcdef";
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = {static_cast<u8>(digits[i >> 4]), static_cast<u8>(digits[i & 0xF])};
+    }
+    return table;
+}();
+
 /**
  * Converts input hex string characters into an array of equivalent of u8 bytes.
  *
@@ -286,9 +312,9 @@ static u32 HexToInt(const u8* src, std::size_t len) {
  */
 static void MemToGdbHex(u8* dest, const u8* src, std::size_t len) {
     while (len-- > 0) {
-        u8 tmp = *src++;
-        *dest++ = NibbleToHex(tmp >> 4);
-        *dest++ = NibbleToHex(tmp);
+        const auto& hex = HEX_TABLE[*src++];
+        *dest++ = hex[0];
+        *dest++ = hex[1];
     }
 }
 
@@ -366,14 +392,21 @@ static u64 GdbHexToLong(const u8* src) {
 
 /// Read a byte from the gdb client.
 static u8 ReadByte() {
-    u8 c;
-    std::size_t received_size = recv(gdbserver_socket, reinterpret_cast<char*>(&c), 1, MSG_WAITALL);
-    if (received_size != 1) {
-        LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
-        Shutdown();
+    if (receive_position == receive_size) {
+        const int received_size =
+            recv(gdbserver_socket, reinterpret_cast<char*>(receive_buffer.data()),
+                 static_cast<int>(receive_buffer.size()), 0);
+        if (received_size <= 0) {
+            LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
+            Shutdown();
+            return 0;
+        }
+
+        receive_position = 0;
+        receive_size = static_cast<std::size_t>(received_size);
     }
 
-    return c;
+    return receive_buffer[receive_position++];
 }
 
 /// Calculate the checksum of the current command buffer.
@@ -381,6 +414,16 @@ static u8 CalculateChecksum(const u8* buffer, std::size_t length) {
     return static_cast<u8>(std::accumulate(buffer, buffer + length, 0, std::plus<u8>()));
 }
 
+/**
+ * Get the number of bytes replaced by the trap of an execution breakpoint.
+ *
+ * @param breakpoint The breakpoint, its length is the kind sent by the client.
+ */
+static u32 GetTrapSize(const Breakpoint& breakpoint) {
+    // Kind 2 is a 16-bit Thumb breakpoint
+    return breakpoint.length == 2 ? 2 : 4;
+}
+
 /**
  * Get the map of breakpoints for a given breakpoint type.
  *
@@ -399,6 +442,15 @@ static BreakpointMap& GetBreakpointMap(BreakpointType type) {
     }
 }
 
+/**
+ * Get the length of the longest read or write breakpoint that was set.
+ *
+ * @param type Type of breakpoint.
+ */
+static u32& GetLongestBreakpointLength(BreakpointType type) {
+    return type == BreakpointType::Write ? longest_breakpoint_write : longest_breakpoint_read;
+}
+
 /**
  * Remove the breakpoint from the given address of the specified type.
  *
@@ -418,15 +470,19 @@ static void RemoveBreakpoint(BreakpointType type, VAddr address) {
 
     if (type == BreakpointType::Execute) {
         Core::System& system = Core::System::GetInstance();
+        const u32 trap_size = GetTrapSize(bp->second);
         system.Memory().WriteBlock(*system.Kernel().GetCurrentProcess(), bp->second.address,
-                                   bp->second.instruction.data(), bp->second.instruction.size());
+                                   bp->second.instruction.data(), trap_size);
         u32 num_cores = system.GetNumCores();
         for (u32 i = 0; i < num_cores; ++i) {
-            system.GetCore(i).ClearInstructionCache();
+            system.GetCore(i).InvalidateCacheRange(bp->second.address, trap_size);
         }
     }
 
     p.erase(address);
+    if (p.empty() && type != BreakpointType::Execute) {
+        GetLongestBreakpointLength(type) = 0;
+    }
 }
 
 BreakpointAddress GetNextBreakpointFromAddress(VAddr address, BreakpointType type) {
@@ -445,43 +501,64 @@ BreakpointAddress GetNextBreakpointFromAddress(VAddr address, BreakpointType typ
     return breakpoint;
 }
 
-bool CheckBreakpoint(VAddr address, BreakpointType type) {
-    if (!IsConnected()) {
-        return false;
-    }
-
-    const BreakpointMap& p = GetBreakpointMap(type);
-    const auto bp = p.find(address);
+bool HasMemoryBreakpoints() {
+    return IsConnected() && (!breakpoints_read.empty() || !breakpoints_write.empty());
+}
 
-    if (bp == p.end()) {
-        return false;
-    }
+/**
+ * Check if a breakpoint in the map covers the given address.
+ *
+ * @param p Map of breakpoints.
+ * @param address Address to check.
+ * @param type Type of the breakpoints in the map.
+ * @param longest_length Length of the longest breakpoint in the map.
+ */
+static bool FindBreakpoint(const BreakpointMap& p, VAddr address, BreakpointType type,
+                           u32 longest_length) {
+    // A longer breakpoint starting further below may cover the address even if the ones closer to
+    // it don't, so every breakpoint that starts close enough to reach it is checked
+    for (auto bp = p.upper_bound(address); bp != p.begin();) {
+        --bp;
+        if (address - bp->second.address >= longest_length) {
+            return false;
+        }
 
-    u32 length = bp->second.length;
+        u32 length = bp->second.length;
+
+        // IDA Pro defaults to 4-byte breakpoints for all non-hardware breakpoints
+        // no matter if it's a 4-byte or 2-byte instruction. When you execute a
+        // Thumb instruction with a 4-byte breakpoint set, it will set a breakpoint on
+        // two instructions instead of the single instruction you placed the breakpoint
+        // on. So, as a way to make sure that execution breakpoints are only breaking
+        // on the instruction that was specified, set the length of an execution
+        // breakpoint to 1. This should be fine since the CPU should never begin executing
+        // an instruction anywhere except the beginning of the instruction.
+        if (type == BreakpointType::Execute) {
+            length = 1;
+        }
 
-    // IDA Pro defaults to 4-byte breakpoints for all non-hardware breakpoints
-    // no matter if it's a 4-byte or 2-byte instruction. When you execute a
-    // Thumb instruction with a 4-byte breakpoint set, it will set a breakpoint on
-    // two instructions instead of the single instruction you placed the breakpoint
-    // on. So, as a way to make sure that execution breakpoints are only breaking
-    // on the instruction that was specified, set the length of an execution
-    // breakpoint to 1. This should be fine since the CPU should never begin executing
-    // an instruction anywhere except the beginning of the instruction.
-    if (type == BreakpointType::Execute) {
-        length = 1;
+        if (bp->second.active && address - bp->second.address < length) {
+            LOG_DEBUG(Debug_GDBStub,
+                      "Found breakpoint type {} @ {:08x}, range: {:08x}"
+                      " - {:08x} ({:x} bytes)",
+                      static_cast<int>(type), address, bp->second.address,
+                      bp->second.address + length, length);
+            return true;
+        }
     }
 
-    if (bp->second.active &&
-        (address >= bp->second.address && address < bp->second.address + length)) {
-        LOG_DEBUG(Debug_GDBStub,
-                  "Found breakpoint type {} @ {:08x}, range: {:08x}"
-                  " - {:08x} ({:x} bytes)",
-                  static_cast<int>(type), address, bp->second.address, bp->second.address + length,
-                  length);
-        return true;
+    return false;
+}
+
+bool CheckBreakpoint(VAddr address, BreakpointType type) {
+    if (!IsConnected()) {
+        return false;
     }
 
-    return false;
+    // Execution breakpoints only cover their own address, see FindBreakpoint
+    const u32 longest_length =
+        type == BreakpointType::Execute ? 1 : GetLongestBreakpointLength(type);
+    return FindBreakpoint(GetBreakpointMap(type), address, type, longest_length);
 }
 
 /**
@@ -496,36 +573,43 @@ static void SendPacket(const char packet) {
     }
 }
 
+/**
+ * Build the packet of a reply, with its start and end characters and its checksum.
+ *
+ * @param packet String the packet is built in.
+ * @param reply Reply, may contain binary data that is already escaped.
+ */
+static void BuildPacket(std::string& packet, std::string_view reply) {
+    packet.clear();
+    packet.reserve(reply.size() + 4);
+
+    const u8 checksum =
+        CalculateChecksum(reinterpret_cast<const u8*>(reply.data()), reply.size());
+    packet += GDB_STUB_START;
+    packet += reply;
+    packet += GDB_STUB_END;
+    packet += static_cast<char>(NibbleToHex(checksum >> 4));
+    packet += static_cast<char>(NibbleToHex(checksum));
+}
+
 /**
  * Send reply to gdb client.
  *
- * @param reply Reply to be sent to client.
+ * @param reply Reply to be sent to client, may contain binary data that is already escaped.
  */
-static void SendReply(const char* reply) {
+static void SendReply(std::string_view reply) {
     if (!IsConnected()) {
         return;
     }
 
-    memset(command_buffer, 0, sizeof(command_buffer));
+    // The whole packet is built first so that it goes out with as few sends as possible
+    static std::string packet;
+    BuildPacket(packet, reply);
 
-    command_length = static_cast<u32>(strlen(reply));
-    if (command_length + 4 > sizeof(command_buffer)) {
-        LOG_ERROR(Debug_GDBStub, "command_buffer overflow in SendReply");
-        return;
-    }
-
-    memcpy(command_buffer + 1, reply, command_length);
-
-    u8 checksum = CalculateChecksum(command_buffer, command_length + 1);
-    command_buffer[0] = GDB_STUB_START;
-    command_buffer[command_length + 1] = GDB_STUB_END;
-    command_buffer[command_length + 2] = NibbleToHex(checksum >> 4);
-    command_buffer[command_length + 3] = NibbleToHex(checksum);
-
-    u8* ptr = command_buffer;
-    u32 left = command_length + 4;
+    const char* ptr = packet.data();
+    std::size_t left = packet.size();
     while (left > 0) {
-        int sent_size = send(gdbserver_socket, reinterpret_cast<char*>(ptr), left, 0);
+        const int sent_size = send(gdbserver_socket, ptr, static_cast<int>(left), 0);
         if (sent_size < 0) {
             LOG_ERROR(Debug_GDBStub, "gdb: send failed");
             return Shutdown();
@@ -536,6 +620,51 @@ static void SendReply(const char* reply) {
     }
 }
 
+/**
+ * Appends data to a reply, escaping the characters that can't appear in binary data.
+ *
+ * @param reply Reply to append to.
+ * @param data Data to append.
+ * @param length Length of data.
+ */
+static void AppendBinary(std::string& reply, const u8* data, std::size_t length) {
+    reply.reserve(reply.size() + length);
+    for (std::size_t i = 0; i < length; ++i) {
+        const u8 c = data[i];
+        if (c == '#' || c == '$' || c == '}' || c == '*') {
+            reply += '}';
+            reply += static_cast<char>(c ^ 0x20);
+        } else {
+            reply += static_cast<char>(c);
+        }
+    }
+}
+
+/**
+ * Send the part of a qXfer object that the client asked for.
+ *
+ * @param object The whole object.
+ * @param arguments The "offset,length" arguments of the request.
+ */
+static void SendXferReply(std::string_view object, const u8* arguments) {
+    const u8* end = command_buffer + command_length;
+    const u8* comma = std::find(arguments, end, ',');
+    if (comma == end) {
+        return SendReply("E01");
+    }
+    const u32 offset = HexToInt(arguments, static_cast<u32>(comma - arguments));
+    const u32 length = HexToInt(comma + 1, static_cast<u32>(end - comma - 1));
+
+    if (offset >= object.size()) {
+        return SendReply("l");
+    }
+
+    const std::string_view part = object.substr(offset, length);
+    std::string reply(1, offset + part.size() < object.size() ? 'm' : 'l');
+    AppendBinary(reply, reinterpret_cast<const u8*>(part.data()), part.size());
+    SendReply(reply);
+}
+
 /// Handle query command from gdb client.
 static void HandleQuery() {
     LOG_DEBUG(Debug_GDBStub, "gdb: query '{}'\n", command_buffer + 1);
@@ -545,11 +674,12 @@ static void HandleQuery() {
     if (strcmp(query, "TStatus") == 0) {
         SendReply("T0");
     } else if (strncmp(query, "Supported", strlen("Supported")) == 0) {
-        // PacketSize needs to be large enough for target xml
-        SendReply("PacketSize=2000;qXfer:features:read+;qXfer:threads:read+");
+        SendReply(fmt::format("PacketSize={:x};qXfer:features:read+;qXfer:threads:read+;"
+                              "binary-upload+",
+                              MAX_PACKET_SIZE));
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
-        SendReply(target_xml);
+        SendXferReply(target_xml, command_buffer + 1 + strlen("Xfer:features:read:target.xml:"));
     } else if (strncmp(query, "fThreadInfo", strlen("fThreadInfo")) == 0) {
         std::string val = "m";
         Core::System& system = Core::System::GetInstance();
@@ -565,9 +695,9 @@ static void HandleQuery() {
         SendReply(val.c_str());
     } else if (strncmp(query, "sThreadInfo", strlen("sThreadInfo")) == 0) {
         SendReply("l");
-    } else if (strncmp(query, "Xfer:threads:read", strlen("Xfer:threads:read")) == 0) {
+    } else if (strncmp(query, "Xfer:threads:read::", strlen("Xfer:threads:read::")) == 0) {
         std::string buffer;
-        buffer += "l<?xml version=\"1.0\"?>";
+        buffer += "<?xml version=\"1.0\"?>";
         buffer += "<threads>";
         Core::System& system = Core::System::GetInstance();
         Kernel::KernelSystem& kernel = system.Kernel();
@@ -580,7 +710,7 @@ static void HandleQuery() {
             }
         }
         buffer += "</threads>";
-        SendReply(buffer.c_str());
+        SendXferReply(buffer, command_buffer + 1 + strlen("Xfer:threads:read::"));
     } else {
         SendReply("");
     }
@@ -655,8 +785,9 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
 
 /// Read command from gdb client.
 static void ReadCommand() {
+    // Only the previous command needs to be cleared, the rest of the buffer is still zero
+    memset(command_buffer, 0, command_length);
     command_length = 0;
-    memset(command_buffer, 0, sizeof(command_buffer));
 
     u8 c = ReadByte();
     if (c == '+') {
@@ -673,8 +804,13 @@ static void ReadCommand() {
     }
 
     while ((c = ReadByte()) != GDB_STUB_END) {
-        if (command_length >= sizeof(command_buffer)) {
+        if (!IsConnected()) {
+            return;
+        }
+        if (command_length >= sizeof(command_buffer) - 1) {
             LOG_ERROR(Debug_GDBStub, "gdb: command_buffer overflow\n");
+            memset(command_buffer, 0, command_length);
+            command_length = 0;
             SendPacket(GDB_STUB_NACK);
             return;
         }
@@ -692,6 +828,7 @@ static void ReadCommand() {
             "gdb: invalid checksum: calculated {:02x} and read {:02x} for ${}# (length: {})\n",
             checksum_calculated, checksum_received, command_buffer, command_length);
 
+        memset(command_buffer, 0, command_length);
         command_length = 0;
 
         SendPacket(GDB_STUB_NACK);
@@ -707,6 +844,10 @@ static bool IsDataAvailable() {
         return false;
     }
 
+    if (receive_position < receive_size) {
+        return true;
+    }
+
     fd_set fd_socket;
 
     FD_ZERO(&fd_socket);
@@ -837,64 +978,181 @@ static void WriteRegisters() {
     SendReply("OK");
 }
 
-/// Read location in memory specified by gdb client.
-static void ReadMemory() {
-    static u8 reply[GDB_BUFFER_SIZE - 4];
+/**
+ * Parse the "addr,length" arguments of a memory packet.
+ *
+ * @param address Parsed address.
+ * @param length Parsed length.
+ * @returns Pointer to the ':' that starts the data of write packets, or the end of the command.
+ */
+static const u8* ParseMemoryArguments(VAddr& address, u32& length) {
+    const u8* end = command_buffer + command_length;
+    const u8* start_offset = command_buffer + 1;
+    const u8* address_position = std::find(start_offset, end, ',');
+    address = HexToInt(start_offset, static_cast<u32>(address_position - start_offset));
 
-    auto start_offset = command_buffer + 1;
-    auto address_position = std::find(start_offset, command_buffer + command_length, ',');
-    VAddr address = HexToInt(start_offset, static_cast<u32>(address_position - start_offset));
+    start_offset = std::min(address_position + 1, end);
+    const u8* length_position = std::find(start_offset, end, ':');
+    length = HexToInt(start_offset, static_cast<u32>(length_position - start_offset));
 
-    start_offset = address_position + 1;
-    u32 length =
-        HexToInt(start_offset, static_cast<u32>((command_buffer + command_length) - start_offset));
+    return length_position;
+}
+
+/**
+ * Replace the traps of execution breakpoints in memory read by the client with the original
+ * instructions, the client doesn't expect to see its own breakpoints.
+ *
+ * @param address Address the data was read from.
+ * @param data Data read from memory.
+ * @param length Length of data.
+ */
+static void HideBreakpoints(VAddr address, u8* data, u32 length) {
+    const u64 end = static_cast<u64>(address) + length;
+    auto bp = breakpoints_execute.lower_bound(address >= 3 ? address - 3 : 0);
+    for (; bp != breakpoints_execute.end() && bp->first < end; ++bp) {
+        const Breakpoint& breakpoint = bp->second;
+        const u32 trap_size = GetTrapSize(breakpoint);
+        for (u32 i = 0; i < trap_size; ++i) {
+            const u64 byte_address = static_cast<u64>(breakpoint.address) + i;
+            if (byte_address >= address && byte_address < end) {
+                data[byte_address - address] = breakpoint.instruction[i];
+            }
+        }
+    }
+}
+
+/**
+ * Read memory specified by a memory read packet for the gdb client.
+ *
+ * @param data Buffer the memory is read into.
+ * @param max_length Largest length the reply can fit.
+ * @returns false if a reply with an error was sent.
+ */
+static bool ReadMemoryForClient(std::vector<u8>& data, u32 max_length) {
+    VAddr address;
+    u32 length;
+    ParseMemoryArguments(address, length);
 
     LOG_DEBUG(Debug_GDBStub, "gdb: address: {:08x} len: {:08x}\n", address, length);
 
-    if (length * 2 > sizeof(reply)) {
+    if (length > max_length) {
         SendReply("E01");
+        return false;
     }
 
     Core::System& system = Core::System::GetInstance();
-    Kernel::KernelSystem& kernel = system.Kernel();
+    Kernel::Process& current_process = *system.Kernel().GetCurrentProcess();
 
-    if (!Memory::IsValidVirtualAddress(*kernel.GetCurrentProcess(), address)) {
-        return SendReply("E00");
+    if (length != 0 && !Memory::IsValidVirtualAddress(current_process, address)) {
+        SendReply("E00");
+        return false;
     }
 
-    std::vector<u8> data(length);
-    system.Memory().ReadBlock(*kernel.GetCurrentProcess(), address, data.data(), length);
+    data.resize(length);
+    system.Memory().ReadBlock(current_process, address, data.data(), length);
+    HideBreakpoints(address, data.data(), length);
+    return true;
+}
 
-    MemToGdbHex(reply, data.data(), length);
-    reply[length * 2] = '\0';
-    SendReply(reinterpret_cast<char*>(reply));
+/// Read location in memory specified by gdb client.
+static void ReadMemory() {
+    static std::vector<u8> data;
+    if (!ReadMemoryForClient(data, MAX_PACKET_SIZE / 2)) {
+        return;
+    }
+
+    static std::string reply;
+    reply.resize(data.size() * 2);
+    MemToGdbHex(reinterpret_cast<u8*>(reply.data()), data.data(), data.size());
+    SendReply(reply);
 }
 
-/// Modify location in memory with data received from the gdb client.
-static void WriteMemory() {
-    auto start_offset = command_buffer + 1;
-    auto address_position = std::find(start_offset, command_buffer + command_length, ',');
-    VAddr address = HexToInt(start_offset, static_cast<u32>(address_position - start_offset));
+/// Read location in memory specified by gdb client, replying with binary data.
+static void ReadMemoryBinary() {
+    static std::vector<u8> data;
+    // Every byte may need to be escaped
+    if (!ReadMemoryForClient(data, MAX_PACKET_SIZE / 2 - 1)) {
+        return;
+    }
 
-    start_offset = address_position + 1;
-    auto length_position = std::find(start_offset, command_buffer + command_length, ':');
-    u32 length = HexToInt(start_offset, static_cast<u32>(length_position - start_offset));
+    static std::string reply;
+    reply.assign(1, 'b');
+    AppendBinary(reply, data.data(), data.size());
+    SendReply(reply);
+}
 
+/**
+ * Write data received from the gdb client to memory.
+ *
+ * @param address Address to write to.
+ * @param data Data to write.
+ */
+static void WriteMemoryForClient(VAddr address, const std::vector<u8>& data) {
     Core::System& system = Core::System::GetInstance();
     Kernel::Process& current_process = *system.Kernel().GetCurrentProcess();
 
-    if (!Memory::IsValidVirtualAddress(*system.Kernel().GetCurrentProcess(), address)) {
+    if (!Memory::IsValidVirtualAddress(current_process, address)) {
         return SendReply("E00");
     }
 
-    std::vector<u8> data(length);
-
-    GdbHexToMem(data.data(), length_position + 1, length);
-    system.Memory().WriteBlock(current_process, address, data.data(), length);
-    system.GetRunningCore().ClearInstructionCache();
+    system.Memory().WriteBlock(current_process, address, data.data(), data.size());
+    u32 num_cores = system.GetNumCores();
+    for (u32 i = 0; i < num_cores; ++i) {
+        system.GetCore(i).InvalidateCacheRange(address, data.size());
+    }
     SendReply("OK");
 }
 
+/// Modify location in memory with data received from the gdb client.
+static void WriteMemory() {
+    VAddr address;
+    u32 length;
+    const u8* data_position = ParseMemoryArguments(address, length);
+
+    const u8* end = command_buffer + command_length;
+    if (data_position == end || static_cast<u32>(end - data_position - 1) < length * 2) {
+        return SendReply("E01");
+    }
+
+    static std::vector<u8> data;
+    data.resize(length);
+    GdbHexToMem(data.data(), data_position + 1, length);
+    WriteMemoryForClient(address, data);
+}
+
+/// Modify location in memory with binary data received from the gdb client.
+static void WriteMemoryBinary() {
+    VAddr address;
+    u32 length;
+    const u8* data_position = ParseMemoryArguments(address, length);
+
+    const u8* end = command_buffer + command_length;
+    if (data_position == end) {
+        return SendReply("E01");
+    }
+
+    // gdb probes for support with an empty write
+    if (length == 0) {
+        return SendReply("OK");
+    }
+
+    static std::vector<u8> data;
+    data.clear();
+    for (const u8* c = data_position + 1; c < end; ++c) {
+        if (*c == '}' && c + 1 < end) {
+            data.push_back(*++c ^ 0x20);
+        } else {
+            data.push_back(*c);
+        }
+    }
+
+    if (data.size() != length) {
+        return SendReply("E01");
+    }
+
+    WriteMemoryForClient(address, data);
+}
+
 void Break(bool is_memory_break) {
     send_trap = true;
 
@@ -952,10 +1210,20 @@ static bool CommitBreakpoint(BreakpointType type, VAddr address, u32 length) {
     memory.ReadBlock(current_process, address, breakpoint.instruction.data(),
                      breakpoint.instruction.size());
 
+    // BKPT in ARM and Thumb state, executing it raises a breakpoint exception in the JIT
     static constexpr std::array<u8, 4> btrap{0x70, 0x00, 0x20, 0xe1};
+    static constexpr std::array<u8, 2> thumb_btrap{0x00, 0xbe};
     if (type == BreakpointType::Execute) {
-        memory.WriteBlock(current_process, address, btrap.data(), btrap.size());
-        system.GetRunningCore().ClearInstructionCache();
+        const u32 trap_size = GetTrapSize(breakpoint);
+        memory.WriteBlock(current_process, address,
+                          trap_size == 2 ? thumb_btrap.data() : btrap.data(), trap_size);
+        u32 num_cores = system.GetNumCores();
+        for (u32 i = 0; i < num_cores; ++i) {
+            system.GetCore(i).InvalidateCacheRange(address, trap_size);
+        }
+    } else {
+        u32& longest_length = GetLongestBreakpointLength(type);
+        longest_length = std::max(longest_length, length);
     }
     p.insert({address, breakpoint});
 
@@ -1053,18 +1321,8 @@ static void RemoveBreakpoint() {
     SendReply("OK");
 }
 
-void HandlePacket() {
-    if (!IsConnected()) {
-        if (defer_start) {
-            ToggleServer(true);
-        }
-        return;
-    }
-
-    if (!IsDataAvailable()) {
-        return;
-    }
-
+/// Read and handle a single packet from gdb client.
+static void HandleCommand() {
     ReadCommand();
     if (command_length == 0) {
         return;
@@ -1101,9 +1359,15 @@ void HandlePacket() {
     case 'm':
         ReadMemory();
         break;
+    case 'x':
+        ReadMemoryBinary();
+        break;
     case 'M':
         WriteMemory();
         break;
+    case 'X':
+        WriteMemoryBinary();
+        break;
     case 's':
         Step();
         return;
@@ -1126,6 +1390,23 @@ void HandlePacket() {
     }
 }
 
+void HandlePacket() {
+    if (!IsConnected()) {
+        if (defer_start) {
+            ToggleServer(true);
+        }
+        return;
+    }
+
+    // Handle every packet that already arrived, scripted clients send many of them at once
+    while (IsDataAvailable()) {
+        HandleCommand();
+        if (!halt_loop || step_loop || !IsConnected()) {
+            return;
+        }
+    }
+}
+
 void SetServerPort(u16 port) {
     gdbstub_port = port;
 }
@@ -1168,6 +1449,8 @@ static void Init(u16 port) {
     breakpoints_execute.clear();
     breakpoints_read.clear();
     breakpoints_write.clear();
+    longest_breakpoint_read = 0;
+    longest_breakpoint_write = 0;
 
     // Start gdb server
     LOG_INFO(Debug_GDBStub, "Starting GDB server on port {}...", port);
@@ -1243,6 +1526,8 @@ void Shutdown() {
         shutdown(gdbserver_socket, SHUT_RDWR);
         gdbserver_socket = -1;
     }
+    receive_position = 0;
+    receive_size = 0;
 
 #ifdef _WIN32
     WSACleanup();
@@ -1283,4 +1568,70 @@ void SendTrap(Kernel::Thread* thread, int trap) {
     send_trap = false;
 }
 
+#ifdef HAVE_BENCHMARKS
+MemoryTransferBenchmarkResult BenchmarkMemoryTransfer(u32 size, u32 breakpoint_count) {
+    MemoryTransferBenchmarkResult result;
+    result.bytes = size;
+
+    std::mt19937 random(0);
+    std::vector<u8> memory(size);
+    std::generate(memory.begin(), memory.end(), [&random] { return static_cast<u8>(random()); });
+
+    std::string reply;
+    std::string packet;
+    const auto build_replies = [&](u32 chunk_size, u64& packets, auto build_reply) {
+        const auto start = std::chrono::steady_clock::now();
+        for (u32 offset = 0; offset < size; offset += chunk_size) {
+            build_reply(memory.data() + offset, std::min(chunk_size, size - offset));
+            BuildPacket(packet, reply);
+            ++packets;
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Before, PacketSize was 0x2000 and memory was converted one nibble at a time
+    result.nibble_seconds = build_replies(0x1000, result.nibble_packets,
+                                          [&reply](const u8* data, u32 length) {
+                                              reply.resize(length * 2);
+                                              for (u32 i = 0; i < length; ++i) {
+                                                  reply[i * 2] = NibbleToHex(data[i] >> 4);
+                                                  reply[i * 2 + 1] = NibbleToHex(data[i]);
+                                              }
+                                          });
+    result.hex_seconds = build_replies(MAX_PACKET_SIZE / 2, result.hex_packets,
+                                       [&reply](const u8* data, u32 length) {
+                                           reply.resize(length * 2);
+                                           MemToGdbHex(reinterpret_cast<u8*>(reply.data()), data,
+                                                       length);
+                                       });
+    result.binary_seconds = build_replies(MAX_PACKET_SIZE / 2 - 1, result.binary_packets,
+                                          [&reply](const u8* data, u32 length) {
+                                              reply.assign(1, 'b');
+                                              AppendBinary(reply, data, length);
+                                          });
+
+    // Cover the memory with read breakpoints that each have a 4 byte one in their middle, so
+    // the closest breakpoint below a word often isn't the one covering it, and check every word
+    // like the callbacks do for every access while read breakpoints are set
+    BreakpointMap breakpoints;
+    const u32 breakpoint_length = std::max<u32>(size / std::max<u32>(breakpoint_count, 1), 8);
+    for (VAddr address = 0; address < size; address += breakpoint_length) {
+        breakpoints.insert({address, Breakpoint{true, address, breakpoint_length, {}}});
+        const VAddr middle = address + breakpoint_length / 2;
+        breakpoints.insert({middle, Breakpoint{true, middle, 4, {}}});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (VAddr address = 0; address < size; address += 4) {
+        result.breakpoint_hits +=
+            FindBreakpoint(breakpoints, address, BreakpointType::Read, breakpoint_length);
+        ++result.breakpoint_checks;
+    }
+    result.breakpoint_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+#endif
+
 } // namespace GDBStub
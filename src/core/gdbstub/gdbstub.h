@@ -87,6 +87,9 @@ BreakpointAddress GetNextBreakpointFromAddress(VAddr addr, GDBStub::BreakpointTy
  */
 bool CheckBreakpoint(VAddr addr, GDBStub::BreakpointType type);
 
+/// Returns true if the client set any read or write breakpoints.
+bool HasMemoryBreakpoints();
+
 // If set to true, the CPU will halt at the beginning of the next CPU loop.
 bool GetCpuHaltFlag();
 
@@ -107,4 +110,27 @@ void SetCpuStepFlag(bool is_step);
  * @param trap Trap no.
  */
 void SendTrap(Kernel::Thread* thread, int trap);
+
+#ifdef HAVE_BENCHMARKS
+struct MemoryTransferBenchmarkResult {
+    u32 bytes = 0;                   ///< Bytes of memory read
+    double nibble_seconds = 0.0;     ///< Time the m replies took with the old conversion
+    u64 nibble_packets = 0;          ///< m replies needed with the old PacketSize
+    double hex_seconds = 0.0;        ///< Time the m replies took
+    u64 hex_packets = 0;             ///< m replies needed
+    double binary_seconds = 0.0;     ///< Time the x replies took
+    u64 binary_packets = 0;          ///< x replies needed
+    u64 breakpoint_checks = 0;       ///< Words checked for read breakpoints
+    u64 breakpoint_hits = 0;         ///< Words a read breakpoint covered, should be all of them
+    double breakpoint_seconds = 0.0; ///< Time the breakpoint checks took
+};
+
+/**
+ * Builds the reply packets a client reading the given amount of memory gets, without a
+ * connection or an emulated system, with m packets converted the old and the new way and with x
+ * packets, and measures how fast it goes. Then checks every word of the memory against read
+ * breakpoints, breakpoint_count of them covering it and as many 4 byte ones between them.
+ */
+MemoryTransferBenchmarkResult BenchmarkMemoryTransfer(u32 size, u32 breakpoint_count);
+#endif
 } // namespace GDBStub
@@ -0,0 +1,432 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/gpu_trace.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/loader/loader.h"
+#include "core/memory.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace Core {
+
+namespace {
+
+constexpr u32 GPU_TRACE_MAGIC = Loader::MakeMagic('V', 'G', 'P', 'T');
+constexpr u32 GPU_TRACE_VERSION = 1;
+
+/// Visits every part of the initial state of a trace except memory, in file order
+template <typename Visitor>
+void VisitState(Visitor&& visit) {
+    Pica::State& pica = Pica::g_state;
+
+    visit(GPU::g_regs);
+    visit(pica.regs);
+    for (Pica::Shader::ShaderSetup* setup : {&pica.vs, &pica.gs}) {
+        visit(setup->uniforms);
+        visit(setup->program_code);
+        visit(setup->swizzle_data);
+        visit(setup->engine_data.entry_point);
+    }
+    visit(pica.input_default_attributes);
+    visit(pica.proctex);
+    visit(pica.lighting);
+    visit(pica.fog);
+    visit(pica.vs_float_regs_counter);
+    visit(pica.vs_uniform_write_buffer);
+    visit(pica.gs_float_regs_counter);
+    visit(pica.gs_uniform_write_buffer);
+    visit(pica.default_attr_counter);
+    visit(pica.default_attr_write_buffer);
+}
+
+u32 GetStateSize() {
+    u32 size = 0;
+    VisitState([&size](auto& object) {
+        static_assert(std::is_trivially_copyable_v<std::remove_reference_t<decltype(object)>>);
+        size += static_cast<u32>(sizeof(object));
+    });
+    return size;
+}
+
+bool IsInFCRAMOrVRAM(PAddr address, u32 size) {
+    const auto contains = [address, size](PAddr base, u32 region_size) {
+        return address >= base && size <= region_size && address - base <= region_size - size;
+    };
+    return contains(Memory::FCRAM_PADDR, Memory::FCRAM_SIZE) ||
+           contains(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+}
+
+} // namespace
+
+GPUTraceRecorder::GPUTraceRecorder() = default;
+
+GPUTraceRecorder::~GPUTraceRecorder() {
+    if (state == State::Recording || state == State::Stopping) {
+        Finish();
+    }
+}
+
+void GPUTraceRecorder::Start(const std::string& path, u32 frame_count) {
+    std::lock_guard lock(mutex);
+    if (state != State::Idle) {
+        LOG_ERROR(Core, "Already recording a GPU trace");
+        return;
+    }
+
+    requested_path = path;
+    requested_frame_count = frame_count;
+    state = State::Starting;
+}
+
+void GPUTraceRecorder::Stop() {
+    std::lock_guard lock(mutex);
+    State expected = State::Recording;
+    if (!state.compare_exchange_strong(expected, State::Stopping) &&
+        expected == State::Starting) {
+        state = State::Idle;
+    }
+}
+
+void GPUTraceRecorder::RecordFrameEnd() {
+    switch (state) {
+    case State::Idle:
+        return;
+    case State::Starting: {
+        {
+            std::lock_guard lock(mutex);
+            path = requested_path;
+            frame_count = requested_frame_count;
+        }
+        state = Begin() ? State::Recording : State::Idle;
+        return;
+    }
+    case State::Recording:
+    case State::Stopping:
+        AddMemoryUpdates();
+        AddEntry(GPUTraceEntry::Type::FrameEnd, 0, 0);
+        ++frames_recorded;
+        if (state == State::Stopping || frames_recorded == frame_count) {
+            Finish();
+        }
+        return;
+    }
+}
+
+bool GPUTraceRecorder::Begin() {
+    if (!file.Open(path, "wb")) {
+        LOG_ERROR(Core, "Failed to open GPU trace file {}", path);
+        return false;
+    }
+
+    // The frame count and entry count are filled in by Finish
+    GPUTraceHeader header{};
+    header.magic = GPU_TRACE_MAGIC;
+    header.version = GPU_TRACE_VERSION;
+    header.state_size = GetStateSize();
+    file.WriteObject(header);
+    VisitState([this](auto& object) { file.WriteObject(object); });
+
+    // Surfaces only the renderer has seen yet are part of the initial state too
+    VideoCore::g_renderer->Rasterizer()->FlushAll();
+
+    Memory::MemorySystem& memory = System::GetInstance().Memory();
+    const u8* fcram = memory.GetFCRAMPointer(0);
+    const u8* vram = memory.GetPhysicalPointer(Memory::VRAM_PADDR);
+    file.WriteBytes(fcram, Memory::FCRAM_SIZE);
+    file.WriteBytes(vram, Memory::VRAM_SIZE);
+    if (!file.IsGood()) {
+        LOG_ERROR(Core, "Failed to write GPU trace file {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+        return false;
+    }
+
+    memory.SetDirtyTracking(true);
+
+    frames_recorded = 0;
+    entry_count = 0;
+
+    LOG_INFO(Core, "Started recording GPU trace {}", path);
+    return true;
+}
+
+void GPUTraceRecorder::Finish() {
+    GPUTraceHeader header{};
+    header.magic = GPU_TRACE_MAGIC;
+    header.version = GPU_TRACE_VERSION;
+    header.state_size = GetStateSize();
+    header.frame_count = frames_recorded;
+    header.entry_count = entry_count;
+    file.Seek(0, SEEK_SET);
+    file.WriteObject(header);
+
+    const bool good = file.IsGood();
+    file.Close();
+    System::GetInstance().Memory().SetDirtyTracking(false);
+    state = State::Idle;
+
+    if (good) {
+        LOG_INFO(Core, "Recorded GPU trace {} ({} frames, {} entries)", path, frames_recorded,
+                 entry_count);
+    } else {
+        LOG_ERROR(Core, "Failed to write GPU trace file {}", path);
+        FileUtil::Delete(path);
+    }
+}
+
+void GPUTraceRecorder::AddRegisterWrite(u32 index, u32 value) {
+    // These make the GPU read memory
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+    case GPU_REG_INDEX(memory_fill_config[1].trigger):
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+    case GPU_REG_INDEX(command_processor_config.trigger):
+        AddMemoryUpdates();
+        break;
+    default:
+        break;
+    }
+
+    AddEntry(GPUTraceEntry::Type::RegisterWrite, index, value);
+}
+
+void GPUTraceRecorder::AddEntry(GPUTraceEntry::Type type, u32 data, u32 value) {
+    GPUTraceEntry entry;
+    entry.type = type;
+    entry.data = data;
+    entry.value = value;
+    file.WriteObject(entry);
+    ++entry_count;
+}
+
+void GPUTraceRecorder::AddMemoryUpdates() {
+    Memory::MemorySystem& memory = System::GetInstance().Memory();
+
+    for (const auto& [address, size] : memory.TakeDirtyRegions()) {
+        // Parts of the pages the CPU didn't write may only be up to date in the renderer
+        VideoCore::g_renderer->Rasterizer()->FlushRegion(address, size);
+
+        AddEntry(GPUTraceEntry::Type::MemoryUpdate, address, size);
+        file.WriteBytes(memory.GetPhysicalPointer(address), size);
+    }
+}
+
+GPUTracePlayer::GPUTracePlayer() = default;
+
+GPUTracePlayer::~GPUTracePlayer() = default;
+
+bool GPUTracePlayer::Load(const std::string& path) {
+    entries.clear();
+
+    if (!file.Open(path)) {
+        LOG_ERROR(Core, "Failed to open GPU trace file {}", path);
+        return false;
+    }
+
+    const u8* position = file.GetData();
+    const u8* const end = position + file.GetSize();
+
+    GPUTraceHeader header;
+    if (file.GetSize() < sizeof(header)) {
+        LOG_ERROR(Core, "GPU trace file {} is corrupted", path);
+        return false;
+    }
+    std::memcpy(&header, position, sizeof(header));
+    position += sizeof(header);
+
+    if (header.magic != GPU_TRACE_MAGIC) {
+        LOG_ERROR(Core, "{} isn't a GPU trace file", path);
+        return false;
+    }
+    if (header.version != GPU_TRACE_VERSION || header.state_size != GetStateSize()) {
+        LOG_ERROR(Core, "GPU trace file {} was recorded by a different version", path);
+        return false;
+    }
+    if (static_cast<std::size_t>(end - position) <
+        static_cast<std::size_t>(header.state_size) + Memory::FCRAM_SIZE + Memory::VRAM_SIZE) {
+        LOG_ERROR(Core, "GPU trace file {} is corrupted", path);
+        return false;
+    }
+
+    state = position;
+    fcram = state + header.state_size;
+    vram = fcram + Memory::FCRAM_SIZE;
+    position = vram + Memory::VRAM_SIZE;
+
+    entries.reserve(static_cast<std::size_t>(
+        std::min<u64>(header.entry_count, (end - position) / sizeof(GPUTraceEntry))));
+    for (u64 i = 0; i < header.entry_count; ++i) {
+        GPUTraceEntry entry;
+        if (static_cast<std::size_t>(end - position) < sizeof(entry)) {
+            LOG_ERROR(Core, "GPU trace file {} is corrupted", path);
+            return false;
+        }
+        std::memcpy(&entry, position, sizeof(entry));
+        position += sizeof(entry);
+
+        const GPUTraceEntry::Type type = entry.type;
+        const u32 data = entry.data;
+        const u32 value = entry.value;
+        const u8* contents = nullptr;
+        switch (type) {
+        case GPUTraceEntry::Type::RegisterWrite:
+            if (data >= GPU::Regs::NumIds()) {
+                LOG_ERROR(Core, "GPU trace file {} is corrupted", path);
+                return false;
+            }
+            break;
+        case GPUTraceEntry::Type::MemoryUpdate:
+            if (!IsInFCRAMOrVRAM(data, value) || static_cast<std::size_t>(end - position) < value) {
+                LOG_ERROR(Core, "GPU trace file {} is corrupted", path);
+                return false;
+            }
+            contents = position;
+            position += value;
+            break;
+        case GPUTraceEntry::Type::FrameEnd:
+            break;
+        default:
+            LOG_ERROR(Core, "GPU trace file {} is corrupted", path);
+            return false;
+        }
+
+        entries.push_back(Entry{type, data, value, contents});
+    }
+
+    frame_count = header.frame_count;
+    return true;
+}
+
+GPUTracePlayer::Report GPUTracePlayer::Replay(u32 repeat_count) {
+    using Clock = std::chrono::steady_clock;
+
+    // Samples of every frame and draw, one per repetition
+    std::vector<std::vector<std::chrono::nanoseconds>> frame_samples(frame_count);
+    std::vector<std::vector<std::chrono::nanoseconds>> draw_samples;
+    std::vector<u32> draw_frames;
+
+    Report report;
+
+    // Nothing is waiting for the interrupts of replayed register writes
+    GPU::g_signal_interrupts = false;
+
+    for (u32 repetition = 0; repetition < repeat_count; ++repetition) {
+        RestoreState();
+
+        u32 frame = 0;
+        std::size_t draw = 0;
+        Clock::time_point frame_start = Clock::now();
+        Clock::time_point draw_start = frame_start;
+
+        VideoCore::g_draw_callback = [&] {
+            const Clock::time_point now = Clock::now();
+            if (draw == draw_samples.size()) {
+                draw_samples.emplace_back();
+                draw_frames.push_back(frame);
+            }
+            draw_samples[draw++].push_back(now - draw_start);
+            draw_start = now;
+        };
+
+        for (const Entry& entry : entries) {
+            switch (entry.type) {
+            case GPUTraceEntry::Type::RegisterWrite:
+                if (entry.data == GPU_REG_INDEX(command_processor_config.trigger) &&
+                    (entry.value & 1) != 0) {
+                    const Clock::time_point start = Clock::now();
+                    GPU::Write<u32>(HW::VADDR_GPU + entry.data * sizeof(u32), entry.value);
+                    report.command_list_time += Clock::now() - start;
+                    report.command_list_words += GPU::g_regs.command_processor_config.size / 4;
+                    ++report.command_lists;
+                } else {
+                    GPU::Write<u32>(HW::VADDR_GPU + entry.data * sizeof(u32), entry.value);
+                }
+                break;
+            case GPUTraceEntry::Type::MemoryUpdate:
+                WriteMemory(entry.data, entry.contents, entry.value);
+                break;
+            case GPUTraceEntry::Type::FrameEnd: {
+                VideoCore::g_renderer->SwapBuffers();
+                const Clock::time_point now = Clock::now();
+                if (frame < frame_count) {
+                    frame_samples[frame].push_back(now - frame_start);
+                }
+                ++frame;
+                frame_start = draw_start = now;
+                break;
+            }
+            }
+        }
+
+        VideoCore::g_draw_callback = nullptr;
+    }
+
+    GPU::g_signal_interrupts = true;
+
+    const auto summarize = [](std::vector<std::chrono::nanoseconds>& samples) {
+        Timing timing;
+        if (!samples.empty()) {
+            std::sort(samples.begin(), samples.end());
+            timing.min = samples.front();
+            timing.median = samples[samples.size() / 2];
+            timing.max = samples.back();
+        }
+        return timing;
+    };
+
+    report.frames.reserve(frame_samples.size());
+    for (auto& samples : frame_samples) {
+        report.frames.push_back(summarize(samples));
+    }
+    report.draws.reserve(draw_samples.size());
+    for (std::size_t i = 0; i < draw_samples.size(); ++i) {
+        report.draws.push_back(DrawTiming{draw_frames[i], summarize(draw_samples[i])});
+    }
+    return report;
+}
+
+void GPUTracePlayer::RestoreState() {
+    const u8* position = state;
+    VisitState([&position](auto& object) {
+        std::memcpy(&object, position, sizeof(object));
+        position += sizeof(object);
+    });
+
+    Pica::State& pica = Pica::g_state;
+    pica.vs.MarkProgramCodeDirty();
+    pica.vs.MarkSwizzleDataDirty();
+    pica.gs.MarkProgramCodeDirty();
+    pica.gs.MarkSwizzleDataDirty();
+    pica.immediate = {};
+    pica.primitive_assembler.Reconfigure(pica.regs.pipeline.triangle_topology);
+
+    VideoCore::RasterizerInterface& rasterizer = *VideoCore::g_renderer->Rasterizer();
+    for (u32 id = 0; id < Pica::Regs::NUM_REGS; ++id) {
+        rasterizer.NotifyPicaRegisterChanged(id);
+    }
+
+    // Everything is overwritten, so nothing needs to be flushed
+    Memory::MemorySystem& memory = System::GetInstance().Memory();
+    rasterizer.InvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_SIZE);
+    rasterizer.InvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    std::memcpy(memory.GetFCRAMPointer(0), fcram, Memory::FCRAM_SIZE);
+    std::memcpy(memory.GetPhysicalPointer(Memory::VRAM_PADDR), vram, Memory::VRAM_SIZE);
+}
+
+void GPUTracePlayer::WriteMemory(PAddr address, const u8* data, u32 size) {
+    // Same as a CPU write to memory the renderer may have cached
+    VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(address, size);
+    std::memcpy(System::GetInstance().Memory().GetPhysicalPointer(address), data, size);
+}
+
+} // namespace Core
@@ -0,0 +1,186 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/swap.h"
+
+namespace Core {
+
+/**
+ * GPU traces capture everything the GPU consumes over a number of frames, so that the frames can
+ * be re-executed through the renderer without emulating the CPU.
+ *
+ * A trace file starts with a GPUTraceHeader, followed by the initial state (GPU registers, the
+ * Pica state that isn't visible through registers, FCRAM and VRAM) and a list of entries. Every
+ * entry starts with a GPUTraceEntry:
+ * - RegisterWrite: a GPU register write, data is the register index and value is the value
+ * - MemoryUpdate: data is a physical address, value is a size in bytes, the new contents follow
+ * - FrameEnd: a VBlank, the renderer presents the frame
+ *
+ * Memory updates are the FCRAM and VRAM pages the memory system tracked as dirty, written before
+ * every write that makes the GPU read memory, and before every VBlank.
+ */
+struct GPUTraceHeader {
+    u32_le magic;
+    u32_le version;
+    u32_le state_size; ///< Size of the state before FCRAM and VRAM, to reject other builds
+    u32_le frame_count;
+    u64_le entry_count;
+};
+static_assert(sizeof(GPUTraceHeader) == 0x18, "GPUTraceHeader has incorrect size");
+
+struct GPUTraceEntry {
+    enum class Type : u32 {
+        RegisterWrite,
+        MemoryUpdate,
+        FrameEnd,
+    };
+
+    enum_le<Type> type;
+    u32_le data;
+    u32_le value;
+};
+static_assert(sizeof(GPUTraceEntry) == 0xC, "GPUTraceEntry has incorrect size");
+
+/// Records GPU traces, driven by the emulation thread through GPU register writes and VBlanks
+class GPUTraceRecorder {
+public:
+    GPUTraceRecorder();
+    ~GPUTraceRecorder();
+
+    /**
+     * Starts recording at the next VBlank, so that traces always contain whole frames.
+     * @param path the trace file to write
+     * @param frame_count stop after this many frames, 0 to record until Stop is called
+     */
+    void Start(const std::string& path, u32 frame_count);
+
+    /// Stops recording at the next VBlank
+    void Stop();
+
+    /// Returns true while recording or waiting for the next VBlank to start or stop
+    bool IsRecording() const {
+        return state != State::Idle;
+    }
+
+    /// Called on every GPU register write, before the write takes effect
+    void RecordRegisterWrite(u32 index, u32 value) {
+        if (state == State::Recording) {
+            AddRegisterWrite(index, value);
+        }
+    }
+
+    /// Called on every VBlank, before the renderer presents the frame
+    void RecordFrameEnd();
+
+private:
+    enum class State {
+        Idle,
+        Starting,
+        Recording,
+        Stopping,
+    };
+
+    bool Begin();
+    void Finish();
+    void AddRegisterWrite(u32 index, u32 value);
+    void AddEntry(GPUTraceEntry::Type type, u32 data, u32 value);
+
+    /// Writes memory updates for every page that was written since the last call
+    void AddMemoryUpdates();
+
+    std::atomic<State> state{State::Idle};
+
+    // Set by Start and Stop, which may be called from any thread
+    std::mutex mutex;
+    std::string requested_path;
+    u32 requested_frame_count = 0;
+
+    // Only touched on the emulation thread
+    FileUtil::IOFile file;
+    std::string path;
+    u32 frame_count = 0;
+    u32 frames_recorded = 0;
+    u64 entry_count = 0;
+};
+
+/**
+ * Replays GPU traces through the current renderer and measures the host time spent on every frame
+ * and every draw. The emulated system must be initialized, but no application is needed.
+ *
+ * Draw times are measured from the end of the previous draw (or frame), so they include the
+ * register writes that set the draw up. A draw is a draw the rasterizer issued, software processed
+ * triangles are timed when their batch is drawn, which can merge several PICA draws. Both are CPU
+ * times, the renderer may still be busy when a draw or frame is considered done.
+ */
+class GPUTracePlayer {
+public:
+    struct Timing {
+        std::chrono::nanoseconds min{};
+        std::chrono::nanoseconds median{};
+        std::chrono::nanoseconds max{};
+    };
+
+    struct DrawTiming {
+        u32 frame; ///< Index of the frame the draw belongs to
+        Timing timing;
+    };
+
+    struct Report {
+        std::vector<Timing> frames;
+        std::vector<DrawTiming> draws;
+
+        // Command list throughput over all repetitions. The time includes the draws the lists
+        // trigger, the words are the ones submitted, not counting the ones of jumped to buffers.
+        u64 command_lists = 0;
+        u64 command_list_words = 0;
+        std::chrono::nanoseconds command_list_time{};
+    };
+
+    GPUTracePlayer();
+    ~GPUTracePlayer();
+
+    /// Opens and validates a trace file, returns true on success
+    bool Load(const std::string& path);
+
+    u32 GetFrameCount() const {
+        return frame_count;
+    }
+
+    /**
+     * Replays the trace, restoring the initial state before every repetition.
+     * @param repeat_count how many times to replay the trace
+     * @returns the timings of every frame and draw, and the command list throughput, over all
+     * repetitions
+     */
+    Report Replay(u32 repeat_count);
+
+private:
+    struct Entry {
+        GPUTraceEntry::Type type;
+        u32 data;
+        u32 value;
+        const u8* contents; ///< New memory contents for memory updates
+    };
+
+    void RestoreState();
+    void WriteMemory(PAddr address, const u8* data, u32 size);
+
+    FileUtil::MappedFile file;
+    const u8* state = nullptr;
+    const u8* fcram = nullptr;
+    const u8* vram = nullptr;
+    std::vector<Entry> entries;
+    u32 frame_count = 0;
+};
+
+} // namespace Core
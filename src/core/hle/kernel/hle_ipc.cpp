@@ -22,11 +22,13 @@ SessionRequestHandler::SessionInfo::SessionInfo(std::shared_ptr<ServerSession> s
 
 void SessionRequestHandler::ClientConnected(std::shared_ptr<ServerSession> server_session) {
     server_session->SetHleHandler(shared_from_this());
-    connected_sessions.emplace_back(std::move(server_session), MakeSessionData());
+    auto& info = connected_sessions.emplace_back(std::move(server_session), MakeSessionData());
+    info.session->hle_session_data = info.data.get();
 }
 
 void SessionRequestHandler::ClientDisconnected(std::shared_ptr<ServerSession> server_session) {
     server_session->SetHleHandler(nullptr);
+    server_session->hle_session_data = nullptr;
 
     connected_sessions.erase(
         std::remove_if(connected_sessions.begin(), connected_sessions.end(),
@@ -289,4 +291,22 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+ResultVal<std::vector<std::pair<u8*, u32>>> MappedBuffer::GetBackingBlocks(std::size_t offset,
+                                                                           std::size_t size,
+                                                                           bool write) {
+    ASSERT(perms & (write ? IPC::W : IPC::R));
+    ASSERT(offset + size <= this->size);
+    const VAddr start = address + static_cast<VAddr>(offset);
+    CASCADE_RESULT(auto backing_blocks,
+                   process->vm_manager.GetBackingBlocksForRange(start, static_cast<u32>(size)));
+    Memory::RasterizerFlushVirtualRegion(start, static_cast<u32>(size), Memory::FlushMode::Flush);
+    return MakeResult(std::move(backing_blocks));
+}
+
+void MappedBuffer::InvalidateRasterizerCache(std::size_t offset, std::size_t size) {
+    ASSERT(offset + size <= this->size);
+    Memory::RasterizerFlushVirtualRegion(address + static_cast<VAddr>(offset),
+                                         static_cast<u32>(size), Memory::FlushMode::Invalidate);
+}
+
 } // namespace Kernel
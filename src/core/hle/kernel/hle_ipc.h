@@ -16,6 +16,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/result.h"
 
 namespace Service {
 class ServiceFrameworkBase;
@@ -34,6 +35,12 @@ class Event;
 class HLERequestContext;
 class KernelSystem;
 
+/// Empty placeholder structure for services with no per-session data. The session data classes
+/// in each service must inherit from this.
+struct SessionDataBase {
+    virtual ~SessionDataBase() = default;
+};
+
 /**
  * Interface implemented by HLE Session handlers.
  * This can be provided to a ServerSession in order to hook into several relevant events
@@ -64,11 +71,7 @@ public:
      */
     virtual void ClientDisconnected(std::shared_ptr<ServerSession> server_session);
 
-    /// Empty placeholder structure for services with no per-session data. The session data classes
-    /// in each service must inherit from this.
-    struct SessionDataBase {
-        virtual ~SessionDataBase() = default;
-    };
+    using SessionDataBase = Kernel::SessionDataBase;
 
 protected:
     /// Creates the storage for the session data of the service.
@@ -76,13 +79,13 @@ protected:
 
     /// Returns the session data associated with the server session.
     template <typename T>
-    T* GetSessionData(std::shared_ptr<ServerSession> session) {
+    T* GetSessionData(const std::shared_ptr<ServerSession>& session) {
         static_assert(std::is_base_of<SessionDataBase, T>(),
                       "T is not a subclass of SessionDataBase");
-        auto itr = std::find_if(connected_sessions.begin(), connected_sessions.end(),
-                                [&](const SessionInfo& info) { return info.session == session; });
-        ASSERT(itr != connected_sessions.end());
-        return static_cast<T*>(itr->data.get());
+        // The session keeps a pointer to its data, so this doesn't need to search
+        // connected_sessions
+        ASSERT(session->hle_handler.get() == this && session->hle_session_data != nullptr);
+        return static_cast<T*>(session->hle_session_data);
     }
 
     struct SessionInfo {
@@ -104,6 +107,20 @@ public:
     // interface for service
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
+
+    /**
+     * Gets the host memory backing part of the buffer, so that services can access it without an
+     * intermediate copy. Cached GPU surfaces overlapping the range are written back first. If the
+     * host memory is written, call InvalidateRasterizerCache once the writes are done.
+     * @param write whether the host memory is going to be written
+     * @returns the contiguous host memory blocks covering the range, in order
+     */
+    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocks(std::size_t offset,
+                                                                 std::size_t size, bool write);
+
+    /// Drops cached GPU surfaces overlapping part of the buffer after its host memory was written
+    void InvalidateRasterizerCache(std::size_t offset, std::size_t size);
+
     std::size_t GetSize() const {
         return size;
     }
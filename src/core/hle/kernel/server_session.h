@@ -21,6 +21,7 @@ class ClientPort;
 class ServerSession;
 class Session;
 class SessionRequestHandler;
+struct SessionDataBase;
 class Thread;
 
 /**
@@ -77,6 +78,9 @@ public:
     std::shared_ptr<SessionRequestHandler>
         hle_handler; ///< This session's HLE request handler (optional)
 
+    /// Per-session data of the HLE handler, owned by the handler while the session is connected
+    SessionDataBase* hle_session_data = nullptr;
+
     /// List of threads that are pending a response after a sync request. This list is processed in
     /// a LIFO manner, thus, the last request will be dispatched first.
     /// TODO(Subv): Verify if this is indeed processed in LIFO using a hardware test.
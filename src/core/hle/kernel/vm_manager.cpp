@@ -359,7 +359,7 @@ void VMManager::UpdatePageTableForVMA(const VirtualMemoryArea& vma) {
 }
 
 ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(VAddr address,
-                                                                                u32 size) {
+                                                                                u32 size) const {
     std::vector<std::pair<u8*, u32>> backing_blocks;
     VAddr interval_target = address;
     while (interval_target != address + size) {
@@ -181,7 +181,8 @@ public:
     void LogLayout(Log::Level log_level) const;
 
     /// Gets a list of backing memory blocks for the specified range
-    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocksForRange(VAddr address, u32 size);
+    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocksForRange(VAddr address,
+                                                                         u32 size) const;
 
     /// Each VMManager has its own page table, which is set as the main one when the owning process
     /// is scheduled.
@@ -14,6 +14,7 @@
 #include "core/hle/result.h"
 #include "core/hle/service/fs/directory.h"
 #include "core/hle/service/fs/file.h"
+#include "core/hle/service/fs/file_io_queue.h"
 
 /// The unique system identifier hash, also known as ID0
 static constexpr char SYSTEM_ID[]{"00000000000000000000000000000000"};
@@ -257,6 +258,11 @@ public:
     /// Registers a new NCCH file with the SelfNCCH archive factory
     void RegisterSelfNCCH(Loader::AppLoader& app_loader);
 
+    /// Gets the queue that runs file reads off the emulation thread
+    FileIOQueue& GetFileIOQueue() {
+        return file_io_queue;
+    }
+
 private:
     Core::System& system;
 
@@ -284,6 +290,8 @@ private:
      */
     std::unordered_map<ArchiveHandle, std::unique_ptr<ArchiveBackend>> handle_map;
     ArchiveHandle next_handle = 1;
+
+    FileIOQueue file_io_queue;
 };
 
 } // namespace Service::FS
@@ -11,10 +11,61 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
+#include "core/hle/service/fs/file_io_queue.h"
 
 namespace Service::FS {
 
+namespace {
+
+/// Reads from a file into host memory blocks in order, stopping at the end of the file
+ResultVal<std::size_t> ReadToBlocks(const FileSys::FileBackend& backend, u64 offset,
+                                    const std::vector<std::pair<u8*, u32>>& blocks) {
+    std::size_t total = 0;
+    for (const auto& [pointer, size] : blocks) {
+        ResultVal<std::size_t> read = backend.Read(offset + total, size, pointer);
+        if (read.Failed()) {
+            return read.Code();
+        }
+        total += *read;
+        if (*read < size) {
+            break;
+        }
+    }
+    return MakeResult(total);
+}
+
+/// Writes to a file straight from the host memory backing a guest buffer, only falling back to a
+/// bounce buffer if the guest buffer isn't backed by host memory
+ResultVal<std::size_t> WriteFromBuffer(FileSys::FileBackend& backend, u64 offset, u32 length,
+                                       bool flush, Kernel::MappedBuffer& buffer) {
+    auto backing_blocks = buffer.GetBackingBlocks(0, length, false);
+    if (backing_blocks.Failed()) {
+        std::vector<u8> data(length);
+        buffer.Read(data.data(), 0, data.size());
+        return backend.Write(offset, data.size(), flush, data.data());
+    }
+
+    const std::size_t count = backing_blocks->size();
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& [pointer, size] = (*backing_blocks)[i];
+        ResultVal<std::size_t> written =
+            backend.Write(offset + total, size, flush && i + 1 == count, pointer);
+        if (written.Failed()) {
+            return written.Code();
+        }
+        total += *written;
+        if (*written < size) {
+            break;
+        }
+    }
+    return MakeResult(total);
+}
+
+} // namespace
+
 File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
            const FileSys::Path& path)
     : ServiceFramework("", 1), path(path), backend(std::move(backend)), system(system) {
@@ -33,6 +84,10 @@ File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend
     RegisterHandlers(functions);
 }
 
+File::~File() {
+    WaitForPendingIO();
+}
+
 void File::Read(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0802, 3, 2);
     u64 offset = rp.Pop<u64>();
@@ -50,33 +105,64 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     // This file session might have a specific offset from where to start reading, apply it.
     offset += file->offset;
 
+    WaitForPendingIO();
+
     if (offset + length > backend->GetSize()) {
         LOG_ERROR(Service_FS,
                   "Reading from out of bounds offset=0x{:x} length=0x{:08X} file_size=0x{:x}",
                   offset, length, backend->GetSize());
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+    // The host read runs on the I/O thread while the guest thread sleeps for the emulated read
+    // delay. Guest memory is read into directly unless it isn't backed by host memory. GPU
+    // surfaces are written back now and invalidated once the read completed, because surfaces
+    // of the range can be created again while the read runs.
+    struct PendingRead {
+        ResultVal<std::size_t> result;
+        std::vector<u8> bounce_buffer;
+    };
+    auto pending = std::make_shared<PendingRead>();
 
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read = backend->Read(offset, data.size(), data.data());
-    if (read.Failed()) {
-        rb.Push(read.Code());
-        rb.Push<u32>(0);
+    auto backing_blocks = buffer.GetBackingBlocks(0, length, true);
+    std::vector<std::pair<u8*, u32>> blocks;
+    if (backing_blocks.Succeeded()) {
+        blocks = std::move(*backing_blocks);
     } else {
-        buffer.Write(data.data(), 0, *read);
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*read));
+        pending->bounce_buffer.resize(length);
+        blocks.emplace_back(pending->bounce_buffer.data(), length);
     }
-    rb.PushMappedBuffer(buffer);
 
-    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
-    ctx.SleepClientThread("file::read", read_timeout_ns,
-                          [](std::shared_ptr<Kernel::Thread> /* thread */,
-                             Kernel::HLERequestContext& /* ctx */,
-                             Kernel::ThreadWakeupReason /* reason */) {
-                              // Nothing to do here
-                          });
+    const std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
+    pending_io = system.ArchiveManager().GetFileIOQueue().Submit(
+        [backend = backend.get(), offset, blocks = std::move(blocks), pending] {
+            pending->result = ReadToBlocks(*backend, offset, blocks);
+        });
+
+    ctx.SleepClientThread(
+        "file::read", read_timeout_ns,
+        [pending, io = pending_io, buffer,
+         length](std::shared_ptr<Kernel::Thread> /* thread */, Kernel::HLERequestContext& ctx,
+                 Kernel::ThreadWakeupReason /* reason */) mutable {
+            // Only blocks if the host is slower than the emulated read
+            io.wait();
+
+            if (pending->bounce_buffer.empty()) {
+                buffer.InvalidateRasterizerCache(0, length);
+            }
+
+            IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+            if (pending->result.Failed()) {
+                rb.Push(pending->result.Code());
+                rb.Push<u32>(0);
+            } else {
+                if (!pending->bounce_buffer.empty()) {
+                    buffer.Write(pending->bounce_buffer.data(), 0, *pending->result);
+                }
+                rb.Push(RESULT_SUCCESS);
+                rb.Push<u32>(static_cast<u32>(*pending->result));
+            }
+            rb.PushMappedBuffer(buffer);
+        });
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -100,9 +186,8 @@ void File::Write(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    std::vector<u8> data(length);
-    buffer.Read(data.data(), 0, data.size());
-    ResultVal<std::size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
+    WaitForPendingIO();
+    ResultVal<std::size_t> written = WriteFromBuffer(*backend, offset, length, flush != 0, buffer);
 
     // Update file size
     file->size = backend->GetSize();
@@ -140,6 +225,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     }
 
     file->size = size;
+    WaitForPendingIO();
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
 }
@@ -151,6 +237,7 @@ void File::Close(Kernel::HLERequestContext& ctx) {
                     connected_sessions.size());
     }
 
+    WaitForPendingIO();
     backend->Close();
 
     IPC::RequestBuilder rb(ctx, 0x0808, 1, 0);
@@ -167,6 +254,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    WaitForPendingIO();
     backend->Flush();
     rb.Push(RESULT_SUCCESS);
 }
@@ -200,6 +288,7 @@ void File::OpenLinkFile(Kernel::HLERequestContext& ctx) {
 
     slot->priority = original_file->priority;
     slot->offset = 0;
+    WaitForPendingIO();
     slot->size = backend->GetSize();
     slot->subfile = false;
 
@@ -257,12 +346,19 @@ std::shared_ptr<Kernel::ClientSession> File::Connect() {
     FileSessionSlot* slot = GetSessionData(std::move(server));
     slot->priority = 0;
     slot->offset = 0;
+    WaitForPendingIO();
     slot->size = backend->GetSize();
     slot->subfile = false;
 
     return client;
 }
 
+void File::WaitForPendingIO() {
+    if (pending_io.valid()) {
+        pending_io.wait();
+    }
+}
+
 std::size_t File::GetSessionFileOffset(std::shared_ptr<Kernel::ServerSession> session) {
     const FileSessionSlot* slot = GetSessionData(std::move(session));
     ASSERT(slot);
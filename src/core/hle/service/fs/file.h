@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/service/service.h"
@@ -27,7 +28,7 @@ class File final : public ServiceFramework<File, FileSessionSlot> {
 public:
     File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
          const FileSys::Path& path);
-    ~File() = default;
+    ~File();
 
     std::string GetName() const {
         return "Path: " + path.DebugStr();
@@ -59,7 +60,14 @@ private:
     void OpenLinkFile(Kernel::HLERequestContext& ctx);
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
+    /// Waits for the backend read that is running on the I/O thread, if any, so that the backend
+    /// can be used on the emulation thread
+    void WaitForPendingIO();
+
     Core::System& system;
+
+    /// Becomes ready once the last read submitted to the I/O thread finished
+    std::shared_future<void> pending_io;
 };
 
 } // namespace Service::FS
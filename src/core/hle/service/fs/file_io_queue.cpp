@@ -0,0 +1,48 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/hle/service/fs/file_io_queue.h"
+
+namespace Service::FS {
+
+FileIOQueue::FileIOQueue() : thread(&FileIOQueue::WorkerThread, this) {}
+
+FileIOQueue::~FileIOQueue() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+std::shared_future<void> FileIOQueue::Submit(std::function<void()> job) {
+    std::packaged_task<void()> task(std::move(job));
+    std::shared_future<void> future = task.get_future().share();
+    {
+        std::lock_guard lock(mutex);
+        jobs.push_back(std::move(task));
+    }
+    cv.notify_one();
+    return future;
+}
+
+void FileIOQueue::WorkerThread() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return stop || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+
+        std::packaged_task<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
+
+} // namespace Service::FS
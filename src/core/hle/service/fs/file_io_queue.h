@@ -0,0 +1,41 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace Service::FS {
+
+/**
+ * Runs file backend reads on a dedicated thread while the requesting guest thread sleeps for the
+ * emulated read delay. Jobs run one at a time in submission order, because backends opened from
+ * the same archive can share a host file handle.
+ */
+class FileIOQueue {
+public:
+    FileIOQueue();
+
+    /// Runs every job that was already submitted before returning
+    ~FileIOQueue();
+
+    /// Queues a job, the returned future becomes ready once it ran
+    std::shared_future<void> Submit(std::function<void()> job);
+
+private:
+    void WorkerThread();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::packaged_task<void()>> jobs;
+    bool stop = false;
+    std::thread thread;
+};
+
+} // namespace Service::FS
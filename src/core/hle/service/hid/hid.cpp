@@ -83,6 +83,8 @@ void Module::UpdatePadCallback(std::uintptr_t user_data, s64 cycles_late) {
         LoadInputDevices();
     }
 
+    system.perf_stats->RecordInputPoll();
+
     if (home_button->GetStatus()) {
         HomeButtonPressed();
     }
@@ -3,12 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstdlib>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include <fmt/format.h>
 #include <llhttp.h>
 #include <mbedtls/ssl.h>
 #include <string>
+#include <string_view>
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
@@ -21,6 +23,7 @@
 #include "core/hle/romfs.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/http_c.h"
+#include "core/hle/service/http_transfer_worker.h"
 #include "core/hw/aes/key.h"
 
 #include <curl/curl.h>
@@ -38,6 +41,7 @@ enum {
     /// already-initialized session, or when using the wrong context handle in a context-bound
     /// session
     SessionStateError = 102,
+    TimedOut = 105,
     TooManyClientCerts = 203,
     NotImplemented = 1012,
 };
@@ -58,11 +62,18 @@ const ResultCode ERROR_WRONG_CERT_HANDLE = // 0xD8A0A0C9
     ResultCode(201, ErrorModule::HTTP, ErrorSummary::InvalidState, ErrorLevel::Permanent);
 const ResultCode ERROR_CERT_ALREADY_SET = // 0xD8A0A03D
     ResultCode(61, ErrorModule::HTTP, ErrorSummary::InvalidState, ErrorLevel::Permanent);
+const ResultCode ERROR_TIMED_OUT = // 0xD820A069
+    ResultCode(ErrCodes::TimedOut, ErrorModule::HTTP, ErrorSummary::NothingHappened,
+               ErrorLevel::Permanent);
 const ResultCode RESULT_DOWNLOADPENDING = // 0xD840A02B
     ResultCode(static_cast<ErrorDescription>(43), ErrorModule::HTTP, ErrorSummary::WouldBlock,
                ErrorLevel::Permanent);
 
 Context::~Context() {
+    if (transfer_worker != nullptr) {
+        transfer_worker->Remove(curl);
+    }
+
     if (curl != nullptr) {
         curl_easy_cleanup(curl);
     }
@@ -72,7 +83,7 @@ Context::~Context() {
     }
 }
 
-void Context::MakeRequest() {
+void Context::MakeRequest(TransferWorker& worker) {
     ASSERT(state == RequestState::NotStarted);
 
     state = RequestState::InProgress;
@@ -109,7 +120,7 @@ void Context::MakeRequest() {
         return;
     }
 
-    error = curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_body);
+    error = curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
     if (error != CURLE_OK) {
         LOG_ERROR(Service_HTTP, "{}", curl_easy_strerror(error));
         curl_easy_cleanup(curl);
@@ -222,8 +233,13 @@ void Context::MakeRequest() {
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
                          static_cast<curl_write_callback>(
                              [](char* ptr, std::size_t size, std::size_t nmemb, void* userdata) {
+                                 Context* c = static_cast<Context*>(userdata);
                                  const std::size_t realsize = size * nmemb;
-                                 static_cast<std::string*>(userdata)->append(ptr, realsize);
+                                 {
+                                     std::lock_guard lock(c->transfer.mutex);
+                                     c->transfer.body.append(ptr, realsize);
+                                 }
+                                 c->transfer_worker->NotifyProgress();
                                  return realsize;
                              }));
     if (error != CURLE_OK) {
@@ -321,9 +337,7 @@ void Context::MakeRequest() {
         return;
     }
 
-    std::string response_headers_string;
-
-    error = curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response_headers_string);
+    error = curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
     if (error != CURLE_OK) {
         LOG_ERROR(Service_HTTP, "{}", curl_easy_strerror(error));
         if (request_headers_slist != nullptr) {
@@ -341,8 +355,26 @@ void Context::MakeRequest() {
         static_cast<std::size_t (*)(char* buffer, std::size_t size, std::size_t nitems,
                                     void* userdata)>(
             [](char* buffer, std::size_t size, std::size_t nitems, void* userdata) {
+                Context* c = static_cast<Context*>(userdata);
                 const std::size_t realsize = size * nitems;
-                static_cast<std::string*>(userdata)->append(buffer, realsize);
+                const std::string_view line(buffer, realsize);
+
+                std::lock_guard lock(c->transfer.mutex);
+                if (line.substr(0, 5) == "HTTP/") {
+                    // Interim responses such as 100 Continue come with their own headers
+                    c->transfer.headers.clear();
+                }
+                c->transfer.headers.append(buffer, realsize);
+
+                if (line == "\r\n" || line == "\n") {
+                    long status_code = 0;
+                    curl_easy_getinfo(c->curl, CURLINFO_RESPONSE_CODE, &status_code);
+                    if (status_code >= 200) {
+                        c->transfer.status_code = status_code;
+                        c->transfer.headers_complete = true;
+                        c->transfer_worker->NotifyProgress();
+                    }
+                }
                 return realsize;
             }));
     if (error != CURLE_OK) {
@@ -357,19 +389,54 @@ void Context::MakeRequest() {
         return;
     }
 
-    error = curl_easy_perform(curl);
-    if (error != CURLE_OK) {
-        LOG_ERROR(Service_HTTP, "{}", curl_easy_strerror(error));
-        if (request_headers_slist != nullptr) {
-            curl_slist_free_all(request_headers_slist);
-            request_headers_slist = nullptr;
+    transfer_worker = &worker;
+    worker.Add(curl, [this](CURLcode result) {
+        if (result != CURLE_OK) {
+            LOG_ERROR(Service_HTTP, "{}", curl_easy_strerror(result));
         }
-        curl_easy_cleanup(curl);
-        curl = nullptr;
-        state = RequestState::ReadyToDownloadContent;
+        std::lock_guard lock(transfer.mutex);
+        transfer.finished = true;
+    });
+}
+
+void Context::Update() {
+    if (transfer_worker == nullptr || transfer_finished) {
         return;
     }
 
+    std::string headers;
+    {
+        std::lock_guard lock(transfer.mutex);
+        response_body.append(transfer.body);
+        transfer.body.clear();
+        if (!headers_received && transfer.headers_complete) {
+            headers = std::move(transfer.headers);
+            status_code = static_cast<u32>(transfer.status_code);
+            headers_received = true;
+        }
+        transfer_finished = transfer.finished;
+    }
+
+    if (!headers.empty()) {
+        ParseResponseHeaders(headers);
+    }
+    if (headers_received || transfer_finished) {
+        state = RequestState::ReadyToDownloadContent;
+    }
+}
+
+bool Context::HeadersAvailable() const {
+    return transfer_worker == nullptr || headers_received || transfer_finished;
+}
+
+bool Context::BodyConsumed() const {
+    if (transfer_worker == nullptr || transfer_finished) {
+        return current_offset >= response_body.size();
+    }
+    return content_length && current_offset >= *content_length;
+}
+
+void Context::ParseResponseHeaders(const std::string& headers) {
     struct response_parser_data_t {
         std::string header_name;
         Context* context;
@@ -392,10 +459,12 @@ void Context::MakeRequest() {
     llhttp_t response_parser;
     llhttp_init(&response_parser, HTTP_RESPONSE, &response_parser_settings);
     response_parser.data = &response_parser_data;
-    llhttp_execute(&response_parser, response_headers_string.c_str(),
-                   response_headers_string.length());
+    llhttp_execute(&response_parser, headers.c_str(), headers.length());
 
-    state = RequestState::ReadyToDownloadContent;
+    const auto itr = response_headers.find("content-length");
+    if (itr != response_headers.end()) {
+        content_length = static_cast<u32>(std::strtoul(itr->second.c_str(), nullptr, 10));
+    }
 }
 
 void HTTP_C::Initialize(Kernel::HLERequestContext& ctx) {
@@ -502,10 +571,29 @@ void HTTP_C::BeginRequest(Kernel::HLERequestContext& ctx) {
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
 
-    itr->second.MakeRequest();
+    itr->second.MakeRequest(*transfer_worker);
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
-    rb.Push(RESULT_SUCCESS);
+    // The request is sent in the background, wake the guest up once the response arrived
+    const auto operation = [this, context_handle] {
+        auto itr = contexts.find(context_handle);
+        if (itr == contexts.end()) {
+            return true;
+        }
+        itr->second.Update();
+        return itr->second.HeadersAvailable();
+    };
+
+    const auto respond = [](Kernel::HLERequestContext& ctx, bool /*timed_out*/) {
+        IPC::RequestBuilder rb(ctx, 0x9, 1, 0);
+        rb.Push(RESULT_SUCCESS);
+    };
+
+    if (!operation()) {
+        WaitForTransfer(ctx, "http_c::BeginRequest", std::chrono::nanoseconds(-1), operation,
+                        respond);
+        return;
+    }
+    respond(ctx, false);
 }
 
 void HTTP_C::BeginRequestAsync(Kernel::HLERequestContext& ctx) {
@@ -547,7 +635,7 @@ void HTTP_C::BeginRequestAsync(Kernel::HLERequestContext& ctx) {
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
 
-    itr->second.MakeRequest();
+    itr->second.MakeRequest(*transfer_worker);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
@@ -561,29 +649,7 @@ void HTTP_C::ReceiveData(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_HTTP, "context_handle = {}, buffer_size = {}", context_handle, buffer_size);
 
-    auto itr = contexts.find(context_handle);
-    ASSERT(itr != contexts.end());
-
-    const u32 size = std::min<u32>(
-        buffer_size,
-        ((itr->second.response_headers.find("content-length") == itr->second.response_headers.end())
-             ? static_cast<u32>(itr->second.response_body.size())
-             : static_cast<u32>(std::stoul(itr->second.response_headers["content-length"]))) -
-            itr->second.current_offset);
-    buffer.Write(itr->second.response_body.substr(itr->second.current_offset, size).data(), 0,
-                 size);
-    itr->second.current_offset += size;
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    rb.Push(
-        itr->second.current_offset <
-                (itr->second.response_headers.find("content-length") ==
-                         itr->second.response_headers.end()
-                     ? static_cast<u32>(itr->second.response_body.size())
-                     : static_cast<u32>(std::stoul(itr->second.response_headers["content-length"])))
-            ? RESULT_DOWNLOADPENDING
-            : RESULT_SUCCESS);
-    rb.PushMappedBuffer(buffer);
+    ReceiveDataImpl(ctx, 0xB, context_handle, buffer_size, std::chrono::nanoseconds(-1), buffer);
 }
 
 void HTTP_C::ReceiveDataTimeout(Kernel::HLERequestContext& ctx) {
@@ -596,29 +662,90 @@ void HTTP_C::ReceiveDataTimeout(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_HTTP, "context_handle = {}, buffer_size = {}, timeout = {}", context_handle,
               buffer_size, timeout);
 
-    auto itr = contexts.find(context_handle);
-    ASSERT(itr != contexts.end());
+    ReceiveDataImpl(ctx, 0xC, context_handle, buffer_size,
+                    std::chrono::nanoseconds(static_cast<s64>(timeout)), buffer);
+}
 
-    const u32 size = std::min<u32>(
-        buffer_size,
-        ((itr->second.response_headers.find("content-length") == itr->second.response_headers.end())
-             ? static_cast<u32>(itr->second.response_body.size())
-             : static_cast<u32>(std::stoul(itr->second.response_headers["content-length"]))) -
-            itr->second.current_offset);
-    buffer.Write(itr->second.response_body.substr(itr->second.current_offset, size).data(), 0,
-                 size);
-    itr->second.current_offset += size;
+void HTTP_C::ReceiveDataImpl(Kernel::HLERequestContext& ctx, u16 command_id,
+                             Context::Handle context_handle, u32 buffer_size,
+                             std::chrono::nanoseconds timeout, Kernel::MappedBuffer buffer) {
+    ASSERT(contexts.find(context_handle) != contexts.end());
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
-    rb.Push(
-        itr->second.current_offset <
-                (itr->second.response_headers.find("content-length") ==
-                         itr->second.response_headers.end()
-                     ? static_cast<u32>(itr->second.response_body.size())
-                     : static_cast<u32>(std::stoul(itr->second.response_headers["content-length"])))
-            ? RESULT_DOWNLOADPENDING
-            : RESULT_SUCCESS);
-    rb.PushMappedBuffer(buffer);
+    // Data is copied to the guest as it arrives, the request completes once the buffer is full
+    // or the whole response was read
+    auto written = std::make_shared<u32>(0);
+
+    auto operation = [this, context_handle, buffer_size, buffer, written]() mutable {
+        auto itr = contexts.find(context_handle);
+        if (itr == contexts.end()) {
+            return true;
+        }
+        Context& context = itr->second;
+        context.Update();
+
+        const u32 available = static_cast<u32>(context.response_body.size()) -
+                              context.current_offset;
+        const u32 size = std::min(buffer_size - *written, available);
+        if (size != 0) {
+            buffer.Write(context.response_body.data() + context.current_offset, *written, size);
+            context.current_offset += size;
+            *written += size;
+        }
+        return *written == buffer_size || context.BodyConsumed();
+    };
+
+    const auto respond = [this, command_id, context_handle, buffer](Kernel::HLERequestContext& ctx,
+                                                                     bool timed_out) {
+        auto itr = contexts.find(context_handle);
+        IPC::RequestBuilder rb(ctx, command_id, 1, 2);
+        if (timed_out) {
+            rb.Push(ERROR_TIMED_OUT);
+        } else if (itr != contexts.end() && itr->second.BodyConsumed()) {
+            rb.Push(RESULT_SUCCESS);
+        } else {
+            // The buffer is full, the rest of the body is read by the next call
+            rb.Push(RESULT_DOWNLOADPENDING);
+        }
+        rb.PushMappedBuffer(buffer);
+    };
+
+    if (!operation()) {
+        WaitForTransfer(ctx, "http_c::ReceiveData", timeout, operation, respond);
+        return;
+    }
+    respond(ctx, false);
+}
+
+void HTTP_C::WaitForTransfer(Kernel::HLERequestContext& ctx, const std::string& reason,
+                             std::chrono::nanoseconds timeout, std::function<bool()> operation,
+                             std::function<void(Kernel::HLERequestContext&, bool)> respond) {
+    struct PendingRequest {
+        std::shared_ptr<Kernel::Event> event;
+        u64 waiter_id = 0;
+    };
+    auto pending = std::make_shared<PendingRequest>();
+
+    pending->event = ctx.SleepClientThread(
+        reason, timeout,
+        [this, pending, operation, respond](std::shared_ptr<Kernel::Thread> /*thread*/,
+                                            Kernel::HLERequestContext& ctx,
+                                            Kernel::ThreadWakeupReason reason) {
+            bool timed_out = false;
+            if (reason == Kernel::ThreadWakeupReason::Timeout) {
+                transfer_worker->Cancel(pending->waiter_id);
+                // Pick up whatever arrived since the last retry
+                timed_out = !operation();
+            }
+            respond(ctx, timed_out);
+        });
+
+    pending->waiter_id = transfer_worker->Wait([pending, operation] {
+        if (!operation()) {
+            return false;
+        }
+        pending->event->Signal();
+        return true;
+    });
 }
 
 void HTTP_C::CreateContext(Kernel::HLERequestContext& ctx) {
@@ -727,7 +854,7 @@ void HTTP_C::CloseContext(Kernel::HLERequestContext& ctx) {
     // TODO(Subv): What happens if you try to close a context that's currently being used?
     // TODO(Subv): Make sure that only the session that created the context can close it.
 
-    // Note that this will block if a request is still in progress
+    // Note that this cancels the transfer if the request is still in progress
     contexts.erase(itr);
     session_data->num_http_contexts--;
 
@@ -743,6 +870,7 @@ void HTTP_C::GetRequestState(Kernel::HLERequestContext& ctx) {
 
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
+    itr->second.Update();
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
     rb.Push(RESULT_SUCCESS);
@@ -757,14 +885,13 @@ void HTTP_C::GetDownloadSizeState(Kernel::HLERequestContext& ctx) {
 
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
+    Context& context = itr->second;
+    context.Update();
 
     IPC::RequestBuilder rb = rp.MakeBuilder(3, 0);
     rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(static_cast<u32>(itr->second.current_offset));
-    rb.Push<u32>(
-        itr->second.response_headers.find("content-length") == itr->second.response_headers.end()
-            ? static_cast<u32>(itr->second.response_body.size())
-            : static_cast<u32>(std::stoul(itr->second.response_headers["content-length"])));
+    rb.Push<u32>(context.current_offset);
+    rb.Push<u32>(context.content_length.value_or(static_cast<u32>(context.response_body.size())));
 }
 
 void HTTP_C::AddRequestHeader(Kernel::HLERequestContext& ctx) {
@@ -1072,6 +1199,7 @@ void HTTP_C::GetResponseHeader(Kernel::HLERequestContext& ctx) {
 
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
+    itr->second.Update();
 
     const std::string value =
         itr->second.response_headers.find(name) == itr->second.response_headers.end()
@@ -1093,19 +1221,9 @@ void HTTP_C::GetResponseStatusCode(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x22, 1, 0);
     const Context::Handle context_handle = rp.Pop<Context::Handle>();
 
-    auto itr = contexts.find(context_handle);
-    ASSERT(itr != contexts.end());
-
-    long status_code = 0;
-    if (itr->second.curl != nullptr) {
-        curl_easy_getinfo(itr->second.curl, CURLINFO_RESPONSE_CODE, &status_code);
-    }
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(static_cast<u32>(status_code));
+    LOG_DEBUG(Service_HTTP, "context_handle = {}", context_handle);
 
-    LOG_DEBUG(Service_HTTP, "context_handle = {}, status = {}", context_handle, status_code);
+    GetResponseStatusCodeImpl(ctx, 0x22, context_handle, std::chrono::nanoseconds(-1));
 }
 
 void HTTP_C::GetResponseStatusCodeTimeout(Kernel::HLERequestContext& ctx) {
@@ -1113,20 +1231,42 @@ void HTTP_C::GetResponseStatusCodeTimeout(Kernel::HLERequestContext& ctx) {
     const Context::Handle context_handle = rp.Pop<Context::Handle>();
     const u64 timeout = rp.Pop<u64>();
 
-    auto itr = contexts.find(context_handle);
-    ASSERT(itr != contexts.end());
+    LOG_DEBUG(Service_HTTP, "context_handle = {}, timeout = {}", context_handle, timeout);
 
-    long status_code = 0;
-    if (itr->second.curl != nullptr) {
-        curl_easy_getinfo(itr->second.curl, CURLINFO_RESPONSE_CODE, &status_code);
-    }
+    GetResponseStatusCodeImpl(ctx, 0x23, context_handle,
+                              std::chrono::nanoseconds(static_cast<s64>(timeout)));
+}
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push<u32>(static_cast<u32>(status_code));
+void HTTP_C::GetResponseStatusCodeImpl(Kernel::HLERequestContext& ctx, u16 command_id,
+                                       Context::Handle context_handle,
+                                       std::chrono::nanoseconds timeout) {
+    ASSERT(contexts.find(context_handle) != contexts.end());
 
-    LOG_DEBUG(Service_HTTP, "context_handle = {}, status = {}, timeout = {}", context_handle,
-              status_code, timeout);
+    const auto operation = [this, context_handle] {
+        auto itr = contexts.find(context_handle);
+        if (itr == contexts.end()) {
+            return true;
+        }
+        itr->second.Update();
+        return itr->second.HeadersAvailable();
+    };
+
+    const auto respond = [this, command_id, context_handle](Kernel::HLERequestContext& ctx,
+                                                            bool timed_out) {
+        auto itr = contexts.find(context_handle);
+        const u32 status_code = itr != contexts.end() ? itr->second.status_code : 0;
+        IPC::RequestBuilder rb(ctx, command_id, 2, 0);
+        rb.Push(timed_out ? ERROR_TIMED_OUT : RESULT_SUCCESS);
+        rb.Push<u32>(status_code);
+
+        LOG_DEBUG(Service_HTTP, "context_handle = {}, status = {}", context_handle, status_code);
+    };
+
+    if (!operation()) {
+        WaitForTransfer(ctx, "http_c::GetResponseStatusCode", timeout, operation, respond);
+        return;
+    }
+    respond(ctx, false);
 }
 
 void HTTP_C::SetClientCertContext(Kernel::HLERequestContext& ctx) {
@@ -1445,7 +1585,7 @@ void HTTP_C::DecryptClCertA() {
     ClCertA.init = true;
 }
 
-HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
+HTTP_C::HTTP_C(Core::System& system) : ServiceFramework("http:C", 32) {
     static const FunctionInfo functions[] = {
         {0x00010044, &HTTP_C::Initialize, "Initialize"},
         {0x00020082, &HTTP_C::CreateContext, "CreateContext"},
@@ -1507,10 +1647,17 @@ HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
     RegisterHandlers(functions);
 
     DecryptClCertA();
+
+    transfer_worker = std::make_unique<TransferWorker>(system.CoreTiming());
+}
+
+HTTP_C::~HTTP_C() {
+    // Stop every transfer before the worker goes away
+    contexts.clear();
 }
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<HTTP_C>()->InstallAsService(service_manager);
+    std::make_shared<HTTP_C>(system)->InstallAsService(service_manager);
 }
 } // namespace Service::HTTP
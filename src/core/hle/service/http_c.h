@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <curl/curl.h>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -19,6 +22,8 @@ class System;
 
 namespace Service::HTTP {
 
+class TransferWorker;
+
 enum class RequestMethod : u8 {
     None = 0x0,
     Get = 0x1,
@@ -80,7 +85,18 @@ public:
     Context& operator=(const Context&) = delete;
     ~Context();
 
-    void MakeRequest();
+    /// Starts the request on the transfer worker, it completes in the background
+    void MakeRequest(TransferWorker& worker);
+
+    /// Picks up what the transfer worker received so far, must be called on the emulation thread
+    /// before looking at the response
+    void Update();
+
+    /// Returns whether the response headers are available, or will never be
+    bool HeadersAvailable() const;
+
+    /// Returns whether the guest read the whole response body
+    bool BodyConsumed() const;
 
     struct Proxy {
         std::string url;
@@ -132,12 +148,32 @@ public:
     u32 socket_buffer_size;
     std::vector<RequestHeader> request_headers;
     std::unordered_map<std::string, std::string> response_headers;
+    std::optional<u32> content_length;
+    u32 status_code = 0;
     std::vector<PostData> post_data;
     u32 current_offset = 0;
     std::string request_body;
     std::string response_body;
     CURL* curl = nullptr;
     curl_slist* request_headers_slist = nullptr;
+
+    /// The worker running the request, nullptr if it was never started
+    TransferWorker* transfer_worker = nullptr;
+    bool headers_received = false;
+    bool transfer_finished = false;
+
+    /// Written by the transfer worker thread and picked up by Update
+    struct Transfer {
+        std::mutex mutex;
+        std::string headers;
+        std::string body;
+        long status_code = 0;
+        bool headers_complete = false;
+        bool finished = false;
+    } transfer;
+
+private:
+    void ParseResponseHeaders(const std::string& headers);
 };
 
 struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
@@ -159,7 +195,8 @@ struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
 
 class HTTP_C final : public ServiceFramework<HTTP_C, SessionData> {
 public:
-    HTTP_C();
+    explicit HTTP_C(Core::System& system);
+    ~HTTP_C();
 
 private:
     void Initialize(Kernel::HLERequestContext& ctx);
@@ -188,6 +225,26 @@ private:
 
     void DecryptClCertA();
 
+    /// Handles a ReceiveData request, writing response data to the buffer as it arrives
+    void ReceiveDataImpl(Kernel::HLERequestContext& ctx, u16 command_id,
+                         Context::Handle context_handle, u32 buffer_size,
+                         std::chrono::nanoseconds timeout, Kernel::MappedBuffer buffer);
+
+    /// Handles a GetResponseStatusCode request once the response headers arrived
+    void GetResponseStatusCodeImpl(Kernel::HLERequestContext& ctx, u16 command_id,
+                                   Context::Handle context_handle,
+                                   std::chrono::nanoseconds timeout);
+
+    /**
+     * Puts the requesting guest thread to sleep until an operation completes or times out.
+     * @param operation retried whenever a transfer makes progress, returns true once complete
+     * @param respond writes the response once the guest thread wakes up, told whether the
+     * operation timed out before completing
+     */
+    void WaitForTransfer(Kernel::HLERequestContext& ctx, const std::string& reason,
+                         std::chrono::nanoseconds timeout, std::function<bool()> operation,
+                         std::function<void(Kernel::HLERequestContext&, bool)> respond);
+
     std::shared_ptr<Kernel::SharedMemory> shared_memory = nullptr;
 
     /// The next number to use when a new HTTP session is initialized.
@@ -199,6 +256,9 @@ private:
     /// The next handle number to use when a new ClientCert context is created.
     ClientCertContext::Handle client_certs_counter = 0;
 
+    /// Declared before the contexts, which stop their transfers when they're destroyed.
+    std::unique_ptr<TransferWorker> transfer_worker;
+
     /// Global list of HTTP contexts currently opened.
     std::unordered_map<Context::Handle, Context> contexts;
 
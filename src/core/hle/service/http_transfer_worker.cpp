@@ -0,0 +1,144 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/hle/service/http_transfer_worker.h"
+
+namespace Service::HTTP {
+
+namespace {
+
+// How often the emulation thread picks up transfer progress while operations are waiting
+constexpr s64 DISPATCH_INTERVAL_US = 1000;
+
+// Upper bound for a single wait of the worker thread, it's woken up early for new work anyway
+constexpr int POLL_TIMEOUT_MS = 1000;
+
+} // namespace
+
+TransferWorker::TransferWorker(Core::Timing& timing)
+    : waiters(timing, "HTTP_C::TransferWorker", DISPATCH_INTERVAL_US, [this] { Dispatch(); }) {
+    multi = curl_multi_init();
+    if (multi == nullptr) {
+        LOG_ERROR(Service_HTTP, "curl_multi_init failed");
+        return;
+    }
+
+    thread = std::thread(&TransferWorker::WorkerThread, this);
+}
+
+TransferWorker::~TransferWorker() {
+    stop = true;
+    if (thread.joinable()) {
+        curl_multi_wakeup(multi);
+        thread.join();
+    }
+    if (multi != nullptr) {
+        for (const auto& [handle, on_done] : transfers) {
+            curl_multi_remove_handle(multi, handle);
+        }
+        curl_multi_cleanup(multi);
+    }
+}
+
+void TransferWorker::Add(CURL* handle, DoneCallback on_done) {
+    if (!thread.joinable()) {
+        on_done(CURLE_FAILED_INIT);
+        NotifyProgress();
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        pending_transfers.emplace_back(handle, std::move(on_done));
+    }
+    curl_multi_wakeup(multi);
+}
+
+void TransferWorker::Remove(CURL* handle) {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    std::unique_lock lock(mutex);
+    pending_removals.push_back(handle);
+    const u64 ticket = ++removals_requested;
+    curl_multi_wakeup(multi);
+    removal_cv.wait(lock, [this, ticket] { return removals_done >= ticket; });
+}
+
+void TransferWorker::NotifyProgress() {
+    progress = true;
+}
+
+u64 TransferWorker::Wait(Operation operation) {
+    return waiters.Add({}, std::move(operation));
+}
+
+void TransferWorker::Cancel(u64 id) {
+    waiters.Remove(id);
+}
+
+void TransferWorker::WorkerThread() {
+    while (!stop) {
+        {
+            std::lock_guard lock(mutex);
+            for (auto& [handle, on_done] : pending_transfers) {
+                const CURLMcode error = curl_multi_add_handle(multi, handle);
+                if (error != CURLM_OK) {
+                    LOG_ERROR(Service_HTTP, "{}", curl_multi_strerror(error));
+                    on_done(CURLE_FAILED_INIT);
+                    progress = true;
+                    continue;
+                }
+                transfers.emplace(handle, std::move(on_done));
+            }
+            pending_transfers.clear();
+
+            // Removed transfers may have finished already
+            for (CURL* handle : pending_removals) {
+                if (transfers.erase(handle) != 0) {
+                    curl_multi_remove_handle(multi, handle);
+                }
+            }
+            removals_done += pending_removals.size();
+            pending_removals.clear();
+        }
+        removal_cv.notify_all();
+
+        int running = 0;
+        const CURLMcode error = curl_multi_perform(multi, &running);
+        if (error != CURLM_OK) {
+            LOG_ERROR(Service_HTTP, "{}", curl_multi_strerror(error));
+        }
+
+        int queued = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi, &queued)) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            // The message doesn't survive removing its handle
+            CURL* handle = message->easy_handle;
+            const CURLcode result = message->data.result;
+            curl_multi_remove_handle(multi, handle);
+
+            auto itr = transfers.find(handle);
+            if (itr != transfers.end()) {
+                itr->second(result);
+                transfers.erase(itr);
+                progress = true;
+            }
+        }
+
+        curl_multi_poll(multi, nullptr, 0, POLL_TIMEOUT_MS, nullptr);
+    }
+}
+
+void TransferWorker::Dispatch() {
+    if (progress.exchange(false)) {
+        waiters.Retry([](std::monostate) { return true; }, [](std::monostate) {});
+    }
+}
+
+} // namespace Service::HTTP
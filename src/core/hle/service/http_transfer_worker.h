@@ -0,0 +1,84 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include <curl/curl.h>
+#include "common/common_types.h"
+#include "core/hle/service/waiter_list.h"
+
+namespace Service::HTTP {
+
+/**
+ * Runs HTTP transfers through a curl multi handle on a dedicated thread, so that requests never
+ * block the emulation thread. Guest operations that need data which hasn't arrived yet are handed
+ * to the worker and retried on the emulation thread whenever a transfer makes progress.
+ */
+class TransferWorker {
+public:
+    /// Called on the worker thread once a transfer finished
+    using DoneCallback = std::function<void(CURLcode result)>;
+
+    using Operation = WaiterList<std::monostate>::Operation;
+
+    explicit TransferWorker(Core::Timing& timing);
+    ~TransferWorker();
+
+    /**
+     * Starts a transfer. The write and header callbacks of the handle run on the worker thread and
+     * must call NotifyProgress when they receive something.
+     */
+    void Add(CURL* handle, DoneCallback on_done);
+
+    /// Stops a transfer. Once this returns, none of its callbacks are running or will run again.
+    void Remove(CURL* handle);
+
+    /// Wakes up the operations waiting on the emulation thread, safe to call from any thread
+    void NotifyProgress();
+
+    /**
+     * Retries an operation on the emulation thread whenever a transfer makes progress, until it
+     * completes.
+     * @returns an id that can be passed to Cancel
+     */
+    u64 Wait(Operation operation);
+
+    /// Stops retrying an operation, for example because the guest thread timed out
+    void Cancel(u64 id);
+
+private:
+    void WorkerThread();
+
+    /// Runs on the emulation thread, retries every waiting operation if a transfer made progress
+    void Dispatch();
+
+    // Every operation is retried on progress, so they don't need any data
+    WaiterList<std::monostate> waiters;
+
+    // Only touched on the worker thread
+    std::unordered_map<CURL*, DoneCallback> transfers;
+
+    // Shared with the worker thread
+    std::mutex mutex;
+    std::condition_variable removal_cv;
+    std::vector<std::pair<CURL*, DoneCallback>> pending_transfers;
+    std::vector<CURL*> pending_removals;
+    u64 removals_requested = 0;
+    u64 removals_done = 0;
+
+    std::atomic<bool> progress{false};
+    std::atomic<bool> stop{false};
+    CURLM* multi = nullptr;
+    std::thread thread;
+};
+
+} // namespace Service::HTTP
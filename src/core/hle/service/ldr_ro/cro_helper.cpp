@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include "common/alignment.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
@@ -65,20 +67,44 @@ VAddr CROHelper::SegmentTagToAddress(SegmentTag segment_tag) const {
     return entry.offset + segment_tag.offset_into_segment;
 }
 
-ResultCode CROHelper::ApplyRelocation(VAddr target_address, RelocationType relocation_type,
-                                      u32 addend, u32 symbol_address, u32 target_future_address) {
+CROHelper::RelocationWriter::~RelocationWriter() {
+    for (const auto& [begin, end] : written) {
+        system.InvalidateCacheRange(begin, end - begin);
+    }
+}
+
+void CROHelper::RelocationWriter::Write(VAddr address, u32 value) {
+    u8* pointer = system.Memory().GetDirectPointer(address);
+    if (pointer != nullptr && (address & Memory::PAGE_MASK) <= Memory::PAGE_SIZE - sizeof(u32)) {
+        std::memcpy(pointer, &value, sizeof(u32));
+    } else {
+        system.Memory().Write32(address, value);
+    }
+
+    // Relocations of a batch or table mostly target nearby words, merge writes within a page
+    const VAddr end = address + sizeof(u32);
+    if (!written.empty() && address + Memory::PAGE_SIZE >= written.back().first &&
+        address <= written.back().second + Memory::PAGE_SIZE) {
+        written.back().first = std::min(written.back().first, address);
+        written.back().second = std::max(written.back().second, end);
+    } else {
+        written.emplace_back(address, end);
+    }
+}
+
+ResultCode CROHelper::ApplyRelocation(RelocationWriter& writer, VAddr target_address,
+                                      RelocationType relocation_type, u32 addend,
+                                      u32 symbol_address, u32 target_future_address) {
 
     switch (relocation_type) {
     case RelocationType::Nothing:
         break;
     case RelocationType::AbsoluteAddress:
     case RelocationType::AbsoluteAddress2:
-        system.Memory().Write32(target_address, symbol_address + addend);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
+        writer.Write(target_address, symbol_address + addend);
         break;
     case RelocationType::RelativeAddress:
-        system.Memory().Write32(target_address, symbol_address + addend - target_future_address);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
+        writer.Write(target_address, symbol_address + addend - target_future_address);
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -93,15 +119,15 @@ ResultCode CROHelper::ApplyRelocation(VAddr target_address, RelocationType reloc
     return RESULT_SUCCESS;
 }
 
-ResultCode CROHelper::ClearRelocation(VAddr target_address, RelocationType relocation_type) {
+ResultCode CROHelper::ClearRelocation(RelocationWriter& writer, VAddr target_address,
+                                      RelocationType relocation_type) {
     switch (relocation_type) {
     case RelocationType::Nothing:
         break;
     case RelocationType::AbsoluteAddress:
     case RelocationType::AbsoluteAddress2:
     case RelocationType::RelativeAddress:
-        system.Memory().Write32(target_address, 0);
-        system.InvalidateCacheRange(target_address, sizeof(u32));
+        writer.Write(target_address, 0);
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -121,6 +147,7 @@ ResultCode CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool
         return CROFormatError(0x10);
     }
 
+    RelocationWriter writer(system);
     VAddr relocation_address = batch;
     for (;;) {
         RelocationEntry relocation;
@@ -132,8 +159,8 @@ ResultCode CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool
             return CROFormatError(0x12);
         }
 
-        ResultCode result = ApplyRelocation(relocation_target, relocation.type, relocation.addend,
-                                            symbol_address, relocation_target);
+        ResultCode result = ApplyRelocation(writer, relocation_target, relocation.type,
+                                            relocation.addend, symbol_address, relocation_target);
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
             return result;
@@ -154,6 +181,12 @@ ResultCode CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool
 }
 
 VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
+    const auto module_exports = export_index.find(module_address);
+    if (module_exports != export_index.end()) {
+        const auto symbol = module_exports->second.find(name);
+        return symbol != module_exports->second.end() ? symbol->second : 0;
+    }
+
     if (!GetField(ExportTreeNum)) {
         return 0;
     }
@@ -498,6 +531,7 @@ ResultCode CROHelper::ResetExternalRelocations() {
         return CROFormatError(0x12);
     }
 
+    RelocationWriter writer(system);
     bool batch_begin = true;
     for (u32 i = 0; i < external_relocation_num; ++i) {
         GetEntry(system.Memory(), i, relocation);
@@ -507,8 +541,9 @@ ResultCode CROHelper::ResetExternalRelocations() {
             return CROFormatError(0x12);
         }
 
-        ResultCode result = ApplyRelocation(relocation_target, relocation.type, relocation.addend,
-                                            unresolved_symbol, relocation_target);
+        ResultCode result = ApplyRelocation(writer, relocation_target, relocation.type,
+                                            relocation.addend, unresolved_symbol,
+                                            relocation_target);
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
             return result;
@@ -531,6 +566,7 @@ ResultCode CROHelper::ClearExternalRelocations() {
     u32 external_relocation_num = GetField(ExternalRelocationNum);
     ExternalRelocationEntry relocation;
 
+    RelocationWriter writer(system);
     bool batch_begin = true;
     for (u32 i = 0; i < external_relocation_num; ++i) {
         GetEntry(system.Memory(), i, relocation);
@@ -540,7 +576,7 @@ ResultCode CROHelper::ClearExternalRelocations() {
             return CROFormatError(0x12);
         }
 
-        ResultCode result = ClearRelocation(relocation_target, relocation.type);
+        ResultCode result = ClearRelocation(writer, relocation_target, relocation.type);
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error clearing relocation {:08X}", result.raw);
             return result;
@@ -565,7 +601,7 @@ ResultCode CROHelper::ApplyStaticAnonymousSymbolToCRS(VAddr crs_address) {
         static_relocation_table_offset +
         GetField(StaticRelocationNum) * sizeof(StaticRelocationEntry);
 
-    CROHelper crs(crs_address, process, system);
+    CROHelper crs(crs_address, process, system, export_index);
     u32 offset_export_num = GetField(StaticAnonymousSymbolNum);
     LOG_INFO(Service_LDR, "CRO \"{}\" exports {} static anonymous symbols", ModuleName(),
              offset_export_num);
@@ -594,6 +630,7 @@ ResultCode CROHelper::ApplyStaticAnonymousSymbolToCRS(VAddr crs_address) {
 ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
     u32 segment_num = GetField(SegmentNum);
     u32 internal_relocation_num = GetField(InternalRelocationNum);
+    RelocationWriter writer(system);
     for (u32 i = 0; i < internal_relocation_num; ++i) {
         InternalRelocationEntry relocation;
         GetEntry(system.Memory(), i, relocation);
@@ -622,8 +659,9 @@ ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
         GetEntry(system.Memory(), relocation.symbol_segment, symbol_segment);
         LOG_TRACE(Service_LDR, "Internally relocates 0x{:08X} with 0x{:08X}", target_address,
                   symbol_segment.offset);
-        ResultCode result = ApplyRelocation(target_address, relocation.type, relocation.addend,
-                                            symbol_segment.offset, target_addressB);
+        ResultCode result = ApplyRelocation(writer, target_address, relocation.type,
+                                            relocation.addend, symbol_segment.offset,
+                                            target_addressB);
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error applying relocation {:08X}", result.raw);
             return result;
@@ -634,6 +672,7 @@ ResultCode CROHelper::ApplyInternalRelocations(u32 old_data_segment_address) {
 
 ResultCode CROHelper::ClearInternalRelocations() {
     u32 internal_relocation_num = GetField(InternalRelocationNum);
+    RelocationWriter writer(system);
     for (u32 i = 0; i < internal_relocation_num; ++i) {
         InternalRelocationEntry relocation;
         GetEntry(system.Memory(), i, relocation);
@@ -643,7 +682,7 @@ ResultCode CROHelper::ClearInternalRelocations() {
             return CROFormatError(0x15);
         }
 
-        ResultCode result = ClearRelocation(target_address, relocation.type);
+        ResultCode result = ClearRelocation(writer, target_address, relocation.type);
         if (result.IsError()) {
             LOG_ERROR(Service_LDR, "Error clearing relocation {:08X}", result.raw);
             return result;
@@ -777,10 +816,11 @@ ResultCode CROHelper::ApplyImportNamedSymbol(VAddr crs_address) {
                                   sizeof(ExternalRelocationEntry));
 
         if (!relocation_entry.is_batch_resolved) {
+            std::string symbol_name =
+                system.Memory().ReadCString(entry.name_offset, import_strings_size);
             ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
-                    std::string symbol_name =
-                        system.Memory().ReadCString(entry.name_offset, import_strings_size);
+                process, system, export_index, crs_address,
+                [&](CROHelper source) -> ResultVal<bool> {
                     u32 symbol_address = source.FindExportNamedSymbol(symbol_name);
 
                     if (symbol_address != 0) {
@@ -881,7 +921,8 @@ ResultCode CROHelper::ApplyModuleImport(VAddr crs_address) {
             system.Memory().ReadCString(entry.name_offset, import_strings_size);
 
         ResultCode result = ForEachAutoLinkCRO(
-            process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+            process, system, export_index, crs_address,
+            [&](CROHelper source) -> ResultVal<bool> {
                 if (want_cro_name == source.ModuleName()) {
                     LOG_INFO(Service_LDR, "CRO \"{}\" imports {} indexed symbols from \"{}\"",
                              ModuleName(), entry.import_indexed_symbol_num, source.ModuleName());
@@ -1096,7 +1137,8 @@ ResultCode CROHelper::ApplyExitRelocations(VAddr crs_address) {
         if (system.Memory().ReadCString(entry.name_offset, import_strings_size) ==
             "__aeabi_atexit") {
             ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+                process, system, export_index, crs_address,
+                [&](CROHelper source) -> ResultVal<bool> {
                     u32 symbol_address = source.FindExportNamedSymbol("nnroAeabiAtexit_");
 
                     if (symbol_address != 0) {
@@ -1329,7 +1371,7 @@ ResultCode CROHelper::Link(VAddr crs_address, bool link_on_load_bug_fix) {
     }
 
     // Exports symbols to other modules
-    result = ForEachAutoLinkCRO(process, system, crs_address,
+    result = ForEachAutoLinkCRO(process, system, export_index, crs_address,
                                 [this](CROHelper target) -> ResultVal<bool> {
                                     ResultCode result = ApplyExportNamedSymbol(target);
                                     if (result.IsError()) {
@@ -1375,7 +1417,7 @@ ResultCode CROHelper::Unlink(VAddr crs_address) {
 
     // Resets all symbols in other modules imported from this module
     // Note: the RO service seems only searching in auto-link modules
-    result = ForEachAutoLinkCRO(process, system, crs_address,
+    result = ForEachAutoLinkCRO(process, system, export_index, crs_address,
                                 [this](CROHelper target) -> ResultVal<bool> {
                                     ResultCode result = ResetExportNamedSymbol(target);
                                     if (result.IsError()) {
@@ -1418,13 +1460,14 @@ void CROHelper::InitCRS() {
 }
 
 void CROHelper::Register(VAddr crs_address, bool auto_link) {
-    CROHelper crs(crs_address, process, system);
-    CROHelper head(auto_link ? crs.NextModule() : crs.PreviousModule(), process, system);
+    CROHelper crs(crs_address, process, system, export_index);
+    CROHelper head(auto_link ? crs.NextModule() : crs.PreviousModule(), process, system,
+                   export_index);
 
     if (head.module_address) {
         // There are already CROs registered
         // Register as the new tail
-        CROHelper tail(head.PreviousModule(), process, system);
+        CROHelper tail(head.PreviousModule(), process, system, export_index);
 
         // Link with the old tail
         ASSERT(tail.NextModule() == 0);
@@ -1451,11 +1494,11 @@ void CROHelper::Register(VAddr crs_address, bool auto_link) {
 }
 
 void CROHelper::Unregister(VAddr crs_address) {
-    CROHelper crs(crs_address, process, system);
-    CROHelper next_head(crs.NextModule(), process, system);
-    CROHelper previous_head(crs.PreviousModule(), process, system);
-    CROHelper next(NextModule(), process, system);
-    CROHelper previous(PreviousModule(), process, system);
+    CROHelper crs(crs_address, process, system, export_index);
+    CROHelper next_head(crs.NextModule(), process, system, export_index);
+    CROHelper previous_head(crs.PreviousModule(), process, system, export_index);
+    CROHelper next(NextModule(), process, system, export_index);
+    CROHelper previous(PreviousModule(), process, system, export_index);
 
     if (module_address == next_head.module_address ||
         module_address == previous_head.module_address) {
@@ -1547,6 +1590,32 @@ bool CROHelper::IsLoaded() const {
     return true;
 }
 
+void CROHelper::IndexExports() {
+    auto& exports = export_index[module_address];
+    exports.clear();
+
+    // Symbols are only found through the export tree
+    if (!GetField(ExportTreeNum)) {
+        return;
+    }
+
+    const u32 export_named_symbol_num = GetField(ExportNamedSymbolNum);
+    const u32 export_strings_size = GetField(ExportStringsSize);
+    exports.reserve(export_named_symbol_num);
+    for (u32 i = 0; i < export_named_symbol_num; ++i) {
+        ExportNamedSymbolEntry entry;
+        GetEntry(system.Memory(), i, entry);
+        exports.emplace(system.Memory().ReadCString(entry.name_offset, export_strings_size),
+                        SegmentTagToAddress(entry.symbol_position));
+    }
+
+    LOG_DEBUG(Service_LDR, "Indexed {} exports of CRO \"{}\"", exports.size(), ModuleName());
+}
+
+void CROHelper::UnindexExports() {
+    export_index.erase(module_address);
+}
+
 std::tuple<VAddr, u32> CROHelper::GetExecutablePages() const {
     u32 segment_num = GetField(SegmentNum);
     for (u32 i = 0; i < segment_num; ++i) {
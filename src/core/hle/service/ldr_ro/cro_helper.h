@@ -5,7 +5,11 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/result.h"
@@ -29,12 +33,20 @@ namespace Service::LDR {
 static constexpr u32 CRO_HEADER_SIZE = 0x138;
 static constexpr u32 CRO_HASH_SIZE = 0x80;
 
+/**
+ * Named exports of the loaded modules by module address. Linking looks every import up in every
+ * auto-link module, the index saves walking the export trees in guest memory for each lookup.
+ */
+using CROExportIndex = std::unordered_map<VAddr, std::unordered_map<std::string, VAddr>>;
+
 /// Represents a loaded module (CRO) with interfaces manipulating it.
 class CROHelper final {
 public:
     // TODO (wwylele): pass in the process handle for memory access
-    explicit CROHelper(VAddr cro_address, Kernel::Process& process, Core::System& system)
-        : module_address(cro_address), process(process), system(system) {}
+    explicit CROHelper(VAddr cro_address, Kernel::Process& process, Core::System& system,
+                       CROExportIndex& export_index)
+        : module_address(cro_address), process(process), system(system),
+          export_index(export_index) {}
 
     std::string ModuleName() const {
         return system.Memory().ReadCString(GetField(ModuleNameOffset), GetField(ModuleNameSize));
@@ -140,10 +152,33 @@ public:
      */
     std::tuple<VAddr, u32> GetExecutablePages() const;
 
+    /// Adds the named exports of this module to the export index, once it won't change anymore
+    void IndexExports();
+
+    /// Removes this module from the export index, before it's unloaded
+    void UnindexExports();
+
 private:
     const VAddr module_address; ///< the virtual address of this module
     Kernel::Process& process;   ///< the owner process of this module
     Core::System& system;
+    CROExportIndex& export_index;
+
+    /**
+     * Writes relocated words through host pointers where possible. The CPU caches are invalidated
+     * once per run of nearby writes when the writer is destroyed, rather than once per word.
+     */
+    class RelocationWriter {
+    public:
+        explicit RelocationWriter(Core::System& system) : system(system) {}
+        ~RelocationWriter();
+
+        void Write(VAddr address, u32 value);
+
+    private:
+        Core::System& system;
+        std::vector<std::pair<VAddr, VAddr>> written; ///< [begin, end) of the runs of writes
+    };
 
     /**
      * Each item in this enum represents a u32 field in the header begin from address+0x80,
@@ -473,10 +508,11 @@ private:
      */
     template <typename FunctionObject>
     static ResultCode ForEachAutoLinkCRO(Kernel::Process& process, Core::System& system,
-                                         VAddr crs_address, FunctionObject func) {
+                                         CROExportIndex& export_index, VAddr crs_address,
+                                         FunctionObject func) {
         VAddr current = crs_address;
         while (current != 0) {
-            CROHelper cro(current, process, system);
+            CROHelper cro(current, process, system, export_index);
             CASCADE_RESULT(bool next, func(cro));
             if (!next) {
                 break;
@@ -488,6 +524,7 @@ private:
 
     /**
      * Applies a relocation
+     * @param writer writes the relocated word
      * @param target_address where to apply the relocation
      * @param relocation_type the type of the relocation
      * @param addend address addend applied to the relocated symbol
@@ -496,16 +533,19 @@ private:
      *        Usually equals to target_address, but will be different for a target in .data segment
      * @returns ResultCode RESULT_SUCCESS on success, otherwise error code.
      */
-    ResultCode ApplyRelocation(VAddr target_address, RelocationType relocation_type, u32 addend,
-                               u32 symbol_address, u32 target_future_address);
+    ResultCode ApplyRelocation(RelocationWriter& writer, VAddr target_address,
+                               RelocationType relocation_type, u32 addend, u32 symbol_address,
+                               u32 target_future_address);
 
     /**
      * Clears a relocation to zero
+     * @param writer writes the cleared word
      * @param target_address where to apply the relocation
      * @param relocation_type the type of the relocation
      * @returns ResultCode RESULT_SUCCESS on success, otherwise error code.
      */
-    ResultCode ClearRelocation(VAddr target_address, RelocationType relocation_type);
+    ResultCode ClearRelocation(RelocationWriter& writer, VAddr target_address,
+                               RelocationType relocation_type);
 
     /**
      * Applies or resets a batch of relocations
@@ -122,7 +122,7 @@ void RO::Initialize(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    CROHelper crs(crs_address, *process, system);
+    CROHelper crs(crs_address, *process, system, slot->export_index);
     crs.InitCRS();
 
     result = crs.Rebase(0, crs_size, 0, 0, 0, 0, true);
@@ -132,6 +132,8 @@ void RO::Initialize(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    crs.IndexExports();
+
     slot->loaded_crs = crs_address;
 
     rb.Push(RESULT_SUCCESS);
@@ -256,7 +258,7 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
         return;
     }
 
-    CROHelper cro(cro_address, *process, system);
+    CROHelper cro(cro_address, *process, system, slot->export_index);
 
     result = cro.VerifyHash(cro_size, crr_address);
     if (result.IsError()) {
@@ -279,9 +281,13 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
         return;
     }
 
+    // Linking exports this module's symbols to the modules already loaded
+    cro.IndexExports();
+
     result = cro.Link(slot->loaded_crs, link_on_load_bug_fix);
     if (result.IsError()) {
         LOG_ERROR(Service_LDR, "Error linking CRO {:08X}", result.raw);
+        cro.UnindexExports();
         process->Unmap(cro_address, cro_buffer_ptr, cro_size, Kernel::VMAPermission::ReadWrite,
                        true);
         rb.Push(result);
@@ -293,6 +299,11 @@ void RO::LoadCRO(Kernel::HLERequestContext& ctx, bool link_on_load_bug_fix) {
 
     u32 fix_size = cro.Fix(fix_level);
 
+    // Fixing may crop the export tables
+    if (fix_level != 0) {
+        cro.IndexExports();
+    }
+
     if (fix_size != cro_size) {
         result = process->Unmap(cro_address + fix_size, cro_buffer_ptr + fix_size,
                                 cro_size - fix_size, Kernel::VMAPermission::ReadWrite, true);
@@ -338,11 +349,10 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}, zero={}, cro_buffer_ptr=0x{:08X}",
               cro_address, zero, cro_buffer_ptr);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
+    CROHelper cro(cro_address, *process, system, slot->export_index);
     if (slot->loaded_crs == 0) {
         LOG_ERROR(Service_LDR, "Not initialized");
         rb.Push(ERROR_NOT_INITIALIZED);
@@ -366,6 +376,7 @@ void RO::UnloadCRO(Kernel::HLERequestContext& ctx) {
     u32 fixed_size = cro.GetFixedSize();
 
     cro.Unregister(slot->loaded_crs);
+    cro.UnindexExports();
 
     ResultCode result = cro.Unlink(slot->loaded_crs);
     if (result.IsError()) {
@@ -405,11 +416,10 @@ void RO::LinkCRO(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}", cro_address);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
+    CROHelper cro(cro_address, *process, system, slot->export_index);
     if (slot->loaded_crs == 0) {
         LOG_ERROR(Service_LDR, "Not initialized");
         rb.Push(ERROR_NOT_INITIALIZED);
@@ -445,11 +455,10 @@ void RO::UnlinkCRO(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Service_LDR, "called, cro_address=0x{:08X}", cro_address);
 
-    CROHelper cro(cro_address, *process, system);
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
 
     ClientSlot* slot = GetSessionData(ctx.Session());
+    CROHelper cro(cro_address, *process, system, slot->export_index);
     if (slot->loaded_crs == 0) {
         LOG_ERROR(Service_LDR, "Not initialized");
         rb.Push(ERROR_NOT_INITIALIZED);
@@ -494,7 +503,7 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    CROHelper crs(slot->loaded_crs, *process, system);
+    CROHelper crs(slot->loaded_crs, *process, system, slot->export_index);
     crs.Unrebase(true);
 
     ResultCode result = RESULT_SUCCESS;
@@ -506,6 +515,7 @@ void RO::Shutdown(Kernel::HLERequestContext& ctx) {
     }
 
     slot->loaded_crs = 0;
+    slot->export_index.clear();
     rb.Push(result);
 }
 
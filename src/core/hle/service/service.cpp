@@ -139,6 +139,31 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
         // Usually this array is sorted by id already, so hint to insert at the end
         handlers.emplace_hint(handlers.cend(), functions[i].expected_header, functions[i]);
     }
+
+    // Inserting may have moved the handlers, so the whole table is rebuilt
+    handlers_by_command_id.clear();
+    for (const auto& [header, info] : handlers) {
+        const u32 command_id = header >> 16;
+        if (command_id >= handlers_by_command_id.size()) {
+            handlers_by_command_id.resize(command_id + 1, nullptr);
+        }
+        if (handlers_by_command_id[command_id] == nullptr) {
+            handlers_by_command_id[command_id] = &info;
+        }
+    }
+}
+
+const ServiceFrameworkBase::FunctionInfoBase* ServiceFrameworkBase::FindHandler(u32 header) const {
+    const u32 command_id = header >> 16;
+    if (command_id < handlers_by_command_id.size()) {
+        const FunctionInfoBase* info = handlers_by_command_id[command_id];
+        if (info != nullptr && info->expected_header == header) {
+            return info;
+        }
+    }
+
+    auto itr = handlers.find(header);
+    return itr == handlers.end() ? nullptr : &itr->second;
 }
 
 void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info) {
@@ -163,9 +188,7 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
 }
 
 void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
-    u32 header_code = context.CommandBuffer()[0];
-    auto itr = handlers.find(header_code);
-    const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
+    const FunctionInfoBase* info = FindHandler(context.CommandBuffer()[0]);
     if (info == nullptr || info->handler_callback == nullptr) {
         context.ReportUnimplemented();
         return ReportUnimplementedFunction(context.CommandBuffer(), info);
@@ -177,11 +200,8 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(u32 header) const {
-    if (!handlers.count(header)) {
-        return "";
-    }
-
-    return handlers.at(header).name;
+    const FunctionInfoBase* info = FindHandler(header);
+    return info == nullptr ? "" : info->name;
 }
 
 static bool AttemptLLE(const ServiceModuleInfo& service_module) {
@@ -91,6 +91,9 @@ private:
     void RegisterHandlersBase(const FunctionInfoBase* functions, std::size_t n);
     void ReportUnimplementedFunction(u32* cmd_buf, const FunctionInfoBase* info);
 
+    /// Finds the handler registered for a command header
+    const FunctionInfoBase* FindHandler(u32 header) const;
+
     /// Identifier string used to connect to the service.
     std::string service_name;
     /// Maximum number of concurrent sessions that this service can handle.
@@ -99,6 +102,9 @@ private:
     /// Function used to safely up-cast pointers to the derived class before invoking a handler.
     InvokerFn* handler_invoker;
     boost::container::flat_map<u32, FunctionInfoBase> handlers;
+    /// Handlers indexed by command ID (the upper half of the header), so that dispatching doesn't
+    /// need to search. Headers sharing a command ID with another one are only in handlers.
+    std::vector<const FunctionInfoBase*> handlers_by_command_id;
 };
 
 /**
@@ -163,7 +169,7 @@ protected:
         return std::make_unique<SessionData>();
     }
 
-    SessionData* GetSessionData(std::shared_ptr<Kernel::ServerSession> server_session) {
+    SessionData* GetSessionData(const std::shared_ptr<Kernel::ServerSession>& server_session) {
         return ServiceFrameworkBase::GetSessionData<SessionData>(server_session);
     }
 
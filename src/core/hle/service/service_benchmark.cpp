@@ -0,0 +1,91 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "core/core_timing.h"
+#include "core/hle/ipc.h"
+#include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/service/service.h"
+#include "core/hle/service/service_benchmark.h"
+#include "core/memory.h"
+
+namespace Service {
+
+namespace {
+
+/// A service with the given number of commands, which all add their two parameters
+class BenchmarkService final : public ServiceFramework<BenchmarkService> {
+public:
+    explicit BenchmarkService(u32 command_count) : ServiceFramework("bench:", 1) {
+        std::vector<FunctionInfo> functions;
+        functions.reserve(command_count);
+        for (u32 i = 1; i <= command_count; ++i) {
+            functions.emplace_back(IPC::MakeHeader(static_cast<u16>(i), 2, 0),
+                                   &BenchmarkService::Add, "Add");
+        }
+        RegisterHandlers(functions.data(), functions.size());
+    }
+
+private:
+    void Add(Kernel::HLERequestContext& ctx) {
+        IPC::RequestParser rp(ctx, IPC::Header{ctx.CommandBuffer()[0]});
+        const u32 a = rp.Pop<u32>();
+        const u32 b = rp.Pop<u32>();
+
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(a + b);
+    }
+};
+
+} // Anonymous namespace
+
+ServiceDispatchBenchmarkResult BenchmarkServiceDispatch(u64 requests, u32 command_count) {
+    ServiceDispatchBenchmarkResult result;
+    result.requests = requests;
+    command_count = std::clamp<u32>(command_count, 1, 0xFFFF);
+
+    Core::Timing timing;
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, timing, [] {}, 0);
+    std::shared_ptr<Kernel::Process> process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    auto service = std::make_shared<BenchmarkService>(command_count);
+    auto [server, client] = kernel.CreateSessionPair();
+    service->ClientConnected(server);
+
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buf{};
+    const auto start = std::chrono::steady_clock::now();
+    for (u64 i = 0; i < requests; ++i) {
+        const u32 header = IPC::MakeHeader(static_cast<u16>(i % command_count + 1), 2, 0);
+        cmd_buf[0] = header;
+        cmd_buf[1] = static_cast<u32>(i);
+        cmd_buf[2] = 1;
+
+        Kernel::HLERequestContext context(kernel, server, nullptr);
+        context.PopulateFromIncomingCommandBuffer(cmd_buf.data(), *process);
+        service->HandleSyncRequest(context);
+        context.WriteToOutgoingCommandBuffer(cmd_buf.data(), *process);
+
+        if (cmd_buf[0] != header || cmd_buf[1] != RESULT_SUCCESS.raw ||
+            cmd_buf[2] != static_cast<u32>(i) + 1) {
+            ++result.failed_requests;
+        }
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.requests_per_second = requests / result.seconds;
+
+    service->ClientDisconnected(server);
+    return result;
+}
+
+} // namespace Service
@@ -0,0 +1,27 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace Service {
+
+struct ServiceDispatchBenchmarkResult {
+    u64 requests = 0;                 ///< Requests handled
+    double seconds = 0.0;             ///< Time the requests took
+    double requests_per_second = 0.0; ///< Round trips per second
+    u64 failed_requests = 0;          ///< Requests that didn't get the expected response
+};
+
+/**
+ * Sends requests to a service with the given number of commands, cycling through all of them,
+ * the way ServerSession::HandleSyncRequest does for HLE services: the command buffer is translated
+ * into an HLERequestContext, dispatched through ServiceFrameworkBase::HandleSyncRequest and
+ * translated back. Copying the command buffer from and to the guest thread and putting the thread
+ * to sleep aren't included. Runs without an emulated system.
+ */
+ServiceDispatchBenchmarkResult BenchmarkServiceDispatch(u64 requests, u32 command_count);
+
+} // namespace Service
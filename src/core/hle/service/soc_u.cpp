@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <optional>
 #include <type_traits>
 #include <vector>
 #include "common/assert.h"
@@ -14,6 +15,7 @@
 #include "common/swap.h"
 #include "core/core.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
@@ -351,12 +353,127 @@ struct CTRAddrInfo {
 
 static_assert(sizeof(CTRAddrInfo) == 0x130, "Size of CTRAddrInfo is not correct");
 
+/// Returns whether a socket call failed only because the socket is non-blocking
+static bool WouldBlock(int error) {
+    return error == ERRNO(EAGAIN) || error == ERRNO(EWOULDBLOCK);
+}
+
+/// Host sockets are always non-blocking, blocking guest sockets wait through the reactor
+static void SetHostNonBlocking(u32 socket_handle) {
+#ifdef _WIN32
+    unsigned long non_blocking = 1;
+    const int ret = ioctlsocket(socket_handle, FIONBIO, &non_blocking);
+#else
+    const int flags = ::fcntl(socket_handle, F_GETFL, 0);
+    const int ret = flags == SOCKET_ERROR_VALUE
+                        ? flags
+                        : ::fcntl(socket_handle, F_SETFL, flags | O_NONBLOCK);
+#endif
+    if (ret == SOCKET_ERROR_VALUE) {
+        LOG_ERROR(Service_SOC, "Failed to make socket {} non-blocking: {}", socket_handle,
+                  GET_ERRNO);
+    }
+}
+
+/// Returns whether a socket is ready for the platform poll events without waiting
+static bool IsSocketReady(u32 socket_handle, short events) {
+    pollfd fd{};
+    fd.fd = socket_handle;
+    fd.events = events;
+    const s32 ret = ::poll(&fd, 1, 0);
+    return ret > 0;
+}
+
+struct RecvFromResult {
+    s32 ret = 0;
+    s32 total_received = 0;
+    std::vector<u8> data;
+    std::vector<u8> addr;
+};
+
+/// Receives without blocking, returns false if nothing was available yet
+static bool TryRecvFrom(u32 socket_handle, u32 len, u32 flags, bool get_addr,
+                        RecvFromResult& result) {
+    CTRSockAddr ctr_src_addr;
+    result.data.resize(len);
+    result.addr.resize(get_addr ? sizeof(ctr_src_addr) : 0);
+    sockaddr src_addr;
+    socklen_t src_addr_len = sizeof(src_addr);
+
+    s32 ret = -1;
+    if (get_addr) {
+        // Only get src adr if input adr available
+        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(result.data.data()), len, flags,
+                         &src_addr, &src_addr_len);
+        if (ret >= 0 && src_addr_len > 0) {
+            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+            std::memcpy(result.addr.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+        }
+    } else {
+        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(result.data.data()), len, flags,
+                         NULL, 0);
+    }
+
+    if (ret == SOCKET_ERROR_VALUE) {
+        const int error = GET_ERRNO;
+        result.ret = TranslateError(error);
+        result.total_received = 0;
+        result.data.clear();
+        return !WouldBlock(error);
+    }
+
+    // Keep only the data we received to avoid overwriting parts of the buffer with zeros
+    result.ret = ret;
+    result.total_received = ret;
+    result.data.resize(ret);
+    return true;
+}
+
 void SOC_U::CleanupSockets() {
-    for (auto sock : open_sockets)
+    for (auto sock : open_sockets) {
         closesocket(sock.second.socket_fd);
+        reactor->Forget(sock.second.socket_fd);
+    }
     open_sockets.clear();
 }
 
+bool SOC_U::IsBlocking(u32 socket_handle) const {
+    auto iter = open_sockets.find(socket_handle);
+    return iter == open_sockets.end() || iter->second.blocking;
+}
+
+void SOC_U::WaitForSockets(Kernel::HLERequestContext& ctx, const std::string& reason,
+                           std::vector<SocketReactor::Watch> sockets,
+                           std::chrono::nanoseconds timeout, SocketReactor::Operation operation,
+                           std::function<void(Kernel::HLERequestContext&)> respond) {
+    struct PendingRequest {
+        std::shared_ptr<Kernel::Event> event;
+        u64 waiter_id = 0;
+    };
+    auto pending = std::make_shared<PendingRequest>();
+
+    pending->event = ctx.SleepClientThread(
+        reason, timeout,
+        [this, pending, operation, respond](std::shared_ptr<Kernel::Thread> /*thread*/,
+                                            Kernel::HLERequestContext& ctx,
+                                            Kernel::ThreadWakeupReason reason) {
+            if (reason == Kernel::ThreadWakeupReason::Timeout) {
+                reactor->Cancel(pending->waiter_id);
+                // Pick up the final state, e.g. sockets that became ready since the last retry
+                operation();
+            }
+            respond(ctx);
+        });
+
+    pending->waiter_id = reactor->Wait(std::move(sockets), [pending, operation] {
+        if (!operation()) {
+            return false;
+        }
+        pending->event->Signal();
+        return true;
+    });
+}
+
 void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x02, 3, 2);
     u32 domain = rp.Pop<u32>(); // Address family
@@ -388,6 +505,7 @@ void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
     u32 ret = static_cast<u32>(::socket(domain, type, protocol));
 
     if ((s32)ret != SOCKET_ERROR_VALUE) {
+        SetHostNonBlocking(ret);
         open_sockets[ret] = {ret, true};
     }
 
@@ -436,55 +554,20 @@ void SOC_U::Fcntl(Kernel::HLERequestContext& ctx) {
         rb.Push(posix_ret);
     });
 
+    // Host sockets are always non-blocking, so only the mode the guest expects is tracked
+    auto iter = open_sockets.find(socket_handle);
+    if (iter == open_sockets.end()) {
+        posix_ret = TranslateError(ERRNO(EBADF));
+        return;
+    }
+
     if (ctr_cmd == 3) { // F_GETFL
-#ifdef _WIN32
-        posix_ret = 0;
-        auto iter = open_sockets.find(socket_handle);
-        if (iter != open_sockets.end() && iter->second.blocking == false) {
-            posix_ret |= 4; // O_NONBLOCK
-        }
-#else
-        int ret = ::fcntl(socket_handle, F_GETFL, 0);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
         posix_ret = 0;
-        if (ret & O_NONBLOCK) {
+        if (!iter->second.blocking) {
             posix_ret |= 4; // O_NONBLOCK
         }
-#endif
     } else if (ctr_cmd == 4) { // F_SETFL
-#ifdef _WIN32
-        unsigned long tmp = (ctr_arg & 4 /* O_NONBLOCK */) ? 1 : 0;
-        int ret = ioctlsocket(socket_handle, FIONBIO, &tmp);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-        auto iter = open_sockets.find(socket_handle);
-        if (iter != open_sockets.end()) {
-            iter->second.blocking = (tmp == 0);
-        }
-#else
-        int flags = ::fcntl(socket_handle, F_GETFL, 0);
-        if (flags == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-
-        flags &= ~O_NONBLOCK;
-        if (ctr_arg & 4) // O_NONBLOCK
-        {
-            flags |= O_NONBLOCK;
-        }
-
-        int ret = ::fcntl(socket_handle, F_SETFL, flags);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-#endif
+        iter->second.blocking = (ctr_arg & 4 /* O_NONBLOCK */) == 0;
     } else {
         LOG_ERROR(Service_SOC, "Unsupported command ({}) in fcntl call", ctr_cmd);
         posix_ret = TranslateError(EINVAL); // TODO: Find the correct error
@@ -509,34 +592,50 @@ void SOC_U::Listen(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x04, 2, 2);
     const auto socket_handle = rp.Pop<u32>();
     [[maybe_unused]] const auto max_addr_len = static_cast<socklen_t>(rp.Pop<u32>());
     rp.PopPID();
-    sockaddr addr;
-    socklen_t addr_len = sizeof(addr);
-    u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
 
-    if (static_cast<s32>(ret) != SOCKET_ERROR_VALUE) {
+    struct AcceptResult {
+        u32 ret = 0;
+        std::vector<u8> addr = std::vector<u8>(sizeof(CTRSockAddr));
+    };
+    auto result = std::make_shared<AcceptResult>();
+
+    const auto operation = [this, socket_handle, result] {
+        sockaddr addr;
+        socklen_t addr_len = sizeof(addr);
+        u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
+
+        if (static_cast<s32>(ret) == SOCKET_ERROR_VALUE) {
+            const int error = GET_ERRNO;
+            result->ret = TranslateError(error);
+            return !WouldBlock(error);
+        }
+
+        SetHostNonBlocking(ret);
         open_sockets[ret] = {ret, true};
-    }
 
-    CTRSockAddr ctr_addr;
-    std::vector<u8> ctr_addr_buf(sizeof(ctr_addr));
-    if (static_cast<s32>(ret) == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        ctr_addr = CTRSockAddr::FromPlatform(addr);
-        std::memcpy(ctr_addr_buf.data(), &ctr_addr, sizeof(ctr_addr));
-    }
+        CTRSockAddr ctr_addr = CTRSockAddr::FromPlatform(addr);
+        std::memcpy(result->addr.data(), &ctr_addr, sizeof(ctr_addr));
+        result->ret = ret;
+        return true;
+    };
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(std::move(ctr_addr_buf), 0);
+    const auto respond = [result](Kernel::HLERequestContext& ctx) {
+        IPC::RequestBuilder rb(ctx, 0x04, 2, 2);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(result->ret);
+        rb.PushStaticBuffer(std::move(result->addr), 0);
+    };
+
+    if (!operation() && IsBlocking(socket_handle)) {
+        WaitForSockets(ctx, "soc_u::Accept", {{socket_handle, SocketReactor::Readable}},
+                       std::chrono::nanoseconds(-1), operation, respond);
+        return;
+    }
+    respond(ctx);
 }
 
 void SOC_U::GetHostId(Kernel::HLERequestContext& ctx) {
@@ -566,6 +665,9 @@ void SOC_U::Close(Kernel::HLERequestContext& ctx) {
 
     ret = closesocket(socket_handle);
 
+    // Guest threads still waiting on the socket wake up with an error
+    reactor->Forget(socket_handle);
+
     if (ret != 0) {
         ret = TranslateError(GET_ERRNO);
     }
@@ -582,28 +684,69 @@ void SOC_U::SendTo(Kernel::HLERequestContext& ctx) {
     u32 flags = rp.Pop<u32>();
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
-    const std::vector<u8> input_buff = rp.PopStaticBuffer();
+    auto input_buff = std::make_shared<const std::vector<u8>>(rp.PopStaticBuffer());
     const std::vector<u8> dest_addr_buff = rp.PopStaticBuffer();
 
-    s32 ret = -1;
+    std::optional<sockaddr> dest_addr;
     if (addr_len > 0) {
         CTRSockAddr ctr_dest_addr;
         std::memcpy(&ctr_dest_addr, dest_addr_buff.data(), sizeof(ctr_dest_addr));
-        sockaddr dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
-        ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                       &dest_addr, sizeof(dest_addr));
-    } else {
-        ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                       nullptr, 0);
+        dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
     }
 
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    }
+    struct SendState {
+        u32 sent = 0;
+        s32 ret = -1;
+    };
+    auto state = std::make_shared<SendState>();
+
+    // Like a blocking host send, a blocking guest send only completes once everything was sent
+    // or an error occurred, waiting for the socket to become writable whenever its buffer is full
+    const bool blocking = IsBlocking(socket_handle);
+    const auto operation = [socket_handle, len, flags, input_buff, dest_addr, state, blocking] {
+        const char* data = reinterpret_cast<const char*>(input_buff->data());
+        while (true) {
+            const char* remaining = data + state->sent;
+            const u32 remaining_len = len - state->sent;
+            s32 ret;
+            if (dest_addr) {
+                ret = ::sendto(socket_handle, remaining, remaining_len, flags, &*dest_addr,
+                               sizeof(*dest_addr));
+            } else {
+                ret = ::sendto(socket_handle, remaining, remaining_len, flags, nullptr, 0);
+            }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
+            if (ret == SOCKET_ERROR_VALUE) {
+                const int error = GET_ERRNO;
+                if (blocking && WouldBlock(error)) {
+                    return false;
+                }
+                // Report what was sent before the error, like the host does
+                state->ret = state->sent != 0 ? static_cast<s32>(state->sent)
+                                              : TranslateError(error);
+                return !WouldBlock(error);
+            }
+
+            state->sent += ret;
+            state->ret = static_cast<s32>(state->sent);
+            if (!blocking || state->sent == len || ret == 0) {
+                return true;
+            }
+        }
+    };
+
+    const auto respond = [state](Kernel::HLERequestContext& ctx) {
+        IPC::RequestBuilder rb(ctx, 0x0A, 2, 0);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(state->ret);
+    };
+
+    if (!operation() && blocking) {
+        WaitForSockets(ctx, "soc_u::SendTo", {{socket_handle, SocketReactor::Writable}},
+                       std::chrono::nanoseconds(-1), operation, respond);
+        return;
+    }
+    respond(ctx);
 }
 
 void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
@@ -613,45 +756,34 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     u32 flags = rp.Pop<u32>();
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
-    Kernel::MappedBuffer& buffer = rp.PopMappedBuffer();
+    Kernel::MappedBuffer buffer = rp.PopMappedBuffer();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
+    auto result = std::make_shared<RecvFromResult>();
+    const auto operation = [socket_handle, len, flags, addr_len, result] {
+        return TryRecvFrom(socket_handle, len, flags, addr_len > 0, *result);
+    };
 
-    s32 ret = -1;
-    if (addr_len > 0) {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+    auto respond = [result, buffer](Kernel::HLERequestContext& ctx) mutable {
+        if (!result->data.empty()) {
+            buffer.Write(result->data.data(), 0, result->data.size());
         }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
 
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        buffer.Write(output_buff.data(), 0, ret);
-    }
+        IPC::RequestBuilder rb(ctx, 0x7, 2, 4);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(result->ret);
+        rb.PushStaticBuffer(std::move(result->addr), 0);
+        rb.PushMappedBuffer(buffer);
+    };
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(std::move(addr_buff), 0);
-    rb.PushMappedBuffer(buffer);
+    if (!operation() && IsBlocking(socket_handle)) {
+        WaitForSockets(ctx, "soc_u::RecvFromOther", {{socket_handle, SocketReactor::Readable}},
+                       std::chrono::nanoseconds(-1), operation, respond);
+        return;
+    }
+    respond(ctx);
 }
 
 void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x08, 4, 2);
     u32 socket_handle = rp.Pop<u32>();
     u32 len = rp.Pop<u32>();
@@ -659,42 +791,26 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
+    auto result = std::make_shared<RecvFromResult>();
+    const auto operation = [socket_handle, len, flags, addr_len, result] {
+        return TryRecvFrom(socket_handle, len, flags, addr_len > 0, *result);
+    };
 
-    s32 ret = -1;
-    if (addr_len > 0) {
-        // Only get src adr if input adr available
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
-        }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
+    const auto respond = [result](Kernel::HLERequestContext& ctx) {
+        IPC::RequestBuilder rb(ctx, 0x08, 3, 4);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(result->ret);
+        rb.Push(result->total_received);
+        rb.PushStaticBuffer(std::move(result->data), 0);
+        rb.PushStaticBuffer(std::move(result->addr), 1);
+    };
 
-    s32 total_received = ret;
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-        total_received = 0;
+    if (!operation() && IsBlocking(socket_handle)) {
+        WaitForSockets(ctx, "soc_u::RecvFrom", {{socket_handle, SocketReactor::Readable}},
+                       std::chrono::nanoseconds(-1), operation, respond);
+        return;
     }
-
-    // Write only the data we received to avoid overwriting parts of the buffer with zeros
-    output_buff.resize(total_received);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.Push(total_received);
-    rb.PushStaticBuffer(std::move(output_buff), 0);
-    rb.PushStaticBuffer(std::move(addr_buff), 1);
+    respond(ctx);
 }
 
 void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
@@ -707,29 +823,61 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
     std::vector<CTRPollFD> ctr_fds(nfds);
     std::memcpy(ctr_fds.data(), input_fds.data(), nfds * sizeof(CTRPollFD));
 
+    struct PollState {
+        std::vector<pollfd> fds;
+        s32 ret = 0;
+    };
+    auto state = std::make_shared<PollState>();
+
     // The 3ds_pollfd and the pollfd structures may be different (Windows/Linux have different
     // sizes)
     // so we have to copy the data
-    std::vector<pollfd> platform_pollfd(nfds);
-    std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
+    state->fds.resize(nfds);
+    std::transform(ctr_fds.begin(), ctr_fds.end(), state->fds.begin(), CTRPollFD::ToPlatform);
+
+    // The host is only ever polled without waiting, the reactor waits instead
+    const auto operation = [state] {
+        s32 ret = ::poll(state->fds.data(), static_cast<u32>(state->fds.size()), 0);
+        if (ret == SOCKET_ERROR_VALUE) {
+            ret = TranslateError(GET_ERRNO);
+        }
+        state->ret = ret;
+        return ret != 0;
+    };
 
-    s32 ret = ::poll(platform_pollfd.data(), nfds, timeout);
+    const auto respond = [state](Kernel::HLERequestContext& ctx) {
+        // Now update the output pollfd structure
+        std::vector<CTRPollFD> ctr_fds(state->fds.size());
+        std::transform(state->fds.begin(), state->fds.end(), ctr_fds.begin(),
+                       CTRPollFD::FromPlatform);
 
-    // Now update the output pollfd structure
-    std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
-                   CTRPollFD::FromPlatform);
+        std::vector<u8> output_fds(ctr_fds.size() * sizeof(CTRPollFD));
+        std::memcpy(output_fds.data(), ctr_fds.data(), output_fds.size());
 
-    std::vector<u8> output_fds(nfds * sizeof(CTRPollFD));
-    std::memcpy(output_fds.data(), ctr_fds.data(), nfds * sizeof(CTRPollFD));
+        IPC::RequestBuilder rb(ctx, 0x14, 2, 2);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(state->ret);
+        rb.PushStaticBuffer(std::move(output_fds), 0);
+    };
 
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
+    if (operation() || timeout == 0) {
+        respond(ctx);
+        return;
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(std::move(output_fds), 0);
+    std::vector<SocketReactor::Watch> sockets;
+    for (const pollfd& fd : state->fds) {
+        // Errors and hangups are reported for either
+        u32 events = (fd.events & POLLOUT) ? SocketReactor::Writable : 0;
+        if ((fd.events & (POLLIN | POLLPRI)) || events == 0) {
+            events |= SocketReactor::Readable;
+        }
+        sockets.push_back({static_cast<u32>(fd.fd), events});
+    }
+
+    const std::chrono::nanoseconds timeout_ns =
+        timeout < 0 ? std::chrono::nanoseconds(-1) : std::chrono::milliseconds(timeout);
+    WaitForSockets(ctx, "soc_u::Poll", std::move(sockets), timeout_ns, operation, respond);
 }
 
 void SOC_U::GetSockName(Kernel::HLERequestContext& ctx) {
@@ -797,9 +945,6 @@ void SOC_U::GetPeerName(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x06, 2, 4);
     const auto socket_handle = rp.Pop<u32>();
     [[maybe_unused]] const auto input_addr_len = rp.Pop<u32>();
@@ -811,13 +956,50 @@ void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
 
     sockaddr input_addr = CTRSockAddr::ToPlatform(ctr_input_addr);
     s32 ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
-    if (ret != 0) {
-        ret = TranslateError(GET_ERRNO);
+
+    const auto respond = [](Kernel::HLERequestContext& ctx, s32 ret) {
+        IPC::RequestBuilder rb(ctx, 0x06, 2, 0);
+        rb.Push(RESULT_SUCCESS);
+        rb.Push(ret);
+    };
+
+    if (ret == 0) {
+        respond(ctx, ret);
+        return;
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
+    int error = GET_ERRNO;
+#ifdef _WIN32
+    // Winsock reports a pending non-blocking connection as WSAEWOULDBLOCK
+    if (error == WSAEWOULDBLOCK) {
+        error = WSAEINPROGRESS;
+    }
+#endif
+    if (error != ERRNO(EINPROGRESS) || !IsBlocking(socket_handle)) {
+        respond(ctx, TranslateError(error));
+        return;
+    }
+
+    // The host socket is non-blocking, wait for the connection to be established or refused
+    auto result = std::make_shared<s32>(0);
+    const auto operation = [socket_handle, result] {
+        if (!IsSocketReady(socket_handle, POLLOUT)) {
+            return false;
+        }
+
+        int connect_error = 0;
+        socklen_t length = sizeof(connect_error);
+        if (::getsockopt(socket_handle, SOL_SOCKET, SO_ERROR,
+                         reinterpret_cast<char*>(&connect_error), &length) != 0) {
+            connect_error = GET_ERRNO;
+        }
+        *result = connect_error == 0 ? 0 : TranslateError(connect_error);
+        return true;
+    };
+
+    WaitForSockets(ctx, "soc_u::Connect", {{socket_handle, SocketReactor::Writable}},
+                   std::chrono::nanoseconds(-1), operation,
+                   [result, respond](Kernel::HLERequestContext& ctx) { respond(ctx, *result); });
 }
 
 void SOC_U::InitializeSockets(Kernel::HLERequestContext& ctx) {
@@ -992,7 +1174,7 @@ void SOC_U::GetNameInfoImpl(Kernel::HLERequestContext& ctx) {
     rb.PushStaticBuffer(std::move(serv), 1);
 }
 
-SOC_U::SOC_U() : ServiceFramework("soc:U") {
+SOC_U::SOC_U(Core::System& system) : ServiceFramework("soc:U") {
     static const FunctionInfo functions[] = {
         {0x00010044, &SOC_U::InitializeSockets, "InitializeSockets"},
         {0x000200C2, &SOC_U::Socket, "Socket"},
@@ -1035,10 +1217,13 @@ SOC_U::SOC_U() : ServiceFramework("soc:U") {
     WSADATA data;
     WSAStartup(MAKEWORD(2, 2), &data);
 #endif
+
+    reactor = std::make_unique<SocketReactor>(system.CoreTiming());
 }
 
 SOC_U::~SOC_U() {
     CleanupSockets();
+    reactor.reset();
 #ifdef _WIN32
     WSACleanup();
 #endif
@@ -1046,7 +1231,7 @@ SOC_U::~SOC_U() {
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<SOC_U>()->InstallAsService(service_manager);
+    std::make_shared<SOC_U>(system)->InstallAsService(service_manager);
 }
 
 } // namespace Service::SOC
@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 #include "core/hle/service/service.h"
+#include "core/hle/service/socket_reactor.h"
 
 namespace Core {
 class System;
@@ -16,12 +22,12 @@ namespace Service::SOC {
 /// Holds information about a particular socket
 struct SocketHolder {
     u32 socket_fd; ///< The socket descriptor
-    bool blocking; ///< Whether the socket is blocking or not, it is only read on Windows.
+    bool blocking; ///< Whether the guest expects the socket to block, host sockets never do
 };
 
 class SOC_U final : public ServiceFramework<SOC_U> {
 public:
-    SOC_U();
+    explicit SOC_U(Core::System& system);
     ~SOC_U();
 
 private:
@@ -53,8 +59,25 @@ private:
     /// Close all open sockets
     void CleanupSockets();
 
+    /// Returns whether the guest expects operations on the socket to block
+    bool IsBlocking(u32 socket_handle) const;
+
+    /**
+     * Parks the requesting guest thread until an operation that would block completes, leaving the
+     * emulated CPU running.
+     * @param operation retried on the emulation thread whenever one of the sockets becomes ready,
+     * returns false while it would still block
+     * @param respond writes the response once the operation completed or the timeout expired
+     */
+    void WaitForSockets(Kernel::HLERequestContext& ctx, const std::string& reason,
+                        std::vector<SocketReactor::Watch> sockets,
+                        std::chrono::nanoseconds timeout, SocketReactor::Operation operation,
+                        std::function<void(Kernel::HLERequestContext&)> respond);
+
     /// Holds info about the currently open sockets
     std::unordered_map<u32, SocketHolder> open_sockets;
+
+    std::unique_ptr<SocketReactor> reactor;
 };
 
 void InstallInterfaces(Core::System& system);
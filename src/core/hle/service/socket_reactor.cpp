@@ -0,0 +1,249 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include "common/logging/log.h"
+#include "core/hle/service/socket_reactor.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#include <poll.h>
+#endif
+
+namespace Service::SOC {
+
+namespace {
+
+// How often the emulation thread picks up sockets that became ready while operations are waiting
+constexpr s64 DISPATCH_INTERVAL_US = 500;
+
+#ifndef __linux__
+// The fallback reactor can't be woken up, so it polls with a short timeout to notice new sockets
+constexpr int FALLBACK_POLL_TIMEOUT_MS = 5;
+#endif
+
+} // namespace
+
+SocketReactor::SocketReactor(Core::Timing& timing)
+    : waiters(timing, "SOC_U::SocketReactor", DISPATCH_INTERVAL_US, [this] { Dispatch(); }) {
+#ifdef __linux__
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd == -1 || wakeup_fd == -1) {
+        LOG_ERROR(Service_SOC, "Failed to create the socket reactor: {}", errno);
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeup_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event);
+#endif
+
+    thread = std::thread(&SocketReactor::ReactorThread, this);
+}
+
+SocketReactor::~SocketReactor() {
+    stop = true;
+#ifdef __linux__
+    if (wakeup_fd != -1) {
+        const u64 value = 1;
+        [[maybe_unused]] const ssize_t written = write(wakeup_fd, &value, sizeof(value));
+    }
+#endif
+    if (thread.joinable()) {
+        thread.join();
+    }
+#ifdef __linux__
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+    }
+    if (wakeup_fd != -1) {
+        close(wakeup_fd);
+    }
+#endif
+}
+
+u64 SocketReactor::Wait(std::vector<Watch> sockets, Operation operation) {
+    const u64 id = waiters.Add(sockets, std::move(operation));
+    for (const Watch& watch : sockets) {
+        UpdateInterest(watch.fd);
+    }
+    return id;
+}
+
+void SocketReactor::Cancel(u64 id) {
+    if (const auto sockets = waiters.Remove(id)) {
+        for (const Watch& watch : *sockets) {
+            UpdateInterest(watch.fd);
+        }
+    }
+}
+
+void SocketReactor::Forget(u32 fd) {
+    RetryWaiters(fd);
+
+    // A new socket may get the same descriptor, don't let the remaining waiters see it
+    waiters.ForEach([fd](std::vector<Watch>& sockets) {
+        sockets.erase(std::remove_if(sockets.begin(), sockets.end(),
+                                     [fd](const Watch& watch) { return watch.fd == fd; }),
+                      sockets.end());
+    });
+    Disarm(fd);
+}
+
+void SocketReactor::ReactorThread() {
+#ifdef __linux__
+    if (epoll_fd == -1) {
+        return;
+    }
+
+    std::array<epoll_event, 32> events;
+    while (!stop) {
+        const int count = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (count == -1) {
+            if (errno != EINTR) {
+                LOG_ERROR(Service_SOC, "epoll_wait failed: {}", errno);
+                return;
+            }
+            continue;
+        }
+
+        std::lock_guard lock(mutex);
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.fd != wakeup_fd) {
+                // Sockets are armed one-shot, so each is reported once until it's re-armed
+                ready_sockets.push_back(static_cast<u32>(events[i].data.fd));
+            }
+        }
+    }
+#else
+    std::vector<pollfd> fds;
+    while (!stop) {
+        fds.clear();
+        {
+            std::lock_guard lock(mutex);
+            for (const auto& [fd, events] : interests) {
+                pollfd entry{};
+                entry.fd = fd;
+                entry.events = ((events & Readable) ? POLLIN : 0) |
+                               ((events & Writable) ? POLLOUT : 0);
+                fds.push_back(entry);
+            }
+        }
+
+        if (fds.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(FALLBACK_POLL_TIMEOUT_MS));
+            continue;
+        }
+
+#ifdef _WIN32
+        const int count = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()),
+                                  FALLBACK_POLL_TIMEOUT_MS);
+#else
+        const int count = poll(fds.data(), static_cast<nfds_t>(fds.size()),
+                               FALLBACK_POLL_TIMEOUT_MS);
+#endif
+        if (count <= 0) {
+            continue;
+        }
+
+        std::lock_guard lock(mutex);
+        for (const pollfd& entry : fds) {
+            if (entry.revents != 0) {
+                const u32 fd = static_cast<u32>(entry.fd);
+                // Same one-shot behaviour as the epoll reactor
+                interests.erase(fd);
+                ready_sockets.push_back(fd);
+            }
+        }
+    }
+#endif
+}
+
+void SocketReactor::Dispatch() {
+    std::vector<u32> ready;
+    {
+        std::lock_guard lock(mutex);
+        ready.swap(ready_sockets);
+    }
+    std::sort(ready.begin(), ready.end());
+    ready.erase(std::unique(ready.begin(), ready.end()), ready.end());
+
+    for (const u32 fd : ready) {
+        RetryWaiters(fd);
+        UpdateInterest(fd);
+    }
+}
+
+void SocketReactor::RetryWaiters(u32 fd) {
+    waiters.Retry(
+        [fd](const std::vector<Watch>& sockets) {
+            return std::any_of(sockets.begin(), sockets.end(),
+                               [fd](const Watch& watch) { return watch.fd == fd; });
+        },
+        [this](const std::vector<Watch>& sockets) {
+            for (const Watch& watch : sockets) {
+                UpdateInterest(watch.fd);
+            }
+        });
+}
+
+void SocketReactor::UpdateInterest(u32 fd) {
+    u32 events = 0;
+    waiters.ForEach([fd, &events](const std::vector<Watch>& sockets) {
+        for (const Watch& watch : sockets) {
+            if (watch.fd == fd) {
+                events |= watch.events;
+            }
+        }
+    });
+
+    if (events != 0) {
+        Arm(fd, events);
+    } else {
+        Disarm(fd);
+    }
+}
+
+void SocketReactor::Arm(u32 fd, u32 events) {
+#ifdef __linux__
+    if (epoll_fd == -1) {
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLONESHOT | ((events & Readable) ? EPOLLIN : 0u) |
+                   ((events & Writable) ? EPOLLOUT : 0u);
+    event.data.fd = static_cast<int>(fd);
+    // Sockets stay registered while disabled by EPOLLONESHOT, so re-arming is a modification
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, event.data.fd, &event) == -1 &&
+        (errno != ENOENT || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event.data.fd, &event) == -1)) {
+        LOG_ERROR(Service_SOC, "Failed to watch socket {}: {}", fd, errno);
+    }
+#else
+    std::lock_guard lock(mutex);
+    interests[fd] = events;
+#endif
+}
+
+void SocketReactor::Disarm(u32 fd) {
+#ifdef __linux__
+    if (epoll_fd != -1) {
+        // Fails harmlessly if the socket was never watched or is already closed
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, static_cast<int>(fd), nullptr);
+    }
+#else
+    std::lock_guard lock(mutex);
+    interests.erase(fd);
+#endif
+}
+
+} // namespace Service::SOC
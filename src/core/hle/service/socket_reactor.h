@@ -0,0 +1,86 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/service/waiter_list.h"
+
+namespace Service::SOC {
+
+/**
+ * Waits for host socket readiness on a dedicated thread (epoll on Linux, poll elsewhere) so that
+ * guest operations on blocking sockets never block the emulation thread. Host sockets are always
+ * non-blocking; operations that would block are handed to the reactor and retried on the
+ * emulation thread once one of their sockets becomes ready.
+ */
+class SocketReactor {
+public:
+    static constexpr u32 Readable = 1 << 0;
+    static constexpr u32 Writable = 1 << 1;
+
+    struct Watch {
+        u32 fd;     ///< Host socket
+        u32 events; ///< Readable and/or Writable
+    };
+
+    using Operation = WaiterList<std::vector<Watch>>::Operation;
+
+    explicit SocketReactor(Core::Timing& timing);
+    ~SocketReactor();
+
+    /**
+     * Retries an operation on the emulation thread whenever one of the sockets becomes ready,
+     * until it completes.
+     * @returns an id that can be passed to Cancel
+     */
+    u64 Wait(std::vector<Watch> sockets, Operation operation);
+
+    /// Stops retrying an operation, for example because the guest thread timed out
+    void Cancel(u64 id);
+
+    /// Retries every operation waiting on a socket that was just closed, so that they complete
+    /// with an error, and stops watching it. Operations that still don't complete are only woken
+    /// up by their other sockets or their timeout.
+    void Forget(u32 fd);
+
+private:
+    void ReactorThread();
+
+    /// Runs on the emulation thread, retries the operations of every socket that became ready
+    void Dispatch();
+
+    /// Retries every operation waiting on a socket
+    void RetryWaiters(u32 fd);
+
+    /// Watches a socket for the union of its waiters' events, or stops watching it
+    void UpdateInterest(u32 fd);
+
+    void Arm(u32 fd, u32 events);
+    void Disarm(u32 fd);
+
+    // The sockets every operation waits on
+    WaiterList<std::vector<Watch>> waiters;
+
+    // Shared with the reactor thread
+    std::mutex mutex;
+    std::vector<u32> ready_sockets;
+#ifndef __linux__
+    std::unordered_map<u32, u32> interests;
+#endif
+
+    std::atomic<bool> stop{false};
+#ifdef __linux__
+    int epoll_fd = -1;
+    int wakeup_fd = -1;
+#endif
+    std::thread thread;
+};
+
+} // namespace Service::SOC
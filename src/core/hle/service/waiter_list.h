@@ -0,0 +1,129 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "core/core_timing.h"
+
+namespace Service {
+
+/**
+ * Guest operations that would block, parked while host I/O makes progress on another thread. The
+ * guest threads sleep until their operation completes. A timing event calls the owner's dispatch
+ * function on the emulation thread every interval while operations are waiting, which retries the
+ * operations that may be able to progress.
+ *
+ * @tparam Data what the owner keeps with every operation, for example the sockets it waits on
+ */
+template <typename Data>
+class WaiterList {
+public:
+    /// Retries a guest operation, returns false while it would still block
+    using Operation = std::function<bool()>;
+
+    /**
+     * @param name name of the timing event
+     * @param interval_us how often dispatch is called while operations are waiting
+     * @param dispatch called on the emulation thread, retries the operations that can progress
+     */
+    WaiterList(Core::Timing& timing, const std::string& name, s64 interval_us,
+               std::function<void()> dispatch)
+        : timing(timing), interval_us(interval_us) {
+        event = timing.RegisterEvent(name, [this, dispatch = std::move(dispatch)](u64, s64) {
+            scheduled = false;
+            dispatch();
+            ScheduleDispatch();
+        });
+    }
+
+    ~WaiterList() {
+        timing.RemoveEvent(event);
+    }
+
+    /// Parks an operation, returns an id that can be passed to Remove
+    u64 Add(Data data, Operation operation) {
+        const u64 id = next_id++;
+        waiters.emplace(id, Waiter{std::move(data), std::move(operation)});
+        ScheduleDispatch();
+        return id;
+    }
+
+    /// Stops retrying an operation, returns its data if it was still waiting
+    std::optional<Data> Remove(u64 id) {
+        auto itr = waiters.find(id);
+        if (itr == waiters.end()) {
+            return std::nullopt;
+        }
+        Data data = std::move(itr->second.data);
+        waiters.erase(itr);
+        return data;
+    }
+
+    /**
+     * Retries every operation whose data matches a predicate. Operations that complete are
+     * removed, and their data is passed to on_complete.
+     */
+    template <typename Predicate, typename Completion>
+    void Retry(Predicate&& predicate, Completion&& on_complete) {
+        std::vector<u64> ids;
+        for (const auto& [id, waiter] : waiters) {
+            if (predicate(waiter.data)) {
+                ids.push_back(id);
+            }
+        }
+
+        // Completing an operation wakes its guest thread, which may remove or add other waiters
+        for (const u64 id : ids) {
+            auto itr = waiters.find(id);
+            if (itr == waiters.end()) {
+                continue;
+            }
+            const Operation operation = itr->second.operation;
+            if (operation()) {
+                if (std::optional<Data> data = Remove(id)) {
+                    on_complete(std::move(*data));
+                }
+            }
+        }
+    }
+
+    /// Calls a function with the data of every waiting operation, which it may modify
+    template <typename Function>
+    void ForEach(Function&& function) {
+        for (auto& [id, waiter] : waiters) {
+            function(waiter.data);
+        }
+    }
+
+private:
+    struct Waiter {
+        Data data;
+        Operation operation;
+    };
+
+    void ScheduleDispatch() {
+        if (!waiters.empty() && !scheduled) {
+            timing.ScheduleEvent(usToCycles(interval_us), event);
+            scheduled = true;
+        }
+    }
+
+    Core::Timing& timing;
+    Core::TimingEventType* event;
+    s64 interval_us;
+    bool scheduled = false;
+
+    // Only touched on the emulation thread
+    std::map<u64, Waiter> waiters;
+    u64 next_id = 0;
+};
+
+} // namespace Service
@@ -12,6 +12,7 @@
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/gpu_trace.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
@@ -27,10 +28,17 @@ namespace GPU {
 
 Regs g_regs;
 Memory::MemorySystem* g_memory;
+bool g_signal_interrupts = true;
 
 /// Event ID for CoreTiming
 static Core::TimingEventType* vblank_event;
 
+static void SignalGSPInterrupt(Service::GSP::InterruptId interrupt_id) {
+    if (g_signal_interrupts) {
+        Service::GSP::SignalInterrupt(interrupt_id);
+    }
+}
+
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
     u32 addr = raw_addr - HW::VADDR_GPU;
@@ -390,6 +398,9 @@ inline void Write(u32 addr, const T data) {
         return;
     }
 
+    Core::System::GetInstance().GPUTraceRecorder().RecordRegisterWrite(index,
+                                                                       static_cast<u32>(data));
+
     g_regs[index] = static_cast<u32>(data);
 
     switch (index) {
@@ -409,9 +420,9 @@ inline void Write(u32 addr, const T data) {
             // TODO: hwtest this
             if (config.GetStartAddress() != 0) {
                 if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
+                    SignalGSPInterrupt(Service::GSP::InterruptId::PSC0);
                 } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+                    SignalGSPInterrupt(Service::GSP::InterruptId::PSC1);
                 }
             }
 
@@ -447,7 +458,7 @@ inline void Write(u32 addr, const T data) {
             }
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+            SignalGSPInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -482,6 +493,7 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
+    Core::System::GetInstance().GPUTraceRecorder().RecordFrameEnd();
     VideoCore::g_renderer->SwapBuffers();
 
     // Signal to GSP that GPU interrupt has occurred
@@ -489,8 +501,8 @@ static void VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     // screen, or if both use the same interrupts and these two instead determine the
     // beginning and end of the VBlank period. If needed, split the interrupt firing into
     // two different intervals.
-    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC0);
-    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
+    SignalGSPInterrupt(Service::GSP::InterruptId::PDC0);
+    SignalGSPInterrupt(Service::GSP::InterruptId::PDC1);
 
     // Reschedule recurrent event
     Core::System::GetInstance().CoreTiming().ScheduleEvent(frame_ticks - cycles_late, vblank_event);
@@ -298,6 +298,9 @@ static_assert(sizeof(Regs) == 0x1000 * sizeof(u32), "Invalid total size of regis
 
 extern Regs g_regs;
 
+/// Whether the GPU signals GSP interrupts, disabled while replaying GPU traces
+extern bool g_signal_interrupts;
+
 template <typename T>
 void Read(T& var, const u32 addr);
 
@@ -85,6 +85,11 @@ public:
     RasterizerCacheMarker cache_marker;
     std::vector<PageTable*> page_table_list;
 
+    // Pages whose next write is trapped like a rasterizer-cached page, to mark them dirty
+    RasterizerCacheMarker write_watch_marker;
+    bool dirty_tracking = false;
+    std::vector<bool> dirty_pages; ///< FCRAM pages followed by VRAM pages
+
     AudioCore::DspInterface* dsp = nullptr;
 };
 
@@ -117,9 +122,10 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, u8* memor
 
         page_table.Set(type, base << PAGE_BITS, memory);
 
-        // If the memory to map is already rasterizer-cached, mark the page
-        if (type == PageType::Memory && impl->cache_marker.IsCached(base * PAGE_SIZE)) {
-            page_table.SetRasterizerCachedMemory(base);
+        // If the memory to map is already rasterizer-cached or write watched, mark the page
+        if (type == PageType::Memory && (impl->cache_marker.IsCached(base * PAGE_SIZE) ||
+                                         impl->write_watch_marker.IsCached(base * PAGE_SIZE))) {
+            page_table.SetRasterizerCachedMemory(base * PAGE_SIZE);
             impl->fastmem_mapper.Unmap(page_table, base * PAGE_SIZE, PAGE_SIZE);
         } else if (memory != nullptr) {
             impl->fastmem_mapper.Map(page_table, base * PAGE_SIZE, memory, PAGE_SIZE);
@@ -256,6 +262,10 @@ u8* MemorySystem::GetPointer(const VAddr vaddr) {
     return nullptr;
 }
 
+u8* MemorySystem::GetDirectPointer(const VAddr vaddr) {
+    return impl->current_page_table->Get(vaddr);
+}
+
 std::string MemorySystem::ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -347,37 +357,128 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
     for (unsigned i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
         for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
             impl->cache_marker.Mark(vaddr, cached);
-            for (PageTable* page_table : impl->page_table_list) {
-                PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
-
-                if (cached) {
-                    // Switch page type to cached if now cached
-                    switch (page_type) {
-                    case PageType::Memory:
-                        page_table->SetRasterizerCachedMemory(vaddr);
-                        impl->fastmem_mapper.Unmap(*page_table, vaddr, PAGE_SIZE);
-                        break;
-                    default:
-                        break;
-                    }
-                } else {
-                    // Switch page type to uncached if now uncached
-                    switch (page_type) {
-                    case PageType::RasterizerCachedMemory: {
-                        u8* ptr = GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
-                        page_table->SetMemory(vaddr, ptr);
-                        impl->fastmem_mapper.Map(*page_table, vaddr, ptr, PAGE_SIZE);
-                        break;
-                    }
-                    default:
-                        break;
-                    }
-                }
+            UpdatePageType(vaddr);
+        }
+    }
+}
+
+void MemorySystem::UpdatePageType(VAddr vaddr) {
+    const bool cached =
+        impl->cache_marker.IsCached(vaddr) || impl->write_watch_marker.IsCached(vaddr);
+
+    for (PageTable* page_table : impl->page_table_list) {
+        PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
+
+        if (cached) {
+            // Switch page type to cached if now cached
+            switch (page_type) {
+            case PageType::Memory:
+                page_table->SetRasterizerCachedMemory(vaddr);
+                impl->fastmem_mapper.Unmap(*page_table, vaddr, PAGE_SIZE);
+                break;
+            default:
+                break;
+            }
+        } else {
+            // Switch page type to uncached if now uncached
+            switch (page_type) {
+            case PageType::RasterizerCachedMemory: {
+                u8* ptr = GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
+                page_table->SetMemory(vaddr, ptr);
+                impl->fastmem_mapper.Map(*page_table, vaddr, ptr, PAGE_SIZE);
+                break;
+            }
+            default:
+                break;
             }
         }
     }
 }
 
+/// Returns the index of a physical page in the dirty pages, or -1 if writes to it aren't tracked
+static s64 GetDirtyPageIndex(PAddr addr) {
+    if (addr >= FCRAM_PADDR && addr < FCRAM_PADDR_END) {
+        return (addr - FCRAM_PADDR) / PAGE_SIZE;
+    }
+    if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
+        return FCRAM_SIZE / PAGE_SIZE + (addr - VRAM_PADDR) / PAGE_SIZE;
+    }
+    return -1;
+}
+
+/// Returns the start of a physical page from its index in the dirty pages
+static PAddr GetDirtyPageAddress(std::size_t index) {
+    if (index < FCRAM_SIZE / PAGE_SIZE) {
+        return FCRAM_PADDR + static_cast<PAddr>(index) * PAGE_SIZE;
+    }
+    return VRAM_PADDR + static_cast<PAddr>(index - FCRAM_SIZE / PAGE_SIZE) * PAGE_SIZE;
+}
+
+void MemorySystem::SetDirtyTracking(bool enabled) {
+    if (impl->dirty_tracking == enabled) {
+        return;
+    }
+
+    impl->dirty_tracking = enabled;
+    impl->dirty_pages.assign(enabled ? (FCRAM_SIZE + VRAM_SIZE) / PAGE_SIZE : 0, false);
+
+    for (std::size_t i = 0; i < (FCRAM_SIZE + VRAM_SIZE) / PAGE_SIZE; ++i) {
+        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(GetDirtyPageAddress(i))) {
+            impl->write_watch_marker.Mark(vaddr, enabled);
+            UpdatePageType(vaddr);
+        }
+    }
+}
+
+std::vector<std::pair<PAddr, u32>> MemorySystem::TakeDirtyRegions() {
+    std::vector<std::pair<PAddr, u32>> regions;
+
+    for (std::size_t i = 0; i < impl->dirty_pages.size(); ++i) {
+        if (!impl->dirty_pages[i]) {
+            continue;
+        }
+
+        impl->dirty_pages[i] = false;
+        const PAddr paddr = GetDirtyPageAddress(i);
+        if (!regions.empty() && regions.back().first + regions.back().second == paddr) {
+            regions.back().second += PAGE_SIZE;
+        } else {
+            regions.emplace_back(paddr, PAGE_SIZE);
+        }
+
+        // Trap the next write again
+        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
+            impl->write_watch_marker.Mark(vaddr, true);
+            UpdatePageType(vaddr);
+        }
+    }
+
+    return regions;
+}
+
+void MemorySystem::MarkRegionDirty(PAddr start, u32 size) {
+    if (!impl->dirty_tracking || size == 0) {
+        return;
+    }
+
+    const u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
+    PAddr paddr = start & ~PAGE_MASK;
+
+    for (u32 i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
+        const s64 index = GetDirtyPageIndex(paddr);
+        if (index == -1 || impl->dirty_pages[index]) {
+            continue;
+        }
+
+        // Later writes don't need to be trapped until the page is taken
+        impl->dirty_pages[index] = true;
+        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
+            impl->write_watch_marker.Mark(vaddr, false);
+            UpdatePageType(vaddr);
+        }
+    }
+}
+
 void RasterizerFlushRegion(PAddr start, u32 size) {
     if (VideoCore::g_renderer == nullptr) {
         return;
@@ -431,9 +532,11 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
             break;
         case FlushMode::Invalidate:
             rasterizer->InvalidateRegion(physical_start, overlap_size);
+            Core::System::GetInstance().Memory().MarkRegionDirty(physical_start, overlap_size);
             break;
         case FlushMode::FlushAndInvalidate:
             rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+            Core::System::GetInstance().Memory().MarkRegionDirty(physical_start, overlap_size);
             break;
         }
     };
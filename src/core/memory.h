@@ -8,12 +8,14 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "common/common_types.h"
 #include "common/fastmem_mapper.h"
 
 class ARM_Interface;
 class ARM_Dynarmic;
+class DynarmicUserCallbacks;
 
 namespace AudioCore {
 class DspInterface;
@@ -62,6 +64,7 @@ enum class PageType {
 class PageTable final {
 private:
     friend class ::ARM_Dynarmic;
+    friend class ::DynarmicUserCallbacks;
     friend class ::Common::FastmemMapper;
     friend class ::Memory::MemorySystem;
 
@@ -279,6 +282,12 @@ public:
 
     u8* GetPointer(VAddr vaddr);
 
+    /**
+     * Gets a pointer to the regular memory backing vaddr. Returns nullptr without logging if
+     * accesses to the page have to go through Read/Write (unmapped or rasterizer-cached pages).
+     */
+    u8* GetDirectPointer(VAddr vaddr);
+
     bool IsValidPhysicalAddress(PAddr paddr);
 
     static bool IsValidVirtualAddress(const Kernel::Process& process, VAddr vaddr);
@@ -294,6 +303,18 @@ public:
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Starts or stops tracking which pages of FCRAM and VRAM are written. Tracked are the writes
+     * the rasterizer cache is notified of, that is writes through the linear heaps and VRAM by the
+     * CPU and the memory functions, and regions invalidated with RasterizerFlushVirtualRegion.
+     * Clean pages are mapped like rasterizer-cached pages, so accessing them is slower until the
+     * first write.
+     */
+    void SetDirtyTracking(bool enabled);
+
+    /// Returns the physical regions written since the last call, merging adjacent pages
+    std::vector<std::pair<PAddr, u32>> TakeDirtyRegions();
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(PageTable* page_table);
 
@@ -319,6 +340,14 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    /// Switches the page at vaddr between Memory and RasterizerCachedMemory in every page table
+    void UpdatePageType(VAddr vaddr);
+
+    /// Marks a physical region dirty, called for invalidated regions
+    void MarkRegionDirty(PAddr start, u32 size);
+
+    friend void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
+
     class Impl;
 
     std::unique_ptr<Impl> impl;
@@ -25,8 +25,56 @@ using std::chrono::microseconds;
 // booting that we shouldn't account for
 constexpr std::size_t IgnoreFrames = 5;
 
+/// How long before the deadline precise frame pacing stops sleeping and starts spinning, sleeps
+/// usually wake up less than this late
+constexpr microseconds SPIN_TIME = 2ms;
+
 namespace Core {
 
+DurationHistogram::DurationHistogram(microseconds bucket_width) : bucket_width(bucket_width) {}
+
+void DurationHistogram::AddSample(microseconds duration) {
+    std::lock_guard lock{mutex};
+
+    const std::size_t bucket =
+        duration <= microseconds::zero()
+            ? 0
+            : std::min<std::size_t>(duration / bucket_width, NUM_BUCKETS - 1);
+    ++buckets[bucket];
+    ++sample_count;
+}
+
+void DurationHistogram::Reset() {
+    std::lock_guard lock{mutex};
+
+    buckets.fill(0);
+    sample_count = 0;
+}
+
+std::array<u64, DurationHistogram::NUM_BUCKETS> DurationHistogram::GetBuckets() const {
+    std::lock_guard lock{mutex};
+
+    return buckets;
+}
+
+microseconds DurationHistogram::GetPercentile(double percentile) const {
+    std::lock_guard lock{mutex};
+
+    if (sample_count == 0) {
+        return microseconds::zero();
+    }
+
+    const u64 target = std::max<u64>(static_cast<u64>(sample_count * percentile / 100.0), 1);
+    u64 count = 0;
+    for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+        count += buckets[i];
+        if (count >= target) {
+            return bucket_width * static_cast<microseconds::rep>(i + 1);
+        }
+    }
+    return bucket_width * static_cast<microseconds::rep>(NUM_BUCKETS);
+}
+
 PerfStats::~PerfStats() {
     if (!Settings::values.record_frame_times) {
         return;
@@ -79,6 +127,35 @@ double PerfStats::GetLastFrameTimeScale() const {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+void PerfStats::RecordInputPoll() {
+    std::lock_guard lock{object_mutex};
+
+    if (!first_unpresented_input_poll) {
+        first_unpresented_input_poll = Clock::now();
+    }
+}
+
+void PerfStats::RecordPresent() {
+    std::lock_guard lock{object_mutex};
+
+    if (first_unpresented_input_poll) {
+        input_latency.AddSample(
+            duration_cast<microseconds>(Clock::now() - *first_unpresented_input_poll));
+        first_unpresented_input_poll.reset();
+    }
+}
+
+/// Sleeps until shortly before the deadline and spins until it, as sleeps can wake up a
+/// millisecond or two late
+static void SleepAndSpinUntil(FrameLimiter::Clock::time_point deadline) {
+    if (deadline - FrameLimiter::Clock::now() > SPIN_TIME) {
+        std::this_thread::sleep_until(deadline - SPIN_TIME);
+    }
+    while (FrameLimiter::Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     if (frame_advancing_enabled) {
         // Frame advancing is enabled: wait on event instead of doing framelimiting
@@ -107,8 +184,14 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
         std::clamp(frame_limiting_delta_err, -max_lag_time_us, max_lag_time_us);
 
     if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
+        const Clock::time_point deadline = now + frame_limiting_delta_err;
+        if (Settings::values.precise_frame_pacing) {
+            SleepAndSpinUntil(deadline);
+        } else {
+            std::this_thread::sleep_for(frame_limiting_delta_err);
+        }
         auto now_after_sleep = Clock::now();
+        pacing_error.AddSample(duration_cast<microseconds>(now_after_sleep - deadline));
         frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
         now = now_after_sleep;
     }
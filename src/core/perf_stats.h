@@ -9,11 +9,43 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <optional>
 #include "common/common_types.h"
 #include "common/thread.h"
 
 namespace Core {
 
+/// Counts durations in fixed width buckets, the last bucket also counts the longer durations
+class DurationHistogram {
+public:
+    static constexpr std::size_t NUM_BUCKETS = 64;
+
+    explicit DurationHistogram(std::chrono::microseconds bucket_width);
+
+    void AddSample(std::chrono::microseconds duration);
+    void Reset();
+
+    std::chrono::microseconds GetBucketWidth() const {
+        return bucket_width;
+    }
+
+    /// Returns the number of samples in each bucket
+    std::array<u64, NUM_BUCKETS> GetBuckets() const;
+
+    /**
+     * Returns the upper bound of the bucket that contains the given percentile of the samples.
+     * @param percentile between 0 and 100
+     * @returns 0 if there are no samples
+     */
+    std::chrono::microseconds GetPercentile(double percentile) const;
+
+private:
+    mutable std::mutex mutex;
+    const std::chrono::microseconds bucket_width;
+    std::array<u64, NUM_BUCKETS> buckets{};
+    u64 sample_count = 0;
+};
+
 /**
  * Class to manage and query performance/timing statistics. All public functions of this class are
  * thread-safe unless stated otherwise.
@@ -33,6 +65,24 @@ public:
      */
     double GetLastFrameTimeScale() const;
 
+    /// Called when the HID service polls the input devices
+    void RecordInputPoll();
+
+    /// Called when a frame was presented, after swapping buffers
+    void RecordPresent();
+
+    /**
+     * Returns the time from input polls to the presentation of the first frame after them. Only
+     * the first poll before every frame is counted.
+     */
+    const DurationHistogram& GetInputLatencyHistogram() const {
+        return input_latency;
+    }
+
+    void ResetInputLatencyHistogram() {
+        input_latency.Reset();
+    }
+
 private:
     mutable std::mutex object_mutex;
 
@@ -51,6 +101,11 @@ private:
 
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+
+    /// Point of the first input poll since the previous frame was presented
+    std::optional<Clock::time_point> first_unpresented_input_poll;
+
+    DurationHistogram input_latency{std::chrono::milliseconds(1)};
 };
 
 class FrameLimiter {
@@ -63,6 +118,15 @@ public:
     void AdvanceFrame();
     bool FrameAdvancingEnabled() const;
 
+    /// Returns how late the limiter woke up after every wait, relative to the wanted time
+    const DurationHistogram& GetPacingErrorHistogram() const {
+        return pacing_error;
+    }
+
+    void ResetPacingErrorHistogram() {
+        pacing_error.Reset();
+    }
+
 private:
     /// Emulated system time (in microseconds) at the last limiter invocation
     std::chrono::microseconds previous_system_time_us{0};
@@ -78,6 +142,8 @@ private:
 
     /// Event to advance the frame when frame advancing is enabled
     Common::Event frame_advance_event;
+
+    DurationHistogram pacing_error{std::chrono::microseconds(50)};
 };
 
 } // namespace Core
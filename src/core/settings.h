@@ -136,11 +136,15 @@ struct Values {
     // General
     bool use_cpu_jit = true;
     bool enable_core_2 = false;
+    bool run_cores_on_separate_threads = false;
     bool limit_speed = true;
+    bool precise_frame_pacing = false;
     u16 speed_limit = 100;
     bool use_custom_cpu_ticks = false;
     u64 custom_cpu_ticks = 77;
     u32 cpu_clock_percentage = 100;
+    bool run_cheats_on_vblank = false;
+    u64 cheats_run_interval = 50'000'000; // Luma3DS uses this interval
     s64 core_system_run_default_max_slice_value = BASE_CLOCK_RATE_ARM11 / 234;
     s64 set_slice_length_to_this_in_core_timing_timer_timer = BASE_CLOCK_RATE_ARM11 / 234;
     s64 set_downcount_to_this_in_core_timing_timer_timer = BASE_CLOCK_RATE_ARM11 / 234;
@@ -172,6 +176,8 @@ struct Values {
     bool use_hardware_shader = true;
     bool hardware_shader_accurate_multiplication = false;
     bool enable_disk_shader_cache = false;
+    bool use_uber_shader_while_compiling = false;
+    bool always_use_uber_shader = false;
     bool use_shader_jit = true;
     bool enable_vsync = false;
     bool dump_textures = false;
@@ -186,6 +192,7 @@ struct Values {
     float background_color_blue = 0.0f;
     std::string post_processing_shader = "none (builtin)";
     std::string texture_filter = "none";
+    bool cache_filtered_textures = false;
     StereoRenderOption render_3d = StereoRenderOption::Off;
     std::atomic<u8> factor_3d{0};
 
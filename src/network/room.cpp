@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <mutex>
 #include <random>
@@ -41,6 +42,9 @@ public:
 
     std::atomic<bool> run{true};
 
+    /// Milliseconds enet_host_service waits for an event
+    enet_uint32 service_timeout = 50;
+
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> room_thread;
 
@@ -48,6 +52,9 @@ public:
     void ServerLoop();
     void StartLoop();
 
+    /// Handles a received event, the packets forwarded by the handlers are sent by ServerLoop
+    void HandleEvent(ENetEvent& event);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -90,9 +97,11 @@ public:
 
     /**
      * Broadcasts this packet to all members except the sender.
+     * The received ENet packet is forwarded as is, without copying it.
      * @param event The ENet event containing the data
+     * @returns true if the packet was queued for sending, ENet destroys it after it's sent then
      */
-    void HandleWifiPacket(const ENetEvent* event);
+    bool HandleWifiPacket(const ENetEvent* event);
 
     /**
      * Extracts a chat entry from a received ENet packet and adds it to the chat queue.
@@ -117,40 +126,59 @@ public:
 void Room::RoomImpl::ServerLoop() {
     while (run) {
         ENetEvent event;
-        if (enet_host_service(server, &event, 50) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                default:
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+        int result = enet_host_service(server, &event, service_timeout);
+
+        // Handle every event that was already received before flushing, so that the packets
+        // queued for a member in the meantime are sent together
+        while (result > 0) {
+            HandleEvent(event);
+            result = enet_host_check_events(server, &event);
         }
+
+        enet_host_flush(server);
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::HandleEvent(ENetEvent& event) {
+    switch (event.type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        if (event.packet->dataLength == 0) {
+            enet_packet_destroy(event.packet);
+            break;
+        }
+
+        switch (event.packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(&event);
+            break;
+        case IdSetGameInfo:
+            HandleGameNamePacket(&event);
+            break;
+        case IdWifiPacket:
+            if (HandleWifiPacket(&event)) {
+                // Owned by ENet now
+                return;
+            }
+            break;
+        case IdChatMessage:
+            HandleChatPacket(&event);
+            break;
+        default:
+            break;
+        }
+        enet_packet_destroy(event.packet);
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event.peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
@@ -281,48 +309,39 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
     return result_mac;
 }
 
-void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
-    MacAddress destination_address;
-    in_packet >> destination_address;
+bool Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
+    // Message type, WifiPacket Type, WifiPacket Channel, WifiPacket Transmitter Address
+    constexpr std::size_t destination_address_offset = 3 * sizeof(u8) + sizeof(MacAddress);
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < destination_address_offset + sizeof(MacAddress)) {
+        return false;
+    }
+
+    MacAddress destination_address;
+    std::memcpy(destination_address.data(), enet_packet->data + destination_address_offset,
+                sizeof(MacAddress));
 
+    // The packet was received reliably, so it's also forwarded reliably
+    bool sent_packet = false;
+    std::lock_guard lock(member_mutex);
     if (destination_address ==
         BROADCAST_MAC_ADDRESS) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+                sent_packet |= enet_peer_send(member.peer, 0, enet_packet) == 0;
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
         auto member = std::find_if(members.begin(), members.end(),
                                    [destination_address](const Member& member) -> bool {
                                        return member.mac_address == destination_address;
                                    });
         if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
-        } else {
-            enet_packet_destroy(enet_packet);
+            sent_packet = enet_peer_send(member->peer, 0, enet_packet) == 0;
         }
     }
-    enet_host_flush(server);
+    return sent_packet;
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -410,7 +429,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
 }
 
 // Room
-Room::Room(const std::string& ip, u16 port, const u32 member_slots)
+Room::Room(const std::string& ip, u16 port, const u32 member_slots, bool low_latency)
     : room_impl(std::make_unique<RoomImpl>()) {
     ENetAddress address;
     enet_address_set_host(&address, ip.c_str());
@@ -425,17 +444,24 @@ Room::Room(const std::string& ip, u16 port, const u32 member_slots)
 
     room_impl->room_information.member_slots = member_slots;
     room_impl->room_information.port = port;
+    room_impl->service_timeout = low_latency ? 1 : 50;
 
     room_impl->StartLoop();
 }
 
 Room::~Room() {
     room_impl->run = false;
-    room_impl->room_thread->join();
+    if (room_impl->room_thread) {
+        room_impl->room_thread->join();
+    }
 
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
     }
 }
 
+bool Room::IsOpen() const {
+    return room_impl->server != nullptr;
+}
+
 } // namespace Network
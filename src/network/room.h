@@ -15,8 +15,17 @@ namespace Network {
 
 class Room {
 public:
+    /**
+     * Creates a room and starts its server thread.
+     * @param low_latency if true, the server thread wakes up every millisecond instead of every
+     * 50 milliseconds when idle, so that ENet acknowledges and resends packets sooner at the cost
+     * of some CPU time
+     */
     explicit Room(const std::string& ip = "0.0.0.0", u16 port = DEFAULT_PORT,
-                  const u32 member_slots = DEFAULT_MEMBER_SLOTS);
+                  const u32 member_slots = DEFAULT_MEMBER_SLOTS, bool low_latency = false);
+
+    /// Returns true if the room's ENet host was created
+    bool IsOpen() const;
     ~Room();
 
 private:
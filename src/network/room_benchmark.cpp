@@ -0,0 +1,219 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "enet/enet.h"
+#include "network/packet.h"
+#include "network/room.h"
+#include "network/room_benchmark.h"
+#include "network/room_member.h"
+
+namespace Network {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Offset of the payload in a Wi-Fi packet, after the message type, the WifiPacket type, channel,
+/// transmitter and destination addresses, and the payload size
+constexpr std::size_t WIFI_PAYLOAD_OFFSET = 3 * sizeof(u8) + 2 * sizeof(MacAddress) + sizeof(u32);
+
+constexpr u32 TIMEOUT_MS = 5000;
+
+struct BenchmarkMember {
+    ENetHost* host = nullptr;
+    ENetPeer* peer = nullptr;
+    MacAddress mac_address{};
+};
+
+void Send(BenchmarkMember& member, const Packet& packet) {
+    ENetPacket* enet_packet =
+        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(member.peer, 0, enet_packet);
+    enet_host_flush(member.host);
+}
+
+bool Join(BenchmarkMember& member, u16 port, u32 index) {
+    member.host = enet_host_create(nullptr, 1, 1, 0, 0);
+    if (member.host == nullptr) {
+        return false;
+    }
+
+    ENetAddress address;
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = port;
+    member.peer = enet_host_connect(member.host, &address, 1, 0);
+    if (member.peer == nullptr) {
+        return false;
+    }
+
+    ENetEvent event;
+    if (enet_host_service(member.host, &event, TIMEOUT_MS) <= 0 ||
+        event.type != ENET_EVENT_TYPE_CONNECT) {
+        return false;
+    }
+
+    Packet packet;
+    packet << static_cast<u8>(IdJoinRequest);
+    packet << "member " + std::to_string(index); // nickname
+    Send(member, packet);
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(TIMEOUT_MS);
+    while (Clock::now() < deadline) {
+        if (enet_host_service(member.host, &event, 100) <= 0) {
+            continue;
+        }
+
+        if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
+            return false;
+        }
+
+        if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+            continue;
+        }
+
+        bool joined = false;
+        if (event.packet->dataLength != 0 && event.packet->data[0] == IdJoinSuccess) {
+            Packet in_packet;
+            in_packet.Append(event.packet->data, event.packet->dataLength);
+            in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
+            in_packet >> member.mac_address;
+            joined = true;
+        }
+        enet_packet_destroy(event.packet);
+
+        if (joined) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+std::optional<RoomBenchmarkResult> BenchmarkRoom(u16 port, u32 member_count, u32 rounds,
+                                                 std::size_t payload_size, bool low_latency) {
+    if (member_count < 2) {
+        LOG_ERROR(Network, "At least 2 members are needed");
+        return std::nullopt;
+    }
+
+    Room room("127.0.0.1", port, member_count, low_latency);
+    if (!room.IsOpen()) {
+        LOG_ERROR(Network, "Failed to create the room");
+        return std::nullopt;
+    }
+
+    std::vector<BenchmarkMember> members(member_count);
+    SCOPE_EXIT({
+        for (BenchmarkMember& member : members) {
+            if (member.peer != nullptr) {
+                enet_peer_disconnect_now(member.peer, 0);
+            }
+            if (member.host != nullptr) {
+                enet_host_destroy(member.host);
+            }
+        }
+    });
+
+    for (u32 i = 0; i < member_count; ++i) {
+        if (!Join(members[i], port, i)) {
+            LOG_ERROR(Network, "Member {} failed to join the room", i);
+            return std::nullopt;
+        }
+    }
+
+    WifiPacket wifi_packet{};
+    wifi_packet.type = WifiPacket::PacketType::Data;
+    wifi_packet.data.resize(std::max(payload_size, sizeof(s64)));
+    wifi_packet.destination_address = BROADCAST_MAC_ADDRESS;
+
+    const u64 copies_per_round = static_cast<u64>(member_count) * (member_count - 1);
+    std::vector<std::chrono::nanoseconds> latencies;
+    latencies.reserve(rounds * copies_per_round);
+
+    RoomBenchmarkResult result;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point end = start;
+
+    for (u32 round = 0; round < rounds; ++round) {
+        for (BenchmarkMember& member : members) {
+            const s64 now = Clock::now().time_since_epoch().count();
+            std::memcpy(wifi_packet.data.data(), &now, sizeof(now));
+
+            Packet packet;
+            packet << static_cast<u8>(IdWifiPacket);
+            packet << static_cast<u8>(wifi_packet.type);
+            packet << wifi_packet.channel;
+            packet << member.mac_address;
+            packet << wifi_packet.destination_address;
+            packet << wifi_packet.data;
+            Send(member, packet);
+            ++result.packets_sent;
+        }
+
+        u64 received = 0;
+        const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(TIMEOUT_MS);
+        while (received < copies_per_round && Clock::now() < deadline) {
+            bool idle = true;
+
+            for (BenchmarkMember& member : members) {
+                ENetEvent event;
+                while (enet_host_service(member.host, &event, 0) > 0) {
+                    idle = false;
+                    if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+                        continue;
+                    }
+
+                    const Clock::time_point now = Clock::now();
+                    const ENetPacket* enet_packet = event.packet;
+                    if (enet_packet->dataLength >= WIFI_PAYLOAD_OFFSET + sizeof(s64) &&
+                        enet_packet->data[0] == IdWifiPacket) {
+                        s64 sent;
+                        std::memcpy(&sent, enet_packet->data + WIFI_PAYLOAD_OFFSET, sizeof(sent));
+                        latencies.push_back(now - Clock::time_point(Clock::duration(sent)));
+                        end = now;
+                        ++received;
+                    }
+                    enet_packet_destroy(event.packet);
+                }
+            }
+
+            if (idle) {
+                std::this_thread::yield();
+            }
+        }
+
+        result.packets_received += received;
+        if (received < copies_per_round) {
+            LOG_ERROR(Network, "Only {} of {} packets were received in round {}", received,
+                      copies_per_round, round);
+            break;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    if (result.seconds > 0.0) {
+        result.packets_per_second = result.packets_received / result.seconds;
+    }
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.latency_min = latencies.front();
+        result.latency_median = latencies[latencies.size() / 2];
+        result.latency_99th_percentile = latencies[latencies.size() * 99 / 100];
+        result.latency_max = latencies.back();
+    }
+
+    return result;
+}
+
+} // namespace Network
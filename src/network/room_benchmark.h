@@ -0,0 +1,36 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include "common/common_types.h"
+
+namespace Network {
+
+struct RoomBenchmarkResult {
+    u64 packets_sent = 0;            ///< Wi-Fi packets sent by the members
+    u64 packets_received = 0;        ///< Copies of them received from the room
+    double seconds = 0.0;            ///< Time from the first send to the last receive
+    double packets_per_second = 0.0; ///< Received packets per second
+
+    // Time from sending a packet to a member receiving its copy
+    std::chrono::nanoseconds latency_min{};
+    std::chrono::nanoseconds latency_median{};
+    std::chrono::nanoseconds latency_99th_percentile{};
+    std::chrono::nanoseconds latency_max{};
+};
+
+/**
+ * Loopback load generator for Room. Creates a room on 127.0.0.1, joins it with member_count ENet
+ * clients, and has every member broadcast a Wi-Fi packet of payload_size bytes in each of rounds
+ * rounds, waiting for all copies of a round to arrive before starting the next one.
+ * @returns std::nullopt if the room couldn't be created or a member couldn't join
+ */
+std::optional<RoomBenchmarkResult> BenchmarkRoom(u16 port, u32 member_count, u32 rounds,
+                                                 std::size_t payload_size, bool low_latency);
+
+} // namespace Network
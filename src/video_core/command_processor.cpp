@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <bitset>
 #include <cstddef>
 #include <cstring>
 #include <memory>
@@ -109,6 +111,352 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
+/// Returns whether the register streams data into a lookup table, in which case writing the same
+/// value again still changes state
+static bool IsLutDataRegister(u32 id) {
+    const auto in_range = [id](u32 first, u32 count) { return id >= first && id < first + count; };
+    return in_range(PICA_REG_INDEX(lighting.lut_data[0]), 8) ||
+           in_range(PICA_REG_INDEX(texturing.fog_lut_data[0]), 8) ||
+           in_range(PICA_REG_INDEX(texturing.proctex_lut_data[0]), 8);
+}
+
+// Registers whose change wasn't reported to the rasterizer yet, in the order they first changed
+static std::bitset<Regs::NUM_REGS> pending_notifications;
+static std::array<u16, Regs::NUM_REGS> pending_notification_ids;
+static std::size_t pending_notification_count = 0;
+
+/**
+ * Reports a register change to the rasterizer. Changes are only reported once per register before
+ * the next draw (or the end of the command list), as the rasterizer only needs them when drawing.
+ * Lookup table data is reported right away, as which table changed depends on other registers.
+ */
+static void NotifyRegisterChanged(u32 id) {
+    if (IsLutDataRegister(id)) {
+        VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+        return;
+    }
+
+    if (!pending_notifications.test(id)) {
+        pending_notifications.set(id);
+        pending_notification_ids[pending_notification_count++] = static_cast<u16>(id);
+    }
+}
+
+/// Reports the register changes queued by NotifyRegisterChanged to the rasterizer
+static void FlushRegisterNotifications() {
+    if (pending_notification_count == 0) {
+        return;
+    }
+
+    VideoCore::RasterizerInterface* rasterizer = VideoCore::g_renderer->Rasterizer();
+    for (std::size_t i = 0; i < pending_notification_count; ++i) {
+        rasterizer->NotifyPicaRegisterChanged(pending_notification_ids[i]);
+    }
+    pending_notifications.reset();
+    pending_notification_count = 0;
+}
+
+static void WriteDefaultAttribute(u32 value) {
+    auto& regs = g_state.regs;
+
+    // TODO: Does actual hardware indeed keep an intermediate buffer or does
+    //       it directly write the values?
+    g_state.default_attr_write_buffer[g_state.default_attr_counter++] = value;
+
+    // Default attributes are written in a packed format such that four float24 values are
+    // encoded in
+    // three 32-bit numbers. We write to internal memory once a full such vector is
+    // written.
+    if (g_state.default_attr_counter >= 3) {
+        g_state.default_attr_counter = 0;
+
+        auto& setup = regs.pipeline.vs_default_attributes_setup;
+
+        if (setup.index >= 16) {
+            LOG_ERROR(HW_GPU, "Invalid VS default attribute index {}", (int)setup.index);
+            return;
+        }
+
+        Common::Vec4<float24> attribute;
+
+        // NOTE: The destination component order indeed is "backwards"
+        attribute.w = float24::FromRaw(g_state.default_attr_write_buffer[0] >> 8);
+        attribute.z = float24::FromRaw(((g_state.default_attr_write_buffer[0] & 0xFF) << 16) |
+                                       ((g_state.default_attr_write_buffer[1] >> 16) & 0xFFFF));
+        attribute.y = float24::FromRaw(((g_state.default_attr_write_buffer[1] & 0xFFFF) << 8) |
+                                       ((g_state.default_attr_write_buffer[2] >> 24) & 0xFF));
+        attribute.x = float24::FromRaw(g_state.default_attr_write_buffer[2] & 0xFFFFFF);
+
+        LOG_TRACE(HW_GPU, "Set default VS attribute {:x} to ({} {} {} {})", (int)setup.index,
+                  attribute.x.ToFloat32(), attribute.y.ToFloat32(), attribute.z.ToFloat32(),
+                  attribute.w.ToFloat32());
+
+        // TODO: Verify that this actually modifies the register!
+        if (setup.index < 15) {
+            g_state.input_default_attributes.attr[setup.index] = attribute;
+            setup.index++;
+        } else {
+            // Put each attribute into an immediate input buffer.  When all specified immediate
+            // attributes are present, the Vertex Shader is invoked and everything is sent to
+            // the primitive assembler.
+
+            auto& immediate_input = g_state.immediate.input_vertex;
+            auto& immediate_attribute_id = g_state.immediate.current_attribute;
+
+            immediate_input.attr[immediate_attribute_id] = attribute;
+
+            if (immediate_attribute_id < regs.pipeline.max_input_attrib_index) {
+                immediate_attribute_id += 1;
+            } else {
+                immediate_attribute_id = 0;
+
+                Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
+
+                auto* shader_engine = Shader::GetEngine();
+                shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
+
+                // Send to vertex shader
+                Shader::UnitState shader_unit;
+                Shader::AttributeBuffer output{};
+
+                shader_unit.LoadInput(regs.vs, immediate_input);
+                shader_engine->Run(g_state.vs, shader_unit);
+                shader_unit.WriteOutput(regs.vs, output);
+
+                // Send to geometry pipeline
+                if (g_state.immediate.reset_geometry_pipeline) {
+                    g_state.geometry_pipeline.Reconfigure();
+                    g_state.immediate.reset_geometry_pipeline = false;
+                }
+                ASSERT(!g_state.geometry_pipeline.NeedIndexInput());
+                g_state.geometry_pipeline.Setup(shader_engine);
+                g_state.geometry_pipeline.SubmitVertex(output);
+
+                // The rasterizer merges these until a drawing config register changes
+                FlushRegisterNotifications();
+                VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+            }
+        }
+    }
+}
+
+// Registers that stream data into the shader setup, the default attributes or a lookup table, with
+// each write. These are written thousands of times per frame, in long runs, so they are handled a
+// run at a time. The handlers only use the written values, not the register array.
+
+static void WriteDefaultAttributes(const u32* values, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        WriteDefaultAttribute(values[i]);
+    }
+}
+
+static void WriteGSFloatUniforms(const u32* values, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        WriteUniformFloatReg(g_state.regs.gs, g_state.gs, g_state.gs_float_regs_counter,
+                             g_state.gs_uniform_write_buffer, values[i]);
+    }
+}
+
+static void WriteGSProgram(const u32* values, u32 count) {
+    u32& offset = g_state.regs.gs.program.offset;
+    for (u32 i = 0; i < count; ++i) {
+        if (offset >= 4096) {
+            LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
+        } else {
+            g_state.gs.program_code[offset] = values[i];
+            g_state.gs.MarkProgramCodeDirty();
+            offset++;
+        }
+    }
+}
+
+static void WriteGSSwizzlePatterns(const u32* values, u32 count) {
+    u32& offset = g_state.regs.gs.swizzle_patterns.offset;
+    for (u32 i = 0; i < count; ++i) {
+        if (offset >= g_state.gs.swizzle_data.size()) {
+            LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
+        } else {
+            g_state.gs.swizzle_data[offset] = values[i];
+            g_state.gs.MarkSwizzleDataDirty();
+            offset++;
+        }
+    }
+}
+
+static void WriteVSFloatUniforms(const u32* values, u32 count) {
+    // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
+    for (u32 i = 0; i < count; ++i) {
+        WriteUniformFloatReg(g_state.regs.vs, g_state.vs, g_state.vs_float_regs_counter,
+                             g_state.vs_uniform_write_buffer, values[i]);
+    }
+}
+
+static void WriteVSProgram(const u32* values, u32 count) {
+    u32& offset = g_state.regs.vs.program.offset;
+    const bool write_gs = !g_state.regs.pipeline.gs_unit_exclusive_configuration;
+    for (u32 i = 0; i < count; ++i) {
+        if (offset >= 512) {
+            LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
+        } else {
+            g_state.vs.program_code[offset] = values[i];
+            g_state.vs.MarkProgramCodeDirty();
+            if (write_gs) {
+                g_state.gs.program_code[offset] = values[i];
+                g_state.gs.MarkProgramCodeDirty();
+            }
+            offset++;
+        }
+    }
+}
+
+static void WriteVSSwizzlePatterns(const u32* values, u32 count) {
+    u32& offset = g_state.regs.vs.swizzle_patterns.offset;
+    const bool write_gs = !g_state.regs.pipeline.gs_unit_exclusive_configuration;
+    for (u32 i = 0; i < count; ++i) {
+        if (offset >= g_state.vs.swizzle_data.size()) {
+            LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
+        } else {
+            g_state.vs.swizzle_data[offset] = values[i];
+            g_state.vs.MarkSwizzleDataDirty();
+            if (write_gs) {
+                g_state.gs.swizzle_data[offset] = values[i];
+                g_state.gs.MarkSwizzleDataDirty();
+            }
+            offset++;
+        }
+    }
+}
+
+static void WriteLightingLut(const u32* values, u32 count) {
+    auto& lut_config = g_state.regs.lighting.lut_config;
+    auto& lut = g_state.lighting.luts[lut_config.type];
+    for (u32 i = 0; i < count; ++i) {
+        ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
+
+        lut[lut_config.index].raw = values[i];
+        lut_config.index.Assign(lut_config.index + 1);
+    }
+}
+
+static void WriteFogLut(const u32* values, u32 count) {
+    auto& offset = g_state.regs.texturing.fog_lut_offset;
+    for (u32 i = 0; i < count; ++i) {
+        g_state.fog.lut[offset % 128].raw = values[i];
+        offset.Assign(offset + 1);
+    }
+}
+
+template <typename Table>
+static void WriteProcTexLut(Table& table, const u32* values, u32 count) {
+    auto& index = g_state.regs.texturing.proctex_lut_config.index;
+    for (u32 i = 0; i < count; ++i) {
+        table[index % table.size()].raw = values[i];
+        index.Assign(index + 1);
+    }
+}
+
+static void WriteProcTexLut(const u32* values, u32 count) {
+    auto& pt = g_state.proctex;
+
+    switch (g_state.regs.texturing.proctex_lut_config.ref_table.Value()) {
+    case TexturingRegs::ProcTexLutTable::Noise:
+        WriteProcTexLut(pt.noise_table, values, count);
+        break;
+    case TexturingRegs::ProcTexLutTable::ColorMap:
+        WriteProcTexLut(pt.color_map_table, values, count);
+        break;
+    case TexturingRegs::ProcTexLutTable::AlphaMap:
+        WriteProcTexLut(pt.alpha_map_table, values, count);
+        break;
+    case TexturingRegs::ProcTexLutTable::Color:
+        WriteProcTexLut(pt.color_table, values, count);
+        break;
+    case TexturingRegs::ProcTexLutTable::ColorDiff:
+        WriteProcTexLut(pt.color_diff_table, values, count);
+        break;
+    default:
+        // The index is still incremented
+        auto& index = g_state.regs.texturing.proctex_lut_config.index;
+        index.Assign(index + count);
+        break;
+    }
+}
+
+using StreamWriteHandler = void (*)(const u32* values, u32 count);
+
+/// Handler of every stream register, nullptr for the other registers
+static const std::array<StreamWriteHandler, Regs::NUM_REGS> stream_write_handlers = [] {
+    std::array<StreamWriteHandler, Regs::NUM_REGS> handlers{};
+    const auto set = [&handlers](u32 first, u32 count, StreamWriteHandler handler) {
+        std::fill_n(handlers.begin() + first, count, handler);
+    };
+
+    set(PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[0]), 3,
+        WriteDefaultAttributes);
+    set(PICA_REG_INDEX(gs.uniform_setup.set_value[0]), 8, WriteGSFloatUniforms);
+    set(PICA_REG_INDEX(gs.program.set_word[0]), 8, WriteGSProgram);
+    set(PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]), 8, WriteGSSwizzlePatterns);
+    set(PICA_REG_INDEX(vs.uniform_setup.set_value[0]), 8, WriteVSFloatUniforms);
+    set(PICA_REG_INDEX(vs.program.set_word[0]), 8, WriteVSProgram);
+    set(PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]), 8, WriteVSSwizzlePatterns);
+    set(PICA_REG_INDEX(lighting.lut_data[0]), 8, WriteLightingLut);
+    set(PICA_REG_INDEX(texturing.fog_lut_data[0]), 8, WriteFogLut);
+    set(PICA_REG_INDEX(texturing.proctex_lut_data[0]), 8, WriteProcTexLut);
+    return handlers;
+}();
+
+/**
+ * Writes a run of values to stream registers that share handler. The values go to id if grouped
+ * is false, else to id, id + 1, ... like the values of a command with group_commands set. The
+ * rasterizer is notified once for every register of the run that changed.
+ */
+static void WriteStreamRegisters(StreamWriteHandler handler, u32 id, const u32* values, u32 count,
+                                 u32 mask, bool grouped) {
+    auto& regs = g_state.regs;
+    const u32 write_mask = expand_bits_to_bytes[mask];
+    VideoCore::RasterizerInterface* rasterizer = VideoCore::g_renderer->Rasterizer();
+
+    // Bit i is set if register id + i changed. Grouped runs don't leave a stream's register group,
+    // and no group has more than 8 registers.
+    u32 changed_registers = 0;
+
+    if (grouped) {
+        ASSERT(count <= 32);
+        for (u32 i = 0; i < count; ++i) {
+            u32& reg = regs.reg_array[id + i];
+            if (IsLutDataRegister(id + i) || ((reg ^ values[i]) & write_mask) != 0) {
+                rasterizer->NotifyPicaRegisterChanging(id + i);
+                changed_registers |= 1U << i;
+            }
+            reg = (reg & ~write_mask) | (values[i] & write_mask);
+        }
+    } else {
+        u32& reg = regs.reg_array[id];
+        u32 value = reg;
+        for (u32 i = 0; i < count; ++i) {
+            if (((value ^ values[i]) & write_mask) != 0) {
+                changed_registers = 1;
+            }
+            value = (value & ~write_mask) | (values[i] & write_mask);
+        }
+        if (IsLutDataRegister(id)) {
+            changed_registers = 1;
+        }
+        if (changed_registers != 0) {
+            rasterizer->NotifyPicaRegisterChanging(id);
+        }
+        reg = value;
+    }
+
+    handler(values, count);
+
+    for (u32 i = 0; changed_registers != 0; ++i, changed_registers >>= 1) {
+        if (changed_registers & 1) {
+            NotifyRegisterChanged(id + i);
+        }
+    }
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -120,16 +468,31 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         return;
     }
 
+    if (const StreamWriteHandler handler = stream_write_handlers[id]) {
+        WriteStreamRegisters(handler, id, &value, 1, mask, false);
+        return;
+    }
+
     // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
     u32 old_value = regs.reg_array[id];
 
     const u32 write_mask = expand_bits_to_bytes[mask];
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
 
-    regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    // Games rewrite most of their configuration for every draw. Only tell the rasterizer about
+    // writes that change something so it can keep batching.
+    const bool notify_rasterizer = new_value != old_value || IsLutDataRegister(id);
+    if (notify_rasterizer) {
+        VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanging(id);
+    }
+
+    regs.reg_array[id] = new_value;
 
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
+        FlushRegisterNotifications();
+        VideoCore::g_renderer->Rasterizer()->FlushTriangles();
         Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
         break;
 
@@ -147,93 +510,6 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         g_state.default_attr_counter = 0;
         break;
 
-    // Load default vertex input attributes
-    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[0]):
-    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[1]):
-    case PICA_REG_INDEX(pipeline.vs_default_attributes_setup.set_value[2]): {
-        // TODO: Does actual hardware indeed keep an intermediate buffer or does
-        //       it directly write the values?
-        g_state.default_attr_write_buffer[g_state.default_attr_counter++] = value;
-
-        // Default attributes are written in a packed format such that four float24 values are
-        // encoded in
-        // three 32-bit numbers. We write to internal memory once a full such vector is
-        // written.
-        if (g_state.default_attr_counter >= 3) {
-            g_state.default_attr_counter = 0;
-
-            auto& setup = regs.pipeline.vs_default_attributes_setup;
-
-            if (setup.index >= 16) {
-                LOG_ERROR(HW_GPU, "Invalid VS default attribute index {}", (int)setup.index);
-                break;
-            }
-
-            Common::Vec4<float24> attribute;
-
-            // NOTE: The destination component order indeed is "backwards"
-            attribute.w = float24::FromRaw(g_state.default_attr_write_buffer[0] >> 8);
-            attribute.z = float24::FromRaw(((g_state.default_attr_write_buffer[0] & 0xFF) << 16) |
-                                           ((g_state.default_attr_write_buffer[1] >> 16) & 0xFFFF));
-            attribute.y = float24::FromRaw(((g_state.default_attr_write_buffer[1] & 0xFFFF) << 8) |
-                                           ((g_state.default_attr_write_buffer[2] >> 24) & 0xFF));
-            attribute.x = float24::FromRaw(g_state.default_attr_write_buffer[2] & 0xFFFFFF);
-
-            LOG_TRACE(HW_GPU, "Set default VS attribute {:x} to ({} {} {} {})", (int)setup.index,
-                      attribute.x.ToFloat32(), attribute.y.ToFloat32(), attribute.z.ToFloat32(),
-                      attribute.w.ToFloat32());
-
-            // TODO: Verify that this actually modifies the register!
-            if (setup.index < 15) {
-                g_state.input_default_attributes.attr[setup.index] = attribute;
-                setup.index++;
-            } else {
-                // Put each attribute into an immediate input buffer.  When all specified immediate
-                // attributes are present, the Vertex Shader is invoked and everything is sent to
-                // the primitive assembler.
-
-                auto& immediate_input = g_state.immediate.input_vertex;
-                auto& immediate_attribute_id = g_state.immediate.current_attribute;
-
-                immediate_input.attr[immediate_attribute_id] = attribute;
-
-                if (immediate_attribute_id < regs.pipeline.max_input_attrib_index) {
-                    immediate_attribute_id += 1;
-                } else {
-                    immediate_attribute_id = 0;
-
-                    Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
-
-                    auto* shader_engine = Shader::GetEngine();
-                    shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
-
-                    // Send to vertex shader
-                    Shader::UnitState shader_unit;
-                    Shader::AttributeBuffer output{};
-
-                    shader_unit.LoadInput(regs.vs, immediate_input);
-                    shader_engine->Run(g_state.vs, shader_unit);
-                    shader_unit.WriteOutput(regs.vs, output);
-
-                    // Send to geometry pipeline
-                    if (g_state.immediate.reset_geometry_pipeline) {
-                        g_state.geometry_pipeline.Reconfigure();
-                        g_state.immediate.reset_geometry_pipeline = false;
-                    }
-                    ASSERT(!g_state.geometry_pipeline.NeedIndexInput());
-                    g_state.geometry_pipeline.Setup(shader_engine);
-                    g_state.geometry_pipeline.SubmitVertex(output);
-
-                    // TODO: If drawing after every immediate mode triangle kills performance,
-                    // change it to flush triangles whenever a drawing config register changes
-                    // See: https://github.com/citra-emu/citra/pull/2866#issuecomment-327011550
-                    VideoCore::g_renderer->Rasterizer()->DrawTriangles();
-                }
-            }
-        }
-        break;
-    }
-
     case PICA_REG_INDEX(pipeline.gpu_mode):
         // This register likely just enables vertex processing and doesn't need any special handling
         break;
@@ -252,6 +528,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     // It seems like these trigger vertex rendering
     case PICA_REG_INDEX(pipeline.trigger_draw):
     case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
+        FlushRegisterNotifications();
+
         PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = g_state.primitive_assembler;
 
         bool accelerate_draw =
@@ -275,6 +553,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         if (accelerate_draw &&
             VideoCore::g_renderer->Rasterizer()->AccelerateDrawBatch(is_indexed)) {
+            if (VideoCore::g_draw_callback) {
+                VideoCore::g_draw_callback();
+            }
             break;
         }
 
@@ -381,57 +662,6 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
     }
 
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[0]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[1]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[2]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[3]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[4]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[5]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[6]):
-    case PICA_REG_INDEX(gs.uniform_setup.set_value[7]): {
-        WriteUniformFloatReg(g_state.regs.gs, g_state.gs, g_state.gs_float_regs_counter,
-                             g_state.gs_uniform_write_buffer, value);
-        break;
-    }
-
-    case PICA_REG_INDEX(gs.program.set_word[0]):
-    case PICA_REG_INDEX(gs.program.set_word[1]):
-    case PICA_REG_INDEX(gs.program.set_word[2]):
-    case PICA_REG_INDEX(gs.program.set_word[3]):
-    case PICA_REG_INDEX(gs.program.set_word[4]):
-    case PICA_REG_INDEX(gs.program.set_word[5]):
-    case PICA_REG_INDEX(gs.program.set_word[6]):
-    case PICA_REG_INDEX(gs.program.set_word[7]): {
-        u32& offset = g_state.regs.gs.program.offset;
-        if (offset >= 4096) {
-            LOG_ERROR(HW_GPU, "Invalid GS program offset {}", offset);
-        } else {
-            g_state.gs.program_code[offset] = value;
-            g_state.gs.MarkProgramCodeDirty();
-            offset++;
-        }
-        break;
-    }
-
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[0]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[1]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[2]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[3]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[4]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[5]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[6]):
-    case PICA_REG_INDEX(gs.swizzle_patterns.set_word[7]): {
-        u32& offset = g_state.regs.gs.swizzle_patterns.offset;
-        if (offset >= g_state.gs.swizzle_data.size()) {
-            LOG_ERROR(HW_GPU, "Invalid GS swizzle pattern offset {}", offset);
-        } else {
-            g_state.gs.swizzle_data[offset] = value;
-            g_state.gs.MarkSwizzleDataDirty();
-            offset++;
-        }
-        break;
-    }
-
     case PICA_REG_INDEX(vs.bool_uniforms):
         // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
         WriteUniformBoolReg(g_state.vs, g_state.regs.vs.bool_uniforms.Value());
@@ -449,132 +679,13 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
     }
 
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[0]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[1]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[2]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[3]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[4]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[5]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[6]):
-    case PICA_REG_INDEX(vs.uniform_setup.set_value[7]): {
-        // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
-        WriteUniformFloatReg(g_state.regs.vs, g_state.vs, g_state.vs_float_regs_counter,
-                             g_state.vs_uniform_write_buffer, value);
-        break;
-    }
-
-    case PICA_REG_INDEX(vs.program.set_word[0]):
-    case PICA_REG_INDEX(vs.program.set_word[1]):
-    case PICA_REG_INDEX(vs.program.set_word[2]):
-    case PICA_REG_INDEX(vs.program.set_word[3]):
-    case PICA_REG_INDEX(vs.program.set_word[4]):
-    case PICA_REG_INDEX(vs.program.set_word[5]):
-    case PICA_REG_INDEX(vs.program.set_word[6]):
-    case PICA_REG_INDEX(vs.program.set_word[7]): {
-        u32& offset = g_state.regs.vs.program.offset;
-        if (offset >= 512) {
-            LOG_ERROR(HW_GPU, "Invalid VS program offset {}", offset);
-        } else {
-            g_state.vs.program_code[offset] = value;
-            g_state.vs.MarkProgramCodeDirty();
-            if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
-                g_state.gs.program_code[offset] = value;
-                g_state.gs.MarkProgramCodeDirty();
-            }
-            offset++;
-        }
-        break;
-    }
-
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[0]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[1]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[2]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[3]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[4]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[5]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[6]):
-    case PICA_REG_INDEX(vs.swizzle_patterns.set_word[7]): {
-        u32& offset = g_state.regs.vs.swizzle_patterns.offset;
-        if (offset >= g_state.vs.swizzle_data.size()) {
-            LOG_ERROR(HW_GPU, "Invalid VS swizzle pattern offset {}", offset);
-        } else {
-            g_state.vs.swizzle_data[offset] = value;
-            g_state.vs.MarkSwizzleDataDirty();
-            if (!g_state.regs.pipeline.gs_unit_exclusive_configuration) {
-                g_state.gs.swizzle_data[offset] = value;
-                g_state.gs.MarkSwizzleDataDirty();
-            }
-            offset++;
-        }
-        break;
-    }
-
-    case PICA_REG_INDEX(lighting.lut_data[0]):
-    case PICA_REG_INDEX(lighting.lut_data[1]):
-    case PICA_REG_INDEX(lighting.lut_data[2]):
-    case PICA_REG_INDEX(lighting.lut_data[3]):
-    case PICA_REG_INDEX(lighting.lut_data[4]):
-    case PICA_REG_INDEX(lighting.lut_data[5]):
-    case PICA_REG_INDEX(lighting.lut_data[6]):
-    case PICA_REG_INDEX(lighting.lut_data[7]): {
-        auto& lut_config = regs.lighting.lut_config;
-
-        ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
-
-        g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
-        lut_config.index.Assign(lut_config.index + 1);
-        break;
-    }
-
-    case PICA_REG_INDEX(texturing.fog_lut_data[0]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[1]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[2]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[3]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[4]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[5]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[6]):
-    case PICA_REG_INDEX(texturing.fog_lut_data[7]): {
-        g_state.fog.lut[regs.texturing.fog_lut_offset % 128].raw = value;
-        regs.texturing.fog_lut_offset.Assign(regs.texturing.fog_lut_offset + 1);
-        break;
-    }
-
-    case PICA_REG_INDEX(texturing.proctex_lut_data[0]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[1]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[2]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[3]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[4]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[5]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[6]):
-    case PICA_REG_INDEX(texturing.proctex_lut_data[7]): {
-        auto& index = regs.texturing.proctex_lut_config.index;
-        auto& pt = g_state.proctex;
-
-        switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
-        case TexturingRegs::ProcTexLutTable::Noise:
-            pt.noise_table[index % pt.noise_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorMap:
-            pt.color_map_table[index % pt.color_map_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::AlphaMap:
-            pt.alpha_map_table[index % pt.alpha_map_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::Color:
-            pt.color_table[index % pt.color_table.size()].raw = value;
-            break;
-        case TexturingRegs::ProcTexLutTable::ColorDiff:
-            pt.color_diff_table[index % pt.color_diff_table.size()].raw = value;
-            break;
-        }
-        index.Assign(index + 1);
-        break;
-    }
     default:
         break;
     }
 
-    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+    if (notify_rasterizer) {
+        NotifyRegisterChanged(id);
+    }
 }
 
 void ProcessCommandList(const u32* list, u32 size) {
@@ -592,11 +703,36 @@ void ProcessCommandList(const u32* list, u32 size) {
 
         WritePicaReg(header.cmd_id, value, header.parameter_mask);
 
-        for (unsigned i = 0; i < header.extra_data_length; ++i) {
-            u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
-            WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
+        unsigned i = 0;
+        while (i < header.extra_data_length) {
+            const u32 cmd = header.cmd_id + (header.group_commands ? i + 1 : 0);
+            const StreamWriteHandler handler =
+                cmd < Regs::NUM_REGS ? stream_write_handlers[cmd] : nullptr;
+            if (handler == nullptr) {
+                WritePicaReg(cmd, *g_state.cmd_list.current_ptr++, header.parameter_mask);
+                ++i;
+                continue;
+            }
+
+            // Write the rest of the values in one go if they all go to this stream. Grouped runs
+            // are limited to 32 registers for WriteStreamRegisters.
+            u32 count = 1;
+            while (i + count < header.extra_data_length && (!header.group_commands || count < 32)) {
+                const u32 next_cmd = cmd + (header.group_commands ? count : 0);
+                if (next_cmd >= Regs::NUM_REGS || stream_write_handlers[next_cmd] != handler) {
+                    break;
+                }
+                ++count;
+            }
+            WriteStreamRegisters(handler, cmd, g_state.cmd_list.current_ptr, count,
+                                 header.parameter_mask, header.group_commands);
+            g_state.cmd_list.current_ptr += count;
+            i += count;
         }
     }
+
+    FlushRegisterNotifications();
+    VideoCore::g_renderer->Rasterizer()->FlushTriangles();
 }
 
 } // namespace Pica::CommandProcessor
@@ -27,9 +27,16 @@ public:
                              const Pica::Shader::OutputVertex& v1,
                              const Pica::Shader::OutputVertex& v2) = 0;
 
-    /// Draw the current batch of triangles
+    /// Ends the current batch of triangles. The rasterizer may defer drawing it to merge it with
+    /// the following batches until FlushTriangles is called or a register they depend on changes.
     virtual void DrawTriangles() = 0;
 
+    /// Draws every batch of triangles deferred by DrawTriangles
+    virtual void FlushTriangles() {}
+
+    /// Notify rasterizer that the specified PICA register is about to be changed
+    virtual void NotifyPicaRegisterChanging(u32 id) {}
+
     /// Notify rasterizer that the specified PICA register has been changed
     virtual void NotifyPicaRegisterChanged(u32 id) = 0;
 
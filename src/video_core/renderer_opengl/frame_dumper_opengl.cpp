@@ -0,0 +1,113 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <glad/glad.h>
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/frame_dumper_opengl.h"
+#include "video_core/renderer_opengl/gl_state.h"
+
+namespace OpenGL {
+
+FrameDumperOpenGL::FrameDumperOpenGL(OpenGLState& state) : state(state) {}
+
+FrameDumperOpenGL::~FrameDumperOpenGL() {
+    Flush();
+}
+
+bool FrameDumperOpenGL::Capture(const Layout::FramebufferLayout& layout, const DrawFunction& draw,
+                                Callback callback) {
+    PixelBuffer& pixel_buffer = buffers[next_buffer];
+    if (pixel_buffer.sync.handle != nullptr) {
+        return false;
+    }
+
+    framebuffer.Create();
+    renderbuffer.Create();
+    if (renderbuffer_width != layout.width || renderbuffer_height != layout.height) {
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer.handle);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB8, layout.width, layout.height);
+        renderbuffer_width = layout.width;
+        renderbuffer_height = layout.height;
+    }
+
+    const GLuint old_read_fb = state.draw.read_framebuffer;
+    const GLuint old_draw_fb = state.draw.draw_framebuffer;
+    state.draw.read_framebuffer = state.draw.draw_framebuffer = framebuffer.handle;
+    state.Apply();
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                              renderbuffer.handle);
+
+    draw(layout);
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(layout.width) * layout.height * 4;
+    pixel_buffer.buffer.Create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.buffer.handle);
+    if (pixel_buffer.size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        pixel_buffer.size = size;
+    }
+    glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
+                 nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pixel_buffer.sync.Create();
+    pixel_buffer.callback = std::move(callback);
+    next_buffer = (next_buffer + 1) % NUM_BUFFERS;
+
+    state.draw.read_framebuffer = old_read_fb;
+    state.draw.draw_framebuffer = old_draw_fb;
+    state.Apply();
+
+    return true;
+}
+
+void FrameDumperOpenGL::Poll() {
+    // Buffers are used round-robin, so starting at next_buffer visits them oldest first
+    for (std::size_t i = 0; i < NUM_BUFFERS; ++i) {
+        PixelBuffer& pixel_buffer = buffers[(next_buffer + i) % NUM_BUFFERS];
+        if (pixel_buffer.sync.handle != nullptr && !TryComplete(pixel_buffer, 0)) {
+            // Fences signal in order, so nothing newer is ready either
+            return;
+        }
+    }
+}
+
+void FrameDumperOpenGL::Flush() {
+    for (std::size_t i = 0; i < NUM_BUFFERS; ++i) {
+        PixelBuffer& pixel_buffer = buffers[(next_buffer + i) % NUM_BUFFERS];
+        if (pixel_buffer.sync.handle != nullptr &&
+            !TryComplete(pixel_buffer, GL_TIMEOUT_IGNORED)) {
+            LOG_ERROR(Render_OpenGL, "Failed to wait for a frame readback");
+            pixel_buffer.sync.Release();
+            pixel_buffer.callback(nullptr);
+            pixel_buffer.callback = nullptr;
+        }
+    }
+}
+
+bool FrameDumperOpenGL::TryComplete(PixelBuffer& pixel_buffer, GLuint64 timeout) {
+    const GLenum result = glClientWaitSync(pixel_buffer.sync.handle,
+                                           timeout == 0 ? 0 : GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+    pixel_buffer.sync.Release();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer.buffer.handle);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixel_buffer.size,
+                                        GL_MAP_READ_BIT);
+    if (data == nullptr) {
+        LOG_ERROR(Render_OpenGL, "Failed to map a frame readback buffer");
+    }
+    pixel_buffer.callback(static_cast<const u8*>(data));
+    if (data != nullptr) {
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pixel_buffer.callback = nullptr;
+    return true;
+}
+
+} // namespace OpenGL
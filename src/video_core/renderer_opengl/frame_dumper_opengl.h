@@ -0,0 +1,70 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include "common/common_types.h"
+#include "core/frontend/framebuffer_layout.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+class OpenGLState;
+
+/**
+ * Reads rendered frames back through a ring of pixel buffer objects. Every readback is fenced and
+ * only mapped once the GPU is done with it, so capturing a frame never stalls the emulation thread.
+ */
+class FrameDumperOpenGL {
+public:
+    /// Receives bottom-up BGRA8 pixels, only valid for the duration of the call.
+    /// data is nullptr if the readback failed.
+    using Callback = std::function<void(const u8* data)>;
+    using DrawFunction = std::function<void(const Layout::FramebufferLayout& layout)>;
+
+    explicit FrameDumperOpenGL(OpenGLState& state);
+    ~FrameDumperOpenGL();
+
+    /**
+     * Renders a frame into an offscreen framebuffer and starts reading it back.
+     * @param layout the layout to render with
+     * @param draw draws the frame to the currently bound framebuffer
+     * @param callback called from Poll once the pixels are available
+     * @returns false if every buffer of the ring is still in flight
+     */
+    bool Capture(const Layout::FramebufferLayout& layout, const DrawFunction& draw,
+                 Callback callback);
+
+    /// Hands every finished readback to its callback, never waits on the GPU
+    void Poll();
+
+    /// Waits for every readback in flight
+    void Flush();
+
+private:
+    static constexpr std::size_t NUM_BUFFERS = 3;
+
+    struct PixelBuffer {
+        OGLBuffer buffer;
+        OGLSync sync;
+        GLsizeiptr size = 0;
+        Callback callback;
+    };
+
+    /// Returns whether the readback finished and was handed to its callback
+    bool TryComplete(PixelBuffer& pixel_buffer, GLuint64 timeout);
+
+    OpenGLState& state;
+    OGLFramebuffer framebuffer;
+    OGLRenderbuffer renderbuffer;
+    u32 renderbuffer_width = 0;
+    u32 renderbuffer_height = 0;
+
+    std::array<PixelBuffer, NUM_BUFFERS> buffers;
+    std::size_t next_buffer = 0;
+};
+
+} // namespace OpenGL
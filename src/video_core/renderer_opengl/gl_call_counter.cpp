@@ -0,0 +1,120 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <type_traits>
+#include <glad/glad.h>
+#include "video_core/renderer_opengl/gl_call_counter.h"
+
+namespace OpenGL::GLCallCounter {
+
+namespace {
+
+bool enabled = false;
+Counts current_frame;
+Counts last_frame;
+
+template <auto& Pointer, bool IsDraw,
+          typename Signature = std::remove_reference_t<decltype(Pointer)>>
+struct Hook;
+
+template <auto& Pointer, bool IsDraw, typename R, typename... Args>
+struct Hook<Pointer, IsDraw, R(APIENTRYP)(Args...)> {
+    static inline R(APIENTRYP original)(Args...) = nullptr;
+
+    static R APIENTRY Call(Args... args) {
+        ++current_frame.calls;
+        if constexpr (IsDraw) {
+            ++current_frame.draw_calls;
+        }
+        return original(args...);
+    }
+
+    static void Install() {
+        if (Pointer == nullptr || Pointer == &Call) {
+            return;
+        }
+        original = Pointer;
+        Pointer = &Call;
+    }
+
+    static void Uninstall() {
+        if (Pointer == &Call) {
+            Pointer = original;
+        }
+    }
+};
+
+template <typename... Hooks>
+void InstallAll(bool install) {
+    if (install) {
+        (Hooks::Install(), ...);
+    } else {
+        (Hooks::Uninstall(), ...);
+    }
+}
+
+// The entry points used per draw by the rasterizer, the state tracker, the stream buffers and the
+// surface cache
+#define STATE(name) Hook<glad_##name, false>
+#define DRAW(name) Hook<glad_##name, true>
+void SetHooksInstalled(bool install) {
+    InstallAll<
+        DRAW(glDrawArrays), DRAW(glDrawElements), DRAW(glDrawRangeElementsBaseVertex),
+        STATE(glEnable), STATE(glDisable), STATE(glCullFace), STATE(glFrontFace),
+        STATE(glDepthFunc), STATE(glDepthMask), STATE(glColorMask), STATE(glStencilFunc),
+        STATE(glStencilOp), STATE(glStencilMask), STATE(glBlendEquationSeparate),
+        STATE(glBlendFuncSeparate), STATE(glBlendColor), STATE(glLogicOp), STATE(glScissor),
+        STATE(glViewport), STATE(glActiveTexture), STATE(glBindTexture), STATE(glBindSampler),
+        STATE(glBindImageTexture), STATE(glBindFramebuffer), STATE(glBindVertexArray),
+        STATE(glBindBuffer), STATE(glBindBufferRange), STATE(glUseProgram),
+        STATE(glBindProgramPipeline), STATE(glUseProgramStages), STATE(glFramebufferTexture2D),
+        STATE(glFramebufferParameteri), STATE(glVertexAttribPointer),
+        STATE(glEnableVertexAttribArray), STATE(glDisableVertexAttribArray),
+        STATE(glVertexAttrib4f), STATE(glSamplerParameteri), STATE(glSamplerParameterf),
+        STATE(glSamplerParameterfv), STATE(glTexParameteri), STATE(glTexImage2D),
+        STATE(glTexSubImage2D), STATE(glBufferData), STATE(glBufferSubData),
+        STATE(glMapBufferRange), STATE(glUnmapBuffer), STATE(glFlushMappedBufferRange),
+        STATE(glFenceSync), STATE(glClientWaitSync), STATE(glDeleteSync), STATE(glMemoryBarrier),
+        STATE(glTextureBarrier), STATE(glCopyImageSubData), STATE(glBlitFramebuffer),
+        STATE(glClearBufferfv), STATE(glClearBufferfi), STATE(glUniform1i), STATE(glUniform1f),
+        STATE(glUniform2f), STATE(glUniform4f)>(install);
+}
+#undef STATE
+#undef DRAW
+
+} // namespace
+
+void SetEnabled(bool value) {
+    if (enabled == value) {
+        return;
+    }
+
+    SetHooksInstalled(value);
+    enabled = value;
+    current_frame = {};
+    last_frame = {};
+}
+
+bool IsEnabled() {
+    return enabled;
+}
+
+void AddBatch() {
+    if (enabled) {
+        ++current_frame.batches;
+    }
+}
+
+void EndFrame() {
+    if (enabled) {
+        last_frame = current_frame;
+        current_frame = {};
+    }
+}
+
+const Counts& GetLastFrameCounts() {
+    return last_frame;
+}
+
+} // namespace OpenGL::GLCallCounter
@@ -0,0 +1,32 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace OpenGL::GLCallCounter {
+
+struct Counts {
+    u64 calls = 0;      ///< GL calls made through the hooked entry points
+    u64 draw_calls = 0; ///< glDraw* calls
+    u64 batches = 0;    ///< Triangle batches submitted by the PICA, before merging
+};
+
+/// Starts or stops counting. Counting works by swapping the glad function pointers of the entry
+/// points the renderer uses for counting wrappers, so it costs nothing while disabled.
+void SetEnabled(bool enabled);
+
+bool IsEnabled();
+
+/// Counts a triangle batch submitted by the PICA
+void AddBatch();
+
+/// Finishes the current frame, called once per SwapBuffers
+void EndFrame();
+
+/// Returns the counts of the last finished frame
+const Counts& GetLastFrameCounts();
+
+} // namespace OpenGL::GLCallCounter
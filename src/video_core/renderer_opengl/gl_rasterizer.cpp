@@ -19,6 +19,7 @@
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_texturing.h"
+#include "video_core/renderer_opengl/gl_call_counter.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
@@ -41,10 +42,10 @@ static bool NeedToEnableHacks() {
 
 RasterizerOpenGL::RasterizerOpenGL()
     : enable_hacks(NeedToEnableHacks()),
-      vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, enable_hacks),
-      uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, false),
-      index_buffer(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false),
-      texture_buffer(GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false) {
+      vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, enable_hacks, true),
+      uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE, false, true),
+      index_buffer(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE, false, true),
+      texture_buffer(GL_TEXTURE_BUFFER, TEXTURE_BUFFER_SIZE, false, true) {
 
     allow_shadow = GLAD_GL_ARB_shader_image_load_store && GLAD_GL_ARB_shader_image_size &&
                    GLAD_GL_ARB_framebuffer_no_attachments;
@@ -100,6 +101,8 @@ RasterizerOpenGL::RasterizerOpenGL()
         Common::AlignUp<std::size_t>(sizeof(VSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
         Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
+    uniform_size_aligned_uber_fs =
+        Common::AlignUp<std::size_t>(sizeof(UberFSUniformData), uniform_buffer_alignment);
 
     // Set vertex attributes for software shader path
     state.draw.vertex_array = sw_vao.handle;
@@ -390,6 +393,8 @@ bool RasterizerOpenGL::SetupGeometryShader() {
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
+    FlushTriangles();
+
     const auto& regs = Pica::g_state.regs;
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
         if (regs.pipeline.gs_config.mode != Pica::PipelineRegs::GSMode::Point) {
@@ -400,7 +405,11 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
         }
     }
 
-    return SetupVertexShader() && SetupGeometryShader() && Draw(true, is_indexed);
+    if (!SetupVertexShader() || !SetupGeometryShader() || !Draw(true, is_indexed)) {
+        return false;
+    }
+    GLCallCounter::AddBatch();
+    return true;
 }
 
 static GLenum GetCurrentPrimitiveMode() {
@@ -472,10 +481,23 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
 }
 
 void RasterizerOpenGL::DrawTriangles() {
+    // Nothing is drawn here, consecutive batches are merged until a register they depend on
+    // changes or the result is needed
+    if (vertex_batch.size() == batched_vertices) {
+        return;
+    }
+    batched_vertices = vertex_batch.size();
+    GLCallCounter::AddBatch();
+}
+
+void RasterizerOpenGL::FlushTriangles() {
     if (vertex_batch.empty()) {
         return;
     }
     Draw(false, false);
+    if (VideoCore::g_draw_callback) {
+        VideoCore::g_draw_callback();
+    }
 }
 
 bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
@@ -848,6 +870,7 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     }
 
     vertex_batch.clear();
+    batched_vertices = 0;
 
     // Reset textures in rasterizer state context because the rasterizer cache might delete them
     for (unsigned texture_index = 0; texture_index < pica_textures.size(); ++texture_index) {
@@ -894,6 +917,21 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     return succeeded;
 }
 
+void RasterizerOpenGL::NotifyPicaRegisterChanging(u32 id) {
+    if (vertex_batch.empty()) {
+        return;
+    }
+
+    // Deferred triangles were already transformed, so only the vertex pipeline and shader
+    // registers can change under them. Everything else configures rasterization, texturing,
+    // lighting or the framebuffer.
+    if (id >= PICA_REG_INDEX(pipeline)) {
+        return;
+    }
+
+    FlushTriangles();
+}
+
 void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     const auto& regs = Pica::g_state.regs;
 
@@ -1385,23 +1423,29 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 }
 
 void RasterizerOpenGL::FlushAll() {
+    FlushTriangles();
     res_cache.FlushAll();
 }
 
 void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
+    FlushTriangles();
     res_cache.FlushRegion(addr, size);
 }
 
 void RasterizerOpenGL::InvalidateRegion(PAddr addr, u32 size) {
+    FlushTriangles();
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    FlushTriangles();
     res_cache.FlushRegion(addr, size);
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
+    FlushTriangles();
+
     SurfaceParams src_params;
     src_params.addr = config.GetPhysicalInputAddress();
     src_params.width = config.output_width;
@@ -1451,6 +1495,8 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
 }
 
 bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) {
+    FlushTriangles();
+
     u32 copy_size = Common::AlignDown(config.texture_copy.size, 16);
     if (copy_size == 0) {
         return false;
@@ -1536,6 +1582,8 @@ bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferCon
 }
 
 bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config) {
+    FlushTriangles();
+
     Surface dst_surface = res_cache.GetFillSurface(config);
     if (dst_surface == nullptr)
         return false;
@@ -1547,6 +1595,8 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
 bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& config,
                                          PAddr framebuffer_addr, u32 pixel_stride,
                                          ScreenInfo& screen_info) {
+    FlushTriangles();
+
     if (framebuffer_addr == 0) {
         return false;
     }
@@ -1657,7 +1707,10 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(
 }
 
 void RasterizerOpenGL::SetShader() {
-    shader_program_manager->UseFragmentShader(Pica::g_state.regs);
+    if (shader_program_manager->UseFragmentShader(Pica::g_state.regs,
+                                                  uniform_block_data.uber_fs_data)) {
+        uniform_block_data.uber_fs_dirty = true;
+    }
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
@@ -2142,11 +2195,12 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     state.draw.uniform_buffer = uniform_buffer.GetHandle();
     state.Apply();
 
-    if (!accelerate_draw && !uniform_block_data.dirty) {
+    if (!accelerate_draw && !uniform_block_data.dirty && !uniform_block_data.uber_fs_dirty) {
         return;
     }
 
-    std::size_t uniform_size = uniform_size_aligned_vs + uniform_size_aligned_fs;
+    std::size_t uniform_size =
+        uniform_size_aligned_vs + uniform_size_aligned_fs + uniform_size_aligned_uber_fs;
     std::size_t used_bytes = 0;
     u8* uniforms;
     GLintptr offset;
@@ -2171,10 +2225,21 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
         used_bytes += uniform_size_aligned_fs;
     }
 
+    if (uniform_block_data.uber_fs_dirty || invalidate) {
+        std::memcpy(uniforms + used_bytes, &uniform_block_data.uber_fs_data,
+                    sizeof(UberFSUniformData));
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::UberFS),
+                          uniform_buffer.GetHandle(), offset + used_bytes,
+                          sizeof(UberFSUniformData));
+        uniform_block_data.uber_fs_dirty = false;
+        used_bytes += uniform_size_aligned_uber_fs;
+    }
+
     uniform_buffer.Unmap(used_bytes);
 }
 
 void RasterizerOpenGL::ClearCache() {
+    FlushTriangles();
     res_cache.Clear();
 }
 
@@ -45,6 +45,8 @@ public:
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
     void DrawTriangles() override;
+    void FlushTriangles() override;
+    void NotifyPicaRegisterChanging(u32 id) override;
     void NotifyPicaRegisterChanged(u32 id) override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
@@ -268,7 +270,9 @@ private:
 
     RasterizerCacheOpenGL res_cache;
 
+    /// Triangles of every batch deferred by DrawTriangles, drawn together by FlushTriangles
     std::vector<HardwareVertex> vertex_batch;
+    std::size_t batched_vertices = 0;
 
     bool shader_dirty = true;
 
@@ -283,6 +287,8 @@ private:
         bool proctex_lut_dirty;
         bool proctex_diff_lut_dirty;
         bool dirty;
+        UberFSUniformData uber_fs_data;
+        bool uber_fs_dirty;
     } uniform_block_data = {};
 
     std::unique_ptr<ShaderProgramManager> shader_program_manager;
@@ -306,6 +312,7 @@ private:
     GLint uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs;
     std::size_t uniform_size_aligned_fs;
+    std::size_t uniform_size_aligned_uber_fs;
 
     SamplerInfo texture_cube_sampler;
 
@@ -37,6 +37,7 @@
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/texture_filters/filtered_texture_cache.h"
 #include "video_core/renderer_opengl/texture_filters/texture_filterer.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
@@ -762,6 +763,38 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
         is_custom = LoadCustomTexture(tex_hash);
     }
 
+    // Whole textures that were filtered before are uploaded from the filtered texture cache,
+    // skipping the unscaled upload and the filter
+    FilteredTextureCache* const filtered_texture_cache = owner.filtered_texture_cache.get();
+    u64 filtered_texture_key = 0;
+    if (filtered_texture_cache != nullptr && res_scale != 1 && !is_custom &&
+        type == SurfaceType::Texture && !Settings::values.dump_textures && rect.left == 0 &&
+        rect.bottom == 0 && rect.right == width && rect.top == height) {
+        filtered_texture_cache->Poll();
+
+        filtered_texture_key =
+            FilteredTextureCache::ComputeKey(gl_buffer, pixel_format, width, height, res_scale);
+        const auto entry = filtered_texture_cache->Find(filtered_texture_key);
+        if (entry != nullptr && entry->width == GetScaledWidth() &&
+            entry->height == GetScaledHeight()) {
+            OpenGLState cur_state = OpenGLState::GetCurState();
+            const GLuint old_tex = cur_state.texture_units[0].texture_2d;
+            cur_state.texture_units[0].texture_2d = texture.handle;
+            cur_state.Apply();
+
+            glActiveTexture(GL_TEXTURE0);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(entry->width),
+                            static_cast<GLsizei>(entry->height), GL_RGBA, GL_UNSIGNED_BYTE,
+                            entry->pixels.data());
+
+            cur_state.texture_units[0].texture_2d = old_tex;
+            cur_state.Apply();
+
+            InvalidateAllWatcher();
+            return;
+        }
+    }
+
     // Load data from memory to the surface
     GLint x0 = static_cast<GLint>(rect.left);
     GLint y0 = static_cast<GLint>(rect.bottom);
@@ -838,6 +871,10 @@ void CachedSurface::UploadGLTexture(Common::Rectangle<u32> rect, GLuint read_fb_
                                             scaled_rect, type, read_fb_handle, draw_fb_handle)) {
             BlitTextures(unscaled_tex.handle, from_rect, texture.handle, scaled_rect, type,
                          read_fb_handle, draw_fb_handle);
+        } else if (filtered_texture_key != 0) {
+            filtered_texture_cache->Store(filtered_texture_key, texture.handle,
+                                          scaled_rect.GetWidth(), scaled_rect.GetHeight(),
+                                          read_fb_handle);
         }
     }
 
@@ -1060,6 +1097,7 @@ RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
     texture_filterer =
         std::make_unique<TextureFilterer>(Settings::values.texture_filter, resolution_scale_factor);
     format_reinterpreter = std::make_unique<FormatReinterpreterOpenGL>();
+    ResetFilteredTextureCache();
 
     read_framebuffer.Create();
     draw_framebuffer.Create();
@@ -1077,6 +1115,14 @@ void RasterizerCacheOpenGL::Clear() {
     texture_cube_cache.clear();
 }
 
+void RasterizerCacheOpenGL::ResetFilteredTextureCache() {
+    filtered_texture_cache.reset();
+    if (Settings::values.cache_filtered_textures && !texture_filterer->IsNull()) {
+        filtered_texture_cache =
+            std::make_unique<FilteredTextureCache>(texture_filterer->GetFilterName());
+    }
+}
+
 bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
                                          const Common::Rectangle<u32>& src_rect,
                                          const Surface& dst_surface,
@@ -1459,6 +1505,10 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
          texture_filterer->Reset(Settings::values.texture_filter, resolution_scale_factor))) {
         resolution_scale_factor = VideoCore::GetResolutionScaleFactor();
         Clear();
+        ResetFilteredTextureCache();
+    } else if (Settings::values.cache_filtered_textures != (filtered_texture_cache != nullptr) &&
+               !texture_filterer->IsNull()) {
+        ResetFilteredTextureCache();
     }
 
     Common::Rectangle<u32> viewport_clamped{
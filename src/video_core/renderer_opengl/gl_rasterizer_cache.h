@@ -32,6 +32,7 @@
 
 namespace OpenGL {
 
+class FilteredTextureCache;
 class RasterizerCacheOpenGL;
 class TextureFilterer;
 class FormatReinterpreterOpenGL;
@@ -349,6 +350,9 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Creates the filtered texture cache for the current filter if it's enabled
+    void ResetFilteredTextureCache();
+
     SurfaceCache surface_cache;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
@@ -369,6 +373,7 @@ public:
     std::unordered_multimap<HostTextureTag, OGLTexture> host_texture_recycler;
 
     std::unique_ptr<TextureFilterer> texture_filterer;
+    std::unique_ptr<FilteredTextureCache> filtered_texture_cache; ///< nullptr if not enabled
     std::unique_ptr<FormatReinterpreterOpenGL> format_reinterpreter;
 };
 
@@ -219,4 +219,38 @@ void OGLFramebuffer::Release() {
     handle = 0;
 }
 
+void OGLRenderbuffer::Create() {
+    if (handle != 0) {
+        return;
+    }
+
+    glGenRenderbuffers(1, &handle);
+}
+
+void OGLRenderbuffer::Release() {
+    if (handle == 0) {
+        return;
+    }
+
+    glDeleteRenderbuffers(1, &handle);
+    handle = 0;
+}
+
+void OGLSync::Create() {
+    if (handle != nullptr) {
+        return;
+    }
+
+    handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void OGLSync::Release() {
+    if (handle == nullptr) {
+        return;
+    }
+
+    glDeleteSync(handle);
+    handle = nullptr;
+}
+
 } // namespace OpenGL
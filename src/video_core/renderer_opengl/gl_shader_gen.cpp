@@ -1223,9 +1223,8 @@ float ProcTexNoiseCoef(vec2 x) {
     }
 }
 
-std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
-    const auto& state = config.state;
-
+/// Writes the declarations shared by the specialized fragment shaders and the uber-shader
+static std::string GetFragmentShaderHeader(bool separable_shader) {
     std::string out = R"(#version 330 core
 
 #extension GL_ARB_shader_image_load_store : enable
@@ -1262,7 +1261,10 @@ layout(r32ui) uniform uimage2D shadow_buffer;
 
     out += UniformBlockDef;
 
-    out += R"(
+    return out;
+}
+
+constexpr std::string_view FragmentShaderHelpersDef = R"(
 // Rotate the vector v by the quaternion q
 vec3 quaternion_rotate(vec4 q, vec3 v) {
     return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
@@ -1312,7 +1314,15 @@ float getLod(vec2 coord) {
     vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
     return log2(max(d.x, d.y));
 }
+)";
+
+std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
+    const auto& state = config.state;
+
+    std::string out = GetFragmentShaderHeader(separable_shader);
+    out += FragmentShaderHelpersDef;
 
+    out += R"(
 #if ALLOW_SHADOW
 
 uvec2 DecodeShadow(uint pixel) {
@@ -1570,6 +1580,677 @@ do {
     return std::move(out);
 }
 
+constexpr std::string_view UberFSConfigDef = R"(
+#define NUM_LIGHTING_LUTS 7
+
+struct UberTevStage {
+    ivec4 color_source;
+    ivec4 color_modifier;
+    ivec4 alpha_source;
+    ivec4 alpha_modifier;
+    // Color operation, alpha operation, color multiplier and alpha multiplier
+    ivec4 op;
+};
+
+struct UberLight {
+    int num;
+    int directional;
+    int two_sided_diffuse;
+    int dist_atten_enable;
+    int spot_atten_enable;
+    int geometric_factor_0;
+    int geometric_factor_1;
+    int shadow_enable;
+};
+
+struct UberLightingLut {
+    int enable;
+    int abs_input;
+    int type;
+    float scale;
+};
+
+layout (std140) uniform uber_fs_config {
+    int alpha_test_func;
+    int scissor_test_mode;
+    int texture0_type;
+    int texture2_use_coord1;
+    int combiner_buffer_input;
+    int depthmap_enable;
+    int fog_mode;
+    int fog_flip;
+    int lighting_enable;
+    int lighting_src_num;
+    int lighting_config;
+    int lighting_bump_mode;
+    int lighting_bump_selector;
+    int lighting_bump_renorm;
+    int lighting_clamp_highlights;
+    int lighting_enable_primary_alpha;
+    int lighting_enable_secondary_alpha;
+    int lighting_enable_shadow;
+    int lighting_shadow_primary;
+    int lighting_shadow_secondary;
+    int lighting_shadow_invert;
+    int lighting_shadow_alpha;
+    int lighting_shadow_selector;
+    UberTevStage tev_stages[NUM_TEV_STAGES];
+    UberLight lights[NUM_LIGHTS];
+    // D0, D1, SP, FR, RR, RG and RB
+    UberLightingLut lighting_luts[NUM_LIGHTING_LUTS];
+};
+)";
+
+bool IsFragmentUberShaderSupported(const PicaFSConfig& config) {
+    const auto& state = config.state;
+
+    switch (state.texture0_type) {
+    case TexturingRegs::TextureConfig::Texture2D:
+    case TexturingRegs::TextureConfig::Projection2D:
+    case TexturingRegs::TextureConfig::TextureCube:
+    case TexturingRegs::TextureConfig::Disabled:
+        break;
+    default:
+        // Shadow textures
+        return false;
+    }
+
+    return !state.proctex.enable && !state.shadow_rendering &&
+           state.fog_mode != TexturingRegs::FogMode::Gas;
+}
+
+std::string GenerateFragmentUberShader(bool separable_shader) {
+    std::string out = GetFragmentShaderHeader(separable_shader);
+    out += UberFSConfigDef;
+
+    // The configuration is made of register values, make their meanings available by name
+    const auto define = [&out](std::string_view name, auto value) {
+        out += fmt::format("#define {} {}\n", name, static_cast<u32>(value));
+    };
+
+    define("TEXTURE_TYPE_2D", TexturingRegs::TextureConfig::Texture2D);
+    define("TEXTURE_TYPE_PROJECTION_2D", TexturingRegs::TextureConfig::Projection2D);
+    define("TEXTURE_TYPE_CUBE", TexturingRegs::TextureConfig::TextureCube);
+
+    using Source = TevStageConfig::Source;
+    define("SOURCE_PRIMARY_COLOR", Source::PrimaryColor);
+    define("SOURCE_PRIMARY_FRAGMENT_COLOR", Source::PrimaryFragmentColor);
+    define("SOURCE_SECONDARY_FRAGMENT_COLOR", Source::SecondaryFragmentColor);
+    define("SOURCE_TEXTURE0", Source::Texture0);
+    define("SOURCE_TEXTURE1", Source::Texture1);
+    define("SOURCE_TEXTURE2", Source::Texture2);
+    define("SOURCE_TEXTURE3", Source::Texture3);
+    define("SOURCE_PREVIOUS_BUFFER", Source::PreviousBuffer);
+    define("SOURCE_CONSTANT", Source::Constant);
+    define("SOURCE_PREVIOUS", Source::Previous);
+
+    using ColorModifier = TevStageConfig::ColorModifier;
+    define("COLOR_MODIFIER_SOURCE_COLOR", ColorModifier::SourceColor);
+    define("COLOR_MODIFIER_ONE_MINUS_SOURCE_COLOR", ColorModifier::OneMinusSourceColor);
+    define("COLOR_MODIFIER_SOURCE_ALPHA", ColorModifier::SourceAlpha);
+    define("COLOR_MODIFIER_ONE_MINUS_SOURCE_ALPHA", ColorModifier::OneMinusSourceAlpha);
+    define("COLOR_MODIFIER_SOURCE_RED", ColorModifier::SourceRed);
+    define("COLOR_MODIFIER_ONE_MINUS_SOURCE_RED", ColorModifier::OneMinusSourceRed);
+    define("COLOR_MODIFIER_SOURCE_GREEN", ColorModifier::SourceGreen);
+    define("COLOR_MODIFIER_ONE_MINUS_SOURCE_GREEN", ColorModifier::OneMinusSourceGreen);
+    define("COLOR_MODIFIER_SOURCE_BLUE", ColorModifier::SourceBlue);
+    define("COLOR_MODIFIER_ONE_MINUS_SOURCE_BLUE", ColorModifier::OneMinusSourceBlue);
+
+    using AlphaModifier = TevStageConfig::AlphaModifier;
+    define("ALPHA_MODIFIER_SOURCE_ALPHA", AlphaModifier::SourceAlpha);
+    define("ALPHA_MODIFIER_ONE_MINUS_SOURCE_ALPHA", AlphaModifier::OneMinusSourceAlpha);
+    define("ALPHA_MODIFIER_SOURCE_RED", AlphaModifier::SourceRed);
+    define("ALPHA_MODIFIER_ONE_MINUS_SOURCE_RED", AlphaModifier::OneMinusSourceRed);
+    define("ALPHA_MODIFIER_SOURCE_GREEN", AlphaModifier::SourceGreen);
+    define("ALPHA_MODIFIER_ONE_MINUS_SOURCE_GREEN", AlphaModifier::OneMinusSourceGreen);
+    define("ALPHA_MODIFIER_SOURCE_BLUE", AlphaModifier::SourceBlue);
+    define("ALPHA_MODIFIER_ONE_MINUS_SOURCE_BLUE", AlphaModifier::OneMinusSourceBlue);
+
+    using Operation = TevStageConfig::Operation;
+    define("OPERATION_REPLACE", Operation::Replace);
+    define("OPERATION_MODULATE", Operation::Modulate);
+    define("OPERATION_ADD", Operation::Add);
+    define("OPERATION_ADD_SIGNED", Operation::AddSigned);
+    define("OPERATION_LERP", Operation::Lerp);
+    define("OPERATION_SUBTRACT", Operation::Subtract);
+    define("OPERATION_DOT3_RGB", Operation::Dot3_RGB);
+    define("OPERATION_DOT3_RGBA", Operation::Dot3_RGBA);
+    define("OPERATION_MULTIPLY_THEN_ADD", Operation::MultiplyThenAdd);
+    define("OPERATION_ADD_THEN_MULTIPLY", Operation::AddThenMultiply);
+
+    using CompareFunc = FramebufferRegs::CompareFunc;
+    define("COMPARE_FUNC_NEVER", CompareFunc::Never);
+    define("COMPARE_FUNC_EQUAL", CompareFunc::Equal);
+    define("COMPARE_FUNC_NOT_EQUAL", CompareFunc::NotEqual);
+    define("COMPARE_FUNC_LESS_THAN", CompareFunc::LessThan);
+    define("COMPARE_FUNC_LESS_THAN_OR_EQUAL", CompareFunc::LessThanOrEqual);
+    define("COMPARE_FUNC_GREATER_THAN", CompareFunc::GreaterThan);
+    define("COMPARE_FUNC_GREATER_THAN_OR_EQUAL", CompareFunc::GreaterThanOrEqual);
+
+    define("SCISSOR_MODE_DISABLED", RasterizerRegs::ScissorMode::Disabled);
+    define("SCISSOR_MODE_EXCLUDE", RasterizerRegs::ScissorMode::Exclude);
+    define("DEPTH_BUFFERING_W", RasterizerRegs::DepthBuffering::WBuffering);
+    define("FOG_MODE_FOG", TexturingRegs::FogMode::Fog);
+
+    using LightingLutInput = LightingRegs::LightingLutInput;
+    define("LUT_INPUT_NH", LightingLutInput::NH);
+    define("LUT_INPUT_VH", LightingLutInput::VH);
+    define("LUT_INPUT_NV", LightingLutInput::NV);
+    define("LUT_INPUT_LN", LightingLutInput::LN);
+    define("LUT_INPUT_SP", LightingLutInput::SP);
+    define("LUT_INPUT_CP", LightingLutInput::CP);
+
+    using LightingSampler = LightingRegs::LightingSampler;
+    define("SAMPLER_D0", LightingSampler::Distribution0);
+    define("SAMPLER_D1", LightingSampler::Distribution1);
+    define("SAMPLER_FR", LightingSampler::Fresnel);
+    define("SAMPLER_RB", LightingSampler::ReflectBlue);
+    define("SAMPLER_RG", LightingSampler::ReflectGreen);
+    define("SAMPLER_RR", LightingSampler::ReflectRed);
+    define("SAMPLER_SP", LightingSampler::SpotlightAttenuation);
+    define("SAMPLER_DA", LightingSampler::DistanceAttenuation);
+
+    define("LIGHTING_CONFIG_7", LightingRegs::LightingConfig::Config7);
+    define("BUMP_MODE_NORMAL_MAP", LightingRegs::LightingBumpMode::NormalMap);
+    define("BUMP_MODE_TANGENT_MAP", LightingRegs::LightingBumpMode::TangentMap);
+
+    out += FragmentShaderHelpersDef;
+
+    out += R"(
+#define LUT_D0 0
+#define LUT_D1 1
+#define LUT_SP 2
+#define LUT_FR 3
+#define LUT_RR 4
+#define LUT_RG 5
+#define LUT_RB 6
+
+vec4 rounded_primary_color;
+vec4 primary_fragment_color;
+vec4 secondary_fragment_color;
+vec4 texture_color[4];
+vec4 combiner_buffer;
+vec4 last_tex_env_out;
+
+vec3 normal;
+vec3 tangent;
+vec3 light_vector;
+vec3 spot_dir;
+vec3 half_vector;
+
+vec4 SampleTexture0() {
+    switch (texture0_type) {
+    case TEXTURE_TYPE_2D:
+        return textureLod(tex0, texcoord0, getLod(texcoord0 * vec2(textureSize(tex0, 0))));
+    case TEXTURE_TYPE_PROJECTION_2D:
+        return textureProj(tex0, vec3(texcoord0, texcoord0_w));
+    case TEXTURE_TYPE_CUBE:
+        return texture(tex_cube, vec3(texcoord0, texcoord0_w));
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec4 GetSource(int source, int stage) {
+    switch (source) {
+    case SOURCE_PRIMARY_COLOR:
+        return rounded_primary_color;
+    case SOURCE_PRIMARY_FRAGMENT_COLOR:
+        return primary_fragment_color;
+    case SOURCE_SECONDARY_FRAGMENT_COLOR:
+        return secondary_fragment_color;
+    case SOURCE_TEXTURE0:
+        return texture_color[0];
+    case SOURCE_TEXTURE1:
+        return texture_color[1];
+    case SOURCE_TEXTURE2:
+        return texture_color[2];
+    case SOURCE_TEXTURE3:
+        return texture_color[3];
+    case SOURCE_PREVIOUS_BUFFER:
+        return combiner_buffer;
+    case SOURCE_CONSTANT:
+        return const_color[stage];
+    case SOURCE_PREVIOUS:
+        return last_tex_env_out;
+    default:
+        return vec4(0.0);
+    }
+}
+
+vec3 GetColorModifier(int modifier, vec4 value) {
+    switch (modifier) {
+    case COLOR_MODIFIER_SOURCE_COLOR:
+        return value.rgb;
+    case COLOR_MODIFIER_ONE_MINUS_SOURCE_COLOR:
+        return vec3(1.0) - value.rgb;
+    case COLOR_MODIFIER_SOURCE_ALPHA:
+        return value.aaa;
+    case COLOR_MODIFIER_ONE_MINUS_SOURCE_ALPHA:
+        return vec3(1.0) - value.aaa;
+    case COLOR_MODIFIER_SOURCE_RED:
+        return value.rrr;
+    case COLOR_MODIFIER_ONE_MINUS_SOURCE_RED:
+        return vec3(1.0) - value.rrr;
+    case COLOR_MODIFIER_SOURCE_GREEN:
+        return value.ggg;
+    case COLOR_MODIFIER_ONE_MINUS_SOURCE_GREEN:
+        return vec3(1.0) - value.ggg;
+    case COLOR_MODIFIER_SOURCE_BLUE:
+        return value.bbb;
+    case COLOR_MODIFIER_ONE_MINUS_SOURCE_BLUE:
+        return vec3(1.0) - value.bbb;
+    default:
+        return vec3(0.0);
+    }
+}
+
+float GetAlphaModifier(int modifier, vec4 value) {
+    switch (modifier) {
+    case ALPHA_MODIFIER_SOURCE_ALPHA:
+        return value.a;
+    case ALPHA_MODIFIER_ONE_MINUS_SOURCE_ALPHA:
+        return 1.0 - value.a;
+    case ALPHA_MODIFIER_SOURCE_RED:
+        return value.r;
+    case ALPHA_MODIFIER_ONE_MINUS_SOURCE_RED:
+        return 1.0 - value.r;
+    case ALPHA_MODIFIER_SOURCE_GREEN:
+        return value.g;
+    case ALPHA_MODIFIER_ONE_MINUS_SOURCE_GREEN:
+        return 1.0 - value.g;
+    case ALPHA_MODIFIER_SOURCE_BLUE:
+        return value.b;
+    case ALPHA_MODIFIER_ONE_MINUS_SOURCE_BLUE:
+        return 1.0 - value.b;
+    default:
+        return 0.0;
+    }
+}
+
+vec3 CombineColor(int operation, vec3 values[3]) {
+    vec3 result;
+    switch (operation) {
+    case OPERATION_REPLACE:
+        result = values[0];
+        break;
+    case OPERATION_MODULATE:
+        result = values[0] * values[1];
+        break;
+    case OPERATION_ADD:
+        result = values[0] + values[1];
+        break;
+    case OPERATION_ADD_SIGNED:
+        result = values[0] + values[1] - vec3(0.5);
+        break;
+    case OPERATION_LERP:
+        result = values[0] * values[2] + values[1] * (vec3(1.0) - values[2]);
+        break;
+    case OPERATION_SUBTRACT:
+        result = values[0] - values[1];
+        break;
+    case OPERATION_MULTIPLY_THEN_ADD:
+        result = values[0] * values[1] + values[2];
+        break;
+    case OPERATION_ADD_THEN_MULTIPLY:
+        result = min(values[0] + values[1], vec3(1.0)) * values[2];
+        break;
+    case OPERATION_DOT3_RGB:
+    case OPERATION_DOT3_RGBA:
+        result = vec3(dot(values[0] - vec3(0.5), values[1] - vec3(0.5)) * 4.0);
+        break;
+    default:
+        result = vec3(0.0);
+        break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float CombineAlpha(int operation, float values[3]) {
+    float result;
+    switch (operation) {
+    case OPERATION_REPLACE:
+        result = values[0];
+        break;
+    case OPERATION_MODULATE:
+        result = values[0] * values[1];
+        break;
+    case OPERATION_ADD:
+        result = values[0] + values[1];
+        break;
+    case OPERATION_ADD_SIGNED:
+        result = values[0] + values[1] - 0.5;
+        break;
+    case OPERATION_LERP:
+        result = values[0] * values[2] + values[1] * (1.0 - values[2]);
+        break;
+    case OPERATION_SUBTRACT:
+        result = values[0] - values[1];
+        break;
+    case OPERATION_MULTIPLY_THEN_ADD:
+        result = values[0] * values[1] + values[2];
+        break;
+    case OPERATION_ADD_THEN_MULTIPLY:
+        result = min(values[0] + values[1], 1.0) * values[2];
+        break;
+    default:
+        result = 0.0;
+        break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+bool AlphaTestFails(float alpha) {
+    int value = int(alpha * 255.0);
+    switch (alpha_test_func) {
+    case COMPARE_FUNC_NEVER:
+        return true;
+    case COMPARE_FUNC_EQUAL:
+        return value != alphatest_ref;
+    case COMPARE_FUNC_NOT_EQUAL:
+        return value == alphatest_ref;
+    case COMPARE_FUNC_LESS_THAN:
+        return value >= alphatest_ref;
+    case COMPARE_FUNC_LESS_THAN_OR_EQUAL:
+        return value > alphatest_ref;
+    case COMPARE_FUNC_GREATER_THAN:
+        return value <= alphatest_ref;
+    case COMPARE_FUNC_GREATER_THAN_OR_EQUAL:
+        return value < alphatest_ref;
+    default:
+        return false;
+    }
+}
+
+float GetLightingLUTValue(int sampler, UberLightingLut lut, bool two_sided_diffuse) {
+    float index;
+    switch (lut.type) {
+    case LUT_INPUT_NH:
+        index = dot(normal, normalize(half_vector));
+        break;
+    case LUT_INPUT_VH:
+        index = dot(normalize(view), normalize(half_vector));
+        break;
+    case LUT_INPUT_NV:
+        index = dot(normal, normalize(view));
+        break;
+    case LUT_INPUT_LN:
+        index = dot(light_vector, normal);
+        break;
+    case LUT_INPUT_SP:
+        index = dot(light_vector, spot_dir);
+        break;
+    case LUT_INPUT_CP:
+        // CP input is only available with configuration 7
+        if (lighting_config == LIGHTING_CONFIG_7) {
+            vec3 half_angle_proj =
+                normalize(half_vector) - normal * dot(normal, normalize(half_vector));
+            index = dot(half_angle_proj, tangent);
+        } else {
+            index = 0.0;
+        }
+        break;
+    default:
+        index = 0.0;
+        break;
+    }
+
+    if (lut.abs_input != 0) {
+        // LUT index is in the range of (0.0, 1.0)
+        index = two_sided_diffuse ? abs(index) : max(index, 0.0);
+        return lut.scale * LookupLightingLUTUnsigned(sampler, index);
+    } else {
+        // LUT index is in the range of (-1.0, 1.0)
+        return lut.scale * LookupLightingLUTSigned(sampler, index);
+    }
+}
+
+void ComputeLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec3 refl_value = vec3(0.0);
+    float clamp_highlights = 1.0;
+    float geo_factor = 1.0;
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (lighting_bump_mode == BUMP_MODE_NORMAL_MAP) {
+        surface_normal = 2.0 * texture_color[lighting_bump_selector].rgb - 1.0;
+        if (lighting_bump_renorm != 0) {
+            surface_normal.z = sqrt(max(1.0 - (surface_normal.x * surface_normal.x +
+                                               surface_normal.y * surface_normal.y), 0.0));
+        }
+    } else if (lighting_bump_mode == BUMP_MODE_TANGENT_MAP) {
+        surface_tangent = 2.0 * texture_color[lighting_bump_selector].rgb - 1.0;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    normal = quaternion_rotate(normalized_normquat, surface_normal);
+    tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if (lighting_enable_shadow != 0) {
+        shadow = texture_color[lighting_shadow_selector];
+        if (lighting_shadow_invert != 0) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    for (int i = 0; i < lighting_src_num; ++i) {
+        UberLight light = lights[i];
+        LightSrc src = light_src[light.num];
+
+        if (light.directional != 0) {
+            light_vector = normalize(src.position);
+        } else {
+            light_vector = normalize(src.position + view);
+        }
+        spot_dir = src.spot_direction;
+        half_vector = normalize(view) + light_vector;
+
+        float dot_product = light.two_sided_diffuse != 0 ? abs(dot(light_vector, normal))
+                                                         : max(dot(light_vector, normal), 0.0);
+        if (lighting_clamp_highlights != 0) {
+            clamp_highlights = sign(dot_product);
+        }
+
+        // Like the specialized shaders, the LUT inputs use the setting of the light slot that
+        // matches the light number
+        bool lut_two_sided_diffuse = lights[light.num].two_sided_diffuse != 0;
+
+        float spot_atten = 1.0;
+        if (light.spot_atten_enable != 0 && lighting_luts[LUT_SP].enable != 0) {
+            spot_atten = GetLightingLUTValue(SAMPLER_SP + light.num, lighting_luts[LUT_SP],
+                                             lut_two_sided_diffuse);
+        }
+
+        float dist_atten = 1.0;
+        if (light.dist_atten_enable != 0) {
+            float index = clamp(src.dist_atten_scale * length(-view - src.position) +
+                                src.dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(SAMPLER_DA + light.num, index);
+        }
+
+        if (light.geometric_factor_0 != 0 || light.geometric_factor_1 != 0) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        float d0_lut_value = 1.0;
+        if (lighting_luts[LUT_D0].enable != 0) {
+            d0_lut_value = GetLightingLUTValue(SAMPLER_D0, lighting_luts[LUT_D0],
+                                               lut_two_sided_diffuse);
+        }
+        vec3 specular_0 = d0_lut_value * src.specular_0;
+        if (light.geometric_factor_0 != 0) {
+            specular_0 *= geo_factor;
+        }
+
+        refl_value.r = 1.0;
+        if (lighting_luts[LUT_RR].enable != 0) {
+            refl_value.r = GetLightingLUTValue(SAMPLER_RR, lighting_luts[LUT_RR],
+                                               lut_two_sided_diffuse);
+        }
+        refl_value.g = refl_value.r;
+        if (lighting_luts[LUT_RG].enable != 0) {
+            refl_value.g = GetLightingLUTValue(SAMPLER_RG, lighting_luts[LUT_RG],
+                                               lut_two_sided_diffuse);
+        }
+        refl_value.b = refl_value.r;
+        if (lighting_luts[LUT_RB].enable != 0) {
+            refl_value.b = GetLightingLUTValue(SAMPLER_RB, lighting_luts[LUT_RB],
+                                               lut_two_sided_diffuse);
+        }
+
+        float d1_lut_value = 1.0;
+        if (lighting_luts[LUT_D1].enable != 0) {
+            d1_lut_value = GetLightingLUTValue(SAMPLER_D1, lighting_luts[LUT_D1],
+                                               lut_two_sided_diffuse);
+        }
+        vec3 specular_1 = d1_lut_value * refl_value * src.specular_1;
+        if (light.geometric_factor_1 != 0) {
+            specular_1 *= geo_factor;
+        }
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (i == lighting_src_num - 1 && lighting_luts[LUT_FR].enable != 0) {
+            float value = GetLightingLUTValue(SAMPLER_FR, lighting_luts[LUT_FR],
+                                              lut_two_sided_diffuse);
+            if (lighting_enable_primary_alpha != 0) {
+                diffuse_sum.a = value;
+            }
+            if (lighting_enable_secondary_alpha != 0) {
+                specular_sum.a = value;
+            }
+        }
+
+        vec3 shadow_primary = vec3(1.0);
+        vec3 shadow_secondary = vec3(1.0);
+        if (light.shadow_enable != 0) {
+            if (lighting_shadow_primary != 0) {
+                shadow_primary = shadow.rgb;
+            }
+            if (lighting_shadow_secondary != 0) {
+                shadow_secondary = shadow.rgb;
+            }
+        }
+
+        diffuse_sum.rgb += ((src.diffuse * dot_product) + src.ambient) * dist_atten * spot_atten *
+                           shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten *
+                            spot_atten * shadow_secondary;
+    }
+
+    if (lighting_shadow_alpha != 0) {
+        if (lighting_enable_primary_alpha != 0) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if (lighting_enable_secondary_alpha != 0) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+void main() {
+    if (alpha_test_func == COMPARE_FUNC_NEVER) {
+        discard;
+    }
+
+    rounded_primary_color = byteround(primary_color);
+    primary_fragment_color = vec4(0.0);
+    secondary_fragment_color = vec4(0.0);
+
+    if (scissor_test_mode != SCISSOR_MODE_DISABLED) {
+        bool inside = gl_FragCoord.x >= scissor_x1 && gl_FragCoord.y >= scissor_y1 &&
+                      gl_FragCoord.x < scissor_x2 && gl_FragCoord.y < scissor_y2;
+        if (inside == (scissor_test_mode == SCISSOR_MODE_EXCLUDE)) {
+            discard;
+        }
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (depthmap_enable == DEPTH_BUFFERING_W) {
+        depth /= gl_FragCoord.w;
+    }
+
+    // Every texture is sampled up front, the selections are the same for every fragment
+    texture_color[0] = SampleTexture0();
+    texture_color[1] = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))));
+    vec2 texture2_coord = texture2_use_coord1 != 0 ? texcoord1 : texcoord2;
+    texture_color[2] =
+        textureLod(tex2, texture2_coord, getLod(texture2_coord * vec2(textureSize(tex2, 0))));
+    texture_color[3] = vec4(0.0);
+
+    if (lighting_enable != 0) {
+        ComputeLighting();
+    }
+
+    combiner_buffer = vec4(0.0);
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    last_tex_env_out = vec4(0.0);
+
+    for (int i = 0; i < NUM_TEV_STAGES; ++i) {
+        UberTevStage stage = tev_stages[i];
+
+        vec3 color_results[3] = vec3[3](
+            GetColorModifier(stage.color_modifier.x, GetSource(stage.color_source.x, i)),
+            GetColorModifier(stage.color_modifier.y, GetSource(stage.color_source.y, i)),
+            GetColorModifier(stage.color_modifier.z, GetSource(stage.color_source.z, i)));
+        // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
+        vec3 color_output = byteround(CombineColor(stage.op.x, color_results));
+
+        float alpha_output;
+        if (stage.op.x == OPERATION_DOT3_RGBA) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output[0];
+        } else {
+            float alpha_results[3] = float[3](
+                GetAlphaModifier(stage.alpha_modifier.x, GetSource(stage.alpha_source.x, i)),
+                GetAlphaModifier(stage.alpha_modifier.y, GetSource(stage.alpha_source.y, i)),
+                GetAlphaModifier(stage.alpha_modifier.z, GetSource(stage.alpha_source.z, i)));
+            alpha_output = byteround(CombineAlpha(stage.op.y, alpha_results));
+        }
+
+        last_tex_env_out = vec4(clamp(color_output * float(stage.op.z), vec3(0.0), vec3(1.0)),
+                                clamp(alpha_output * float(stage.op.w), 0.0, 1.0));
+
+        // Only the first four stages can update the combiner buffer
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4 && (combiner_buffer_input & (1 << i)) != 0) {
+            next_combiner_buffer.rgb = last_tex_env_out.rgb;
+        }
+        if (i < 4 && (combiner_buffer_input & (16 << i)) != 0) {
+            next_combiner_buffer.a = last_tex_env_out.a;
+        }
+    }
+
+    if (AlphaTestFails(last_tex_env_out.a)) {
+        discard;
+    }
+
+    if (fog_mode == FOG_MODE_FOG) {
+        float fog_index = (fog_flip != 0 ? 1.0 - depth : depth) * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_rg, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    }
+
+    gl_FragDepth = depth;
+    // Round the final fragment color to maintain the PICA's 8 bits of precision
+    color = byteround(last_tex_env_out);
+}
+)";
+
+    return out;
+}
+
 std::string GenerateTrivialVertexShader(bool separable_shader) {
     std::string out = "#version 330 core\n";
     if (separable_shader) {
@@ -230,6 +230,18 @@ std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config, bool se
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader);
 
+/**
+ * Generates the GLSL fragment uber-shader, which reads the configuration from the uber_fs_config
+ * uniform block instead of having it compiled in, so that one program covers every configuration
+ * IsFragmentUberShaderSupported accepts.
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+std::string GenerateFragmentUberShader(bool separable_shader);
+
+/// Returns true if the fragment uber-shader can render the given configuration
+bool IsFragmentUberShaderSupported(const PicaFSConfig& config);
+
 } // namespace OpenGL
 
 namespace std {
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <boost/container_hash/hash.hpp>
+#include <chrono>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <variant>
@@ -14,6 +16,11 @@
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 #include "video_core/video_core.h"
 
+// From GL_ARB_parallel_shader_compile, which the generated loader doesn't include
+#ifndef GL_COMPLETION_STATUS_ARB
+#define GL_COMPLETION_STATUS_ARB 0x91B1
+#endif
+
 namespace OpenGL {
 
 static u64 GetUniqueIdentifier(const Pica::Regs& registers, const std::vector<u32>& code) {
@@ -59,6 +66,8 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
     SetShaderUniformBlockBinding(shader, "shader_data", UniformBindings::Common,
                                  sizeof(UniformData));
     SetShaderUniformBlockBinding(shader, "vs_config", UniformBindings::VS, sizeof(VSUniformData));
+    SetShaderUniformBlockBinding(shader, "uber_fs_config", UniformBindings::UberFS,
+                                 sizeof(UberFSUniformData));
 }
 
 static void SetShaderSamplerBinding(GLuint shader, const char* name,
@@ -118,6 +127,83 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs,
                    });
 }
 
+void UberFSUniformData::SetFromConfig(const PicaFSConfig& config) {
+    using Pica::LightingRegs;
+    const auto& state = config.state;
+
+    alpha_test_func = static_cast<GLint>(state.alpha_test_func);
+    scissor_test_mode = static_cast<GLint>(state.scissor_test_mode);
+    texture0_type = static_cast<GLint>(state.texture0_type);
+    texture2_use_coord1 = state.texture2_use_coord1;
+    combiner_buffer_input = state.combiner_buffer_input;
+    depthmap_enable = static_cast<GLint>(state.depthmap_enable);
+    fog_mode = static_cast<GLint>(state.fog_mode);
+    fog_flip = state.fog_flip;
+
+    for (std::size_t i = 0; i < tev_stages.size(); ++i) {
+        const auto stage =
+            static_cast<const Pica::TexturingRegs::TevStageConfig>(state.tev_stages[i]);
+        tev_stages[i].color_source = {static_cast<GLint>(stage.color_source1.Value()),
+                                      static_cast<GLint>(stage.color_source2.Value()),
+                                      static_cast<GLint>(stage.color_source3.Value()), 0};
+        tev_stages[i].color_modifier = {static_cast<GLint>(stage.color_modifier1.Value()),
+                                        static_cast<GLint>(stage.color_modifier2.Value()),
+                                        static_cast<GLint>(stage.color_modifier3.Value()), 0};
+        tev_stages[i].alpha_source = {static_cast<GLint>(stage.alpha_source1.Value()),
+                                      static_cast<GLint>(stage.alpha_source2.Value()),
+                                      static_cast<GLint>(stage.alpha_source3.Value()), 0};
+        tev_stages[i].alpha_modifier = {static_cast<GLint>(stage.alpha_modifier1.Value()),
+                                        static_cast<GLint>(stage.alpha_modifier2.Value()),
+                                        static_cast<GLint>(stage.alpha_modifier3.Value()), 0};
+        tev_stages[i].op = {static_cast<GLint>(stage.color_op.Value()),
+                            static_cast<GLint>(stage.alpha_op.Value()),
+                            static_cast<GLint>(stage.GetColorMultiplier()),
+                            static_cast<GLint>(stage.GetAlphaMultiplier())};
+    }
+
+    const auto& lighting = state.lighting;
+    lighting_enable = lighting.enable;
+    lighting_src_num = lighting.src_num;
+    lighting_config = static_cast<GLint>(lighting.config);
+    lighting_bump_mode = static_cast<GLint>(lighting.bump_mode);
+    lighting_bump_selector = lighting.bump_selector;
+    lighting_bump_renorm = lighting.bump_renorm;
+    lighting_clamp_highlights = lighting.clamp_highlights;
+    lighting_enable_primary_alpha = lighting.enable_primary_alpha;
+    lighting_enable_secondary_alpha = lighting.enable_secondary_alpha;
+    lighting_enable_shadow = lighting.enable_shadow;
+    lighting_shadow_primary = lighting.shadow_primary;
+    lighting_shadow_secondary = lighting.shadow_secondary;
+    lighting_shadow_invert = lighting.shadow_invert;
+    lighting_shadow_alpha = lighting.shadow_alpha;
+    lighting_shadow_selector = lighting.shadow_selector;
+
+    // All slots are copied, the LUT inputs use the slot that matches a light's number
+    for (std::size_t i = 0; i < lights.size(); ++i) {
+        const auto& light = lighting.light[i];
+        lights[i] = {static_cast<GLint>(light.num), light.directional,
+                     light.two_sided_diffuse,       light.dist_atten_enable,
+                     light.spot_atten_enable,       light.geometric_factor_0,
+                     light.geometric_factor_1,      light.shadow_enable};
+    }
+
+    const auto set_lut = [&lighting](LightingLut& lut, const auto& lut_config,
+                                     LightingRegs::LightingSampler sampler) {
+        lut.enable = lut_config.enable &&
+                     LightingRegs::IsLightingSamplerSupported(lighting.config, sampler);
+        lut.abs_input = lut_config.abs_input;
+        lut.type = static_cast<GLint>(lut_config.type);
+        lut.scale = lut_config.scale;
+    };
+    set_lut(lighting_luts[0], lighting.lut_d0, LightingRegs::LightingSampler::Distribution0);
+    set_lut(lighting_luts[1], lighting.lut_d1, LightingRegs::LightingSampler::Distribution1);
+    set_lut(lighting_luts[2], lighting.lut_sp, LightingRegs::LightingSampler::SpotlightAttenuation);
+    set_lut(lighting_luts[3], lighting.lut_fr, LightingRegs::LightingSampler::Fresnel);
+    set_lut(lighting_luts[4], lighting.lut_rr, LightingRegs::LightingSampler::ReflectRed);
+    set_lut(lighting_luts[5], lighting.lut_rg, LightingRegs::LightingSampler::ReflectGreen);
+    set_lut(lighting_luts[6], lighting.lut_rb, LightingRegs::LightingSampler::ReflectBlue);
+}
+
 /**
  * An object representing a shader program staging. It can be either a shader object or a program
  * object, depending on whether separable program is used.
@@ -145,6 +231,74 @@ public:
         }
     }
 
+    /**
+     * Starts compiling a separable program without waiting for the driver, which compiles it on
+     * its own threads. The program can't be used before IsPending returns false. Requires
+     * GL_ARB_parallel_shader_compile.
+     */
+    void CreateInBackground(const char* source, GLenum type) {
+        OGLProgram& program = std::get<OGLProgram>(shader_or_program);
+        pending_shader.handle = glCreateShader(type);
+        glShaderSource(pending_shader.handle, 1, &source, nullptr);
+        glCompileShader(pending_shader.handle);
+
+        program.handle = glCreateProgram();
+        glProgramParameteri(program.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        glAttachShader(program.handle, pending_shader.handle);
+        glLinkProgram(program.handle);
+    }
+
+    bool IsPending() const {
+        return pending_shader.handle != 0;
+    }
+
+    /// Finishes a background compilation if the driver is done with it, never blocks
+    void Poll() {
+        if (!IsPending()) {
+            return;
+        }
+
+        GLint completed = GL_FALSE;
+        glGetProgramiv(std::get<OGLProgram>(shader_or_program).handle, GL_COMPLETION_STATUS_ARB,
+                       &completed);
+        if (completed == GL_TRUE) {
+            Finish();
+        }
+    }
+
+    /// Finishes a background compilation, waiting for the driver if needed
+    void Finish() {
+        if (!IsPending()) {
+            return;
+        }
+
+        const GLuint program = std::get<OGLProgram>(shader_or_program).handle;
+        GLint result = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &result);
+        if (result != GL_TRUE) {
+            GLint info_log_length = 0;
+            glGetShaderiv(pending_shader.handle, GL_INFO_LOG_LENGTH, &info_log_length);
+            if (info_log_length > 1) {
+                std::vector<char> shader_error(info_log_length);
+                glGetShaderInfoLog(pending_shader.handle, info_log_length, nullptr,
+                                   &shader_error[0]);
+                LOG_ERROR(Render_OpenGL, "Error compiling shader:\n{}", &shader_error[0]);
+            }
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
+            if (info_log_length > 1) {
+                std::vector<char> program_error(info_log_length);
+                glGetProgramInfoLog(program, info_log_length, nullptr, &program_error[0]);
+                LOG_ERROR(Render_OpenGL, "Error linking shader:\n{}", &program_error[0]);
+            }
+        }
+        ASSERT_MSG(result == GL_TRUE, "Shader not linked");
+
+        glDetachShader(program, pending_shader.handle);
+        pending_shader.Release();
+        SetShaderUniformBlockBindings(program);
+        SetShaderSamplerBindings(program);
+    }
+
     GLuint GetHandle() const {
         if (shader_or_program.index() == 0) {
             return std::get<OGLShader>(shader_or_program).handle;
@@ -155,6 +309,9 @@ public:
 
 private:
     std::variant<OGLShader, OGLProgram> shader_or_program;
+
+    /// Shader attached to the program while it is compiled in the background
+    OGLShader pending_shader;
 };
 
 class TrivialVertexShader {
@@ -240,20 +397,113 @@ using ProgrammableVertexShaders =
 using FixedGeometryShaders =
     ShaderCache<PicaFixedGSConfig, &GenerateFixedGeometryShader, GL_GEOMETRY_SHADER>;
 
-using FragmentShaders = ShaderCache<PicaFSConfig, &GenerateFragmentShader, GL_FRAGMENT_SHADER>;
+// This is the cache for the specialized fragment shaders. They can be compiled in the background
+// while the uber-shader renders in their place, and their compile times are logged so that they
+// can be compared with the uber-shader's.
+class FragmentShaders {
+public:
+    struct Entry {
+        explicit Entry(bool separable) : shader(separable) {}
+
+        OGLShaderStage shader;
+        std::chrono::steady_clock::time_point compile_start;
+    };
+
+    explicit FragmentShaders(bool separable) : separable(separable) {}
+
+    /**
+     * Returns the entry for the given config and whether it was just created. If `background` is
+     * set, new shaders are compiled in the background and remain pending until Poll finishes
+     * them, otherwise this returns once the shader is ready.
+     */
+    std::tuple<Entry*, bool> Get(const PicaFSConfig& config, bool background) {
+        auto [iter, new_shader] = shaders.try_emplace(config, separable);
+        Entry& entry = iter->second;
+        if (new_shader) {
+            entry.compile_start = std::chrono::steady_clock::now();
+            const std::string result = GenerateFragmentShader(config, separable);
+            if (background) {
+                entry.shader.CreateInBackground(result.c_str(), GL_FRAGMENT_SHADER);
+                return {&entry, true};
+            }
+            entry.shader.Create(result.c_str(), GL_FRAGMENT_SHADER);
+            LogCompileTime(entry, "");
+        } else if (!background && entry.shader.IsPending()) {
+            entry.shader.Finish();
+            LogCompileTime(entry, " (waited for the background compilation)");
+        }
+        return {&entry, new_shader};
+    }
+
+    /// Returns true once the shader of an entry is ready, never blocks
+    static bool Poll(Entry& entry) {
+        if (!entry.shader.IsPending()) {
+            return true;
+        }
+        entry.shader.Poll();
+        if (entry.shader.IsPending()) {
+            return false;
+        }
+        LogCompileTime(entry, " in the background");
+        return true;
+    }
+
+private:
+    static void LogCompileTime(const Entry& entry, std::string_view how) {
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - entry.compile_start;
+        LOG_INFO(Render_OpenGL, "Compiled a fragment shader variant{} in {:.2f} ms", how,
+                 time.count());
+    }
+
+    bool separable;
+    std::unordered_map<PicaFSConfig, Entry> shaders;
+};
+
+static bool IsParallelShaderCompileSupported() {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const std::string_view extension =
+            reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension == "GL_ARB_parallel_shader_compile" ||
+            extension == "GL_KHR_parallel_shader_compile") {
+            return true;
+        }
+    }
+    return false;
+}
 
 class ShaderProgramManager::Impl {
 public:
     explicit Impl(bool separable, bool enable_hacks)
-        : enable_hacks(enable_hacks), separable(separable), programmable_vertex_shaders(separable),
-          trivial_vertex_shader(separable), fixed_geometry_shaders(separable),
-          fragment_shaders(separable) {
+        : enable_hacks(enable_hacks), separable(separable),
+          // Only separable programs can be compiled in the background, the others are linked
+          // together with the vertex and geometry shaders when they are used
+          background_compile(separable && IsParallelShaderCompileSupported()),
+          programmable_vertex_shaders(separable), trivial_vertex_shader(separable),
+          fixed_geometry_shaders(separable), fragment_shaders(separable),
+          uber_fragment_shader(separable) {
         if (separable) {
             pipeline.Create();
         }
         disk_cache = std::make_unique<ShaderDiskCache>(separable);
     }
 
+    /// Returns the fragment uber-shader, compiling it on first use
+    GLuint GetUberFragmentShader() {
+        if (uber_fragment_shader.GetHandle() == 0) {
+            const auto start = std::chrono::steady_clock::now();
+            const std::string result = GenerateFragmentUberShader(separable);
+            uber_fragment_shader.Create(result.c_str(), GL_FRAGMENT_SHADER);
+            const std::chrono::duration<double, std::milli> time =
+                std::chrono::steady_clock::now() - start;
+            LOG_INFO(Render_OpenGL, "Compiled the fragment uber-shader in {:.2f} ms",
+                     time.count());
+        }
+        return uber_fragment_shader.GetHandle();
+    }
+
     struct ShaderTuple {
         GLuint vs = 0;
         GLuint gs = 0;
@@ -280,6 +530,7 @@ public:
 
     bool enable_hacks;
     bool separable;
+    bool background_compile;
 
     ShaderTuple current;
 
@@ -289,6 +540,11 @@ public:
     FixedGeometryShaders fixed_geometry_shaders;
 
     FragmentShaders fragment_shaders;
+    OGLShaderStage uber_fragment_shader;
+
+    /// Specialized fragment shader that replaces the uber-shader once it is compiled
+    FragmentShaders::Entry* pending_fragment_shader = nullptr;
+
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
     std::unique_ptr<ShaderDiskCache> disk_cache;
@@ -332,19 +588,48 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
     impl->current.gs = 0;
 }
 
-void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
+bool ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs,
+                                             UberFSUniformData& uber_uniforms) {
     PicaFSConfig config = PicaFSConfig::BuildFromRegs(regs);
-    auto [handle, new_shader] = impl->fragment_shaders.Get(config);
-    impl->current.fs = handle;
+    impl->pending_fragment_shader = nullptr;
+
+    const bool uber_shader_supported = IsFragmentUberShaderSupported(config);
+    if (uber_shader_supported && Settings::values.always_use_uber_shader) {
+        impl->current.fs = impl->GetUberFragmentShader();
+        uber_uniforms.SetFromConfig(config);
+        return true;
+    }
+
+    const bool background = uber_shader_supported && impl->background_compile &&
+                            Settings::values.use_uber_shader_while_compiling;
+    auto [fs_entry, new_shader] = impl->fragment_shaders.Get(config, background);
+    bool use_uber_shader = false;
+    if (FragmentShaders::Poll(*fs_entry)) {
+        impl->current.fs = fs_entry->shader.GetHandle();
+    } else {
+        impl->current.fs = impl->GetUberFragmentShader();
+        impl->pending_fragment_shader = fs_entry;
+        uber_uniforms.SetFromConfig(config);
+        use_uber_shader = true;
+    }
+
     if (Settings::values.use_hardware_shader && Settings::values.enable_disk_shader_cache &&
         new_shader) {
         u64 unique_identifier = GetUniqueIdentifier(regs, {});
         ShaderDiskCacheEntry entry{unique_identifier, ProgramType::FS, regs, {}};
         impl->disk_cache->Add(entry);
     }
+
+    return use_uber_shader;
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
+    if (impl->pending_fragment_shader != nullptr &&
+        FragmentShaders::Poll(*impl->pending_fragment_shader)) {
+        impl->current.fs = impl->pending_fragment_shader->shader.GetHandle();
+        impl->pending_fragment_shader = nullptr;
+    }
+
     if (impl->separable) {
         if (impl->enable_hacks) {
             // Without this reseting, AMD sometimes freezes when one stage is changed but not
@@ -399,8 +684,8 @@ void ShaderProgramManager::LoadDiskCache() {
             handle = h;
         } else if (entry.GetType() == ProgramType::FS) {
             PicaFSConfig conf = PicaFSConfig::BuildFromRegs(entry.GetRegisters());
-            auto [h, _] = impl->fragment_shaders.Get(conf);
-            handle = h;
+            auto [fs_entry, _] = impl->fragment_shaders.Get(conf, false);
+            handle = fs_entry->shader.GetHandle();
         } else {
             LOG_ERROR(Render_OpenGL,
                       "Unsupported shader type ({}) found in disk shader cache, deleting it",
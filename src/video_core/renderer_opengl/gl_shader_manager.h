@@ -19,7 +19,7 @@ class System;
 
 namespace OpenGL {
 
-enum class UniformBindings : GLuint { Common, VS, GS };
+enum class UniformBindings : GLuint { Common, VS, GS, UberFS };
 
 struct LightSrc {
     alignas(16) GLvec3 specular_0;
@@ -96,6 +96,72 @@ static_assert(
 static_assert(sizeof(VSUniformData) < 16384,
               "VSUniformData structure must be less than 16kb as per the OpenGL spec");
 
+/// Uniform struct for the Uniform Buffer Object that contains the configuration the fragment
+/// uber-shader emulates, all values are unpacked from PicaFSConfig.
+// NOTE: the same rule from UniformData also applies here.
+struct UberFSUniformData {
+    void SetFromConfig(const PicaFSConfig& config);
+
+    struct TevStage {
+        alignas(16) GLivec4 color_source;
+        alignas(16) GLivec4 color_modifier;
+        alignas(16) GLivec4 alpha_source;
+        alignas(16) GLivec4 alpha_modifier;
+        // Color operation, alpha operation, color multiplier and alpha multiplier
+        alignas(16) GLivec4 op;
+    };
+
+    struct alignas(16) Light {
+        GLint num;
+        GLint directional;
+        GLint two_sided_diffuse;
+        GLint dist_atten_enable;
+        GLint spot_atten_enable;
+        GLint geometric_factor_0;
+        GLint geometric_factor_1;
+        GLint shadow_enable;
+    };
+
+    struct alignas(16) LightingLut {
+        GLint enable;
+        GLint abs_input;
+        GLint type;
+        GLfloat scale;
+    };
+
+    GLint alpha_test_func;
+    GLint scissor_test_mode;
+    GLint texture0_type;
+    GLint texture2_use_coord1;
+    GLint combiner_buffer_input;
+    GLint depthmap_enable;
+    GLint fog_mode;
+    GLint fog_flip;
+    GLint lighting_enable;
+    GLint lighting_src_num;
+    GLint lighting_config;
+    GLint lighting_bump_mode;
+    GLint lighting_bump_selector;
+    GLint lighting_bump_renorm;
+    GLint lighting_clamp_highlights;
+    GLint lighting_enable_primary_alpha;
+    GLint lighting_enable_secondary_alpha;
+    GLint lighting_enable_shadow;
+    GLint lighting_shadow_primary;
+    GLint lighting_shadow_secondary;
+    GLint lighting_shadow_invert;
+    GLint lighting_shadow_alpha;
+    GLint lighting_shadow_selector;
+    alignas(16) std::array<TevStage, 6> tev_stages;
+    std::array<Light, 8> lights;
+    std::array<LightingLut, 7> lighting_luts; // D0, D1, SP, FR, RR, RG and RB
+};
+static_assert(
+    sizeof(UberFSUniformData) == 0x3B0,
+    "The size of the UberFSUniformData structure has changed, update the structure in the shader");
+static_assert(sizeof(UberFSUniformData) < 16384,
+              "UberFSUniformData structure must be less than 16kb as per the OpenGL spec");
+
 /// A class that manage different shader stages and configures them with given config data.
 class ShaderProgramManager {
 public:
@@ -106,7 +172,15 @@ public:
     void UseTrivialVertexShader();
     void UseFixedGeometryShader(const Pica::Regs& regs);
     void UseTrivialGeometryShader();
-    void UseFragmentShader(const Pica::Regs& config);
+
+    /**
+     * Selects the fragment shader for the given configuration. The uber-shader is used in its
+     * place if it is always enabled, or while the specialized shader compiles in the background.
+     * @returns true if the uber-shader may be used until the next call, uber_uniforms is updated
+     *          for it in that case
+     */
+    bool UseFragmentShader(const Pica::Regs& config, UberFSUniformData& uber_uniforms);
+
     void ApplyTo(OpenGLState& state);
     void LoadDiskCache();
 
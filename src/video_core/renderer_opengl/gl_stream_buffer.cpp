@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include "common/alignment.h"
@@ -33,8 +34,11 @@ OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size, bool double_siz
         GLbitfield flags =
             GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | (coherent ? GL_MAP_COHERENT_BIT : 0);
         glBufferStorage(gl_target, allocate_size, nullptr, flags);
+        // The buffer is mapped once and synchronized with fences, see Map
         mapped_ptr = static_cast<u8*>(glMapBufferRange(
-            gl_target, 0, buffer_size, flags | (coherent ? 0 : GL_MAP_FLUSH_EXPLICIT_BIT)));
+            gl_target, 0, buffer_size,
+            flags | (coherent ? 0 : GL_MAP_FLUSH_EXPLICIT_BIT)));
+        mapped_offset = 0;
     } else {
         glBufferData(gl_target, allocate_size, nullptr, GL_STREAM_DRAW);
     }
@@ -69,15 +73,25 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
     if (buffer_pos + size > buffer_size) {
         buffer_pos = 0;
         invalidate = true;
+    }
 
-        if (persistent) {
-            glUnmapBuffer(gl_target);
+    if (persistent) {
+        // Everything unmapped so far has been consumed by commands that were already issued, so
+        // this is the point where the regions written since the last fence can be fenced
+        if (invalidate) {
+            FenceRegions(fenced_region, NUM_SYNC_REGIONS);
+            fenced_region = 0;
+        } else {
+            const std::size_t current_region = GetRegion(buffer_pos);
+            FenceRegions(fenced_region, current_region);
+            fenced_region = current_region;
         }
-    }
 
-    if (invalidate || !persistent) {
-        GLbitfield flags = GL_MAP_WRITE_BIT | (persistent ? GL_MAP_PERSISTENT_BIT : 0) |
-                           (coherent ? GL_MAP_COHERENT_BIT : GL_MAP_FLUSH_EXPLICIT_BIT) |
+        if (size > 0) {
+            WaitRegions(GetRegion(buffer_pos), GetRegion(buffer_pos + size - 1) + 1);
+        }
+    } else {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT |
                            (invalidate ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_UNSYNCHRONIZED_BIT);
         mapped_ptr = static_cast<u8*>(
             glMapBufferRange(gl_target, buffer_pos, buffer_size - buffer_pos, flags));
@@ -87,6 +101,33 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
     return std::make_tuple(mapped_ptr + buffer_pos - mapped_offset, buffer_pos, invalidate);
 }
 
+std::size_t OGLStreamBuffer::GetRegion(GLintptr offset) const {
+    return std::min(static_cast<std::size_t>(offset * NUM_SYNC_REGIONS / buffer_size),
+                    NUM_SYNC_REGIONS - 1);
+}
+
+void OGLStreamBuffer::FenceRegions(std::size_t begin, std::size_t end) {
+    for (std::size_t region = begin; region < end; ++region) {
+        // Regions skipped at the end of the buffer may still hold a fence from the previous pass,
+        // which is superseded by the new one since fences signal in order
+        region_syncs[region].Release();
+        region_syncs[region].Create();
+    }
+}
+
+void OGLStreamBuffer::WaitRegions(std::size_t begin, std::size_t end) {
+    for (std::size_t region = begin; region < end; ++region) {
+        OGLSync& sync = region_syncs[region];
+        if (sync.handle == nullptr) {
+            continue;
+        }
+
+        // This only blocks if the GPU is a whole buffer behind
+        glClientWaitSync(sync.handle, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        sync.Release();
+    }
+}
+
 void OGLStreamBuffer::Unmap(GLsizeiptr size) {
     ASSERT(size <= mapped_size);
 
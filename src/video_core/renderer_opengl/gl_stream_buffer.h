@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <glad/glad.h>
 #include <tuple>
 #include "common/common_types.h"
@@ -23,7 +24,9 @@ public:
     /*
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
-     * If the buffer is full, the whole buffer is reallocated which invalidates old chunks.
+     * If the buffer is full, it wraps around to the start which invalidates old chunks. With
+     * ARB_buffer_storage the buffer stays persistently mapped and a wrap only waits for the GPU
+     * to be done with the regions that are about to be overwritten.
      * The return values are the pointer to the new chunk, the offset within the buffer,
      * and the invalidation flag for previous chunks.
      * The actual used size must be specified on unmapping the chunk.
@@ -33,6 +36,17 @@ public:
     void Unmap(GLsizeiptr size);
 
 private:
+    /// Number of regions the persistent buffer is split into for fencing
+    static constexpr std::size_t NUM_SYNC_REGIONS = 16;
+
+    std::size_t GetRegion(GLintptr offset) const;
+
+    /// Fences regions [begin, end) that were written since the last fence
+    void FenceRegions(std::size_t begin, std::size_t end);
+
+    /// Waits for the GPU to be done with regions [begin, end)
+    void WaitRegions(std::size_t begin, std::size_t end);
+
     OGLBuffer gl_buffer;
     GLenum gl_target;
 
@@ -44,6 +58,9 @@ private:
     GLintptr mapped_offset = 0;
     GLsizeiptr mapped_size = 0;
     u8* mapped_ptr = nullptr;
+
+    std::array<OGLSync, NUM_SYNC_REGIONS> region_syncs;
+    std::size_t fenced_region = 0; ///< First region written to since the last fence
 };
 
 } // namespace OpenGL
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <glad/glad.h>
 #include <memory>
 #include "common/assert.h"
@@ -12,6 +13,8 @@
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/frame_dumper.h"
+#include "core/frame_feed.h"
 #include "core/frontend/emu_window.h"
 #include "core/frontend/framebuffer_layout.h"
 #include "core/hw/gpu.h"
@@ -20,6 +23,7 @@
 #include "core/memory.h"
 #include "core/settings.h"
 #include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_call_counter.h"
 #include "video_core/renderer_opengl/post_processing_opengl.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
@@ -271,48 +275,70 @@ void RendererOpenGL::SwapBuffers() {
         }
     }
 
-    if (VideoCore::g_renderer_screenshot_requested) {
-        // Draw this frame to the screenshot framebuffer
-        screenshot_framebuffer.Create();
-        GLuint old_read_fb = state.draw.read_framebuffer;
-        GLuint old_draw_fb = state.draw.draw_framebuffer;
-        state.draw.read_framebuffer = state.draw.draw_framebuffer = screenshot_framebuffer.handle;
-        state.Apply();
-
-        Layout::FramebufferLayout layout{VideoCore::g_screenshot_framebuffer_layout};
-
-        GLuint renderbuffer;
-        glGenRenderbuffers(1, &renderbuffer);
-        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB8, layout.width, layout.height);
-        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
-                                  renderbuffer);
+    // Hand finished readbacks to their consumers before starting new ones
+    screenshot_readback.Poll();
+    frame_dump_readback.Poll();
+    frame_feed_readback.Poll();
 
-        DrawScreens(layout);
+    const auto draw = [this](const Layout::FramebufferLayout& layout) { DrawScreens(layout); };
 
-        glReadPixels(0, 0, layout.width, layout.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV,
-                     VideoCore::g_screenshot_bits);
+    if (VideoCore::g_renderer_screenshot_requested && !screenshot_in_flight) {
+        const Layout::FramebufferLayout layout{VideoCore::g_screenshot_framebuffer_layout};
+        const auto callback = [this, layout](const u8* data) {
+            if (data != nullptr) {
+                std::memcpy(VideoCore::g_screenshot_bits, data, layout.width * layout.height * 4);
+            }
+            screenshot_in_flight = false;
+            VideoCore::g_screenshot_complete_callback();
+            VideoCore::g_renderer_screenshot_requested = false;
+        };
+        screenshot_in_flight = screenshot_readback.Capture(layout, draw, callback);
+    }
 
-        screenshot_framebuffer.Release();
-        state.draw.read_framebuffer = old_read_fb;
-        state.draw.draw_framebuffer = old_draw_fb;
-        state.Apply();
-        glDeleteRenderbuffers(1, &renderbuffer);
+    Core::FrameDumper& dumper = Core::System::GetInstance().FrameDumper();
+    if (dumper.IsDumping()) {
+        const Core::FrameDumper::FrameToken token = dumper.ReserveFrame();
+        if (!frame_dump_readback.Capture(
+                dumper.GetLayout(), draw,
+                [&dumper, token](const u8* data) { dumper.AddVideoFrame(token, data); })) {
+            // Every buffer is still in flight, repeat the previous frame to keep the timing
+            dumper.RepeatFrame(token);
+        }
+    }
 
-        VideoCore::g_screenshot_complete_callback();
-        VideoCore::g_renderer_screenshot_requested = false;
+    Core::FrameFeed& feed = Core::System::GetInstance().FrameFeed();
+    if (feed.IsActive()) {
+        // A frame that can't be read back is skipped, consumers see a gap in the sequence
+        const Core::FrameFeed::FrameToken token = feed.ReserveFrame(static_cast<u64>(
+            Core::System::GetInstance().CoreTiming().GetGlobalTimeUs().count()));
+        frame_feed_readback.Capture(token.layout, draw, [&feed, token](const u8* data) {
+            feed.PublishFrame(token, data);
+        });
     }
 
     DrawScreens(render_window.GetFramebufferLayout());
+    GLCallCounter::EndFrame();
 
     Core::System::GetInstance().perf_stats->EndSystemFrame();
 
+    // Without VSync, precise frame pacing waits before swapping buffers, so that frames are
+    // presented at the paced times instead of the time it took to render them later
+    const bool limit_before_swap =
+        Settings::values.precise_frame_pacing && !Settings::values.enable_vsync;
+
     // Swap buffers
     render_window.PollEvents();
+    if (limit_before_swap) {
+        Core::System::GetInstance().frame_limiter.DoFrameLimiting(
+            Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
+    }
     render_window.SwapBuffers();
+    Core::System::GetInstance().perf_stats->RecordPresent();
 
-    Core::System::GetInstance().frame_limiter.DoFrameLimiting(
-        Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
+    if (!limit_before_swap) {
+        Core::System::GetInstance().frame_limiter.DoFrameLimiting(
+            Core::System::GetInstance().CoreTiming().GetGlobalTimeUs());
+    }
     Core::System::GetInstance().perf_stats->BeginSystemFrame();
 
     prev_state.Apply();
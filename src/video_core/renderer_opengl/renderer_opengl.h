@@ -10,6 +10,7 @@
 #include "common/math_util.h"
 #include "core/hw/gpu.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/frame_dumper_opengl.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 
@@ -71,9 +72,15 @@ private:
     OGLVertexArray vertex_array;
     OGLBuffer vertex_buffer;
     OGLProgram shader;
-    OGLFramebuffer screenshot_framebuffer;
     OGLSampler filter_sampler;
 
+    // Asynchronous readbacks for screenshots, frame dumping and the frame feed. Each has its own
+    // ring of buffers, so one consumer falling behind doesn't make the others drop frames.
+    FrameDumperOpenGL screenshot_readback{state};
+    FrameDumperOpenGL frame_dump_readback{state};
+    FrameDumperOpenGL frame_feed_readback{state};
+    bool screenshot_in_flight = false;
+
     /// Display information for top and bottom screens respectively
     std::array<ScreenInfo, 3> screen_infos;
 
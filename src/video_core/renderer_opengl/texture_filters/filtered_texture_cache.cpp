@@ -0,0 +1,253 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include <stb_image.h>
+#include <stb_image_write.h>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/texture_filters/filtered_texture_cache.h"
+
+namespace OpenGL {
+
+/// Decoded textures kept in memory
+constexpr std::size_t MEMORY_BUDGET = 256 * 1024 * 1024;
+
+/// Read backs in flight, textures filtered while this many are pending aren't cached this time
+constexpr std::size_t MAX_READBACKS = 8;
+
+FilteredTextureCache::FilteredTextureCache(std::string_view filter_name) {
+    u64 program_id = 0;
+    if (Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id) !=
+            Loader::ResultStatus::Success ||
+        program_id == 0) {
+        LOG_WARNING(Render_OpenGL, "Program ID unknown, not caching filtered textures");
+        return;
+    }
+
+    const std::string path =
+        fmt::format("{}filtered_textures/{:016X}/{}/",
+                    FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), program_id, filter_name);
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_ERROR(Render_OpenGL, "Unable to create {}", path);
+        return;
+    }
+
+    directory = path;
+    worker_thread = std::thread(&FilteredTextureCache::WorkerThread, this);
+}
+
+FilteredTextureCache::~FilteredTextureCache() {
+    if (worker_thread.joinable()) {
+        // Textures that are still being read back are lost, the ones queued for saving aren't
+        jobs.Push(Job{});
+        worker_thread.join();
+    }
+}
+
+u64 FilteredTextureCache::ComputeKey(const std::vector<u8>& unscaled_data,
+                                     SurfaceParams::PixelFormat pixel_format, u32 width,
+                                     u32 height, u16 res_scale) {
+    struct {
+        u64 data_hash;
+        u32 pixel_format;
+        u32 width;
+        u32 height;
+        u32 res_scale;
+    } key{Common::ComputeHash64(unscaled_data.data(), unscaled_data.size()),
+          static_cast<u32>(pixel_format), width, height, res_scale};
+
+    return Common::ComputeStructHash64(key);
+}
+
+std::shared_ptr<const FilteredTextureCache::Entry> FilteredTextureCache::Find(u64 key) {
+    if (directory.empty()) {
+        return nullptr;
+    }
+
+    std::lock_guard lock(mutex);
+
+    if (const auto iter = memory.find(key); iter != memory.end()) {
+        lru.splice(lru.begin(), lru, iter->second.lru_iterator);
+        return iter->second.entry;
+    }
+
+    if (stored_keys.count(key) != 0 && loading_keys.insert(key).second) {
+        jobs.Push(Job{Job::Type::Load, key, nullptr});
+    }
+
+    return nullptr;
+}
+
+void FilteredTextureCache::Store(u64 key, GLuint texture, u32 width, u32 height,
+                                 GLuint read_fb_handle) {
+    if (directory.empty() || readbacks.size() >= MAX_READBACKS ||
+        std::any_of(readbacks.begin(), readbacks.end(),
+                    [key](const Readback& readback) { return readback.key == key; })) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        if (stored_keys.count(key) != 0 || memory.count(key) != 0) {
+            return;
+        }
+    }
+
+    OpenGLState state = OpenGLState::GetCurState();
+    OpenGLState prev_state = state;
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    state.ResetTexture(texture);
+    state.draw.read_framebuffer = read_fb_handle;
+    state.Apply();
+
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+
+    Readback& readback = readbacks.emplace_back();
+    readback.key = key;
+    readback.width = width;
+    readback.height = height;
+    readback.buffer.Create();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.handle);
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width * height * 4), nullptr,
+                 GL_STREAM_READ);
+    glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.sync.Create();
+}
+
+void FilteredTextureCache::Poll() {
+    auto iter = readbacks.begin();
+    while (iter != readbacks.end()) {
+        const GLenum status = glClientWaitSync(iter->sync.handle, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ++iter;
+            continue;
+        }
+
+        if (status != GL_WAIT_FAILED) {
+            auto entry = std::make_shared<Entry>();
+            entry->width = iter->width;
+            entry->height = iter->height;
+            entry->pixels.resize(iter->width * iter->height * 4);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, iter->buffer.handle);
+            const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                static_cast<GLsizeiptr>(entry->pixels.size()),
+                                                GL_MAP_READ_BIT);
+            if (data != nullptr) {
+                std::memcpy(entry->pixels.data(), data, entry->pixels.size());
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+                std::lock_guard lock(mutex);
+                stored_keys.insert(iter->key);
+                Insert(iter->key, entry);
+                jobs.Push(Job{Job::Type::Save, iter->key, std::move(entry)});
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        iter = readbacks.erase(iter);
+    }
+}
+
+std::string FilteredTextureCache::GetPath(u64 key) const {
+    return fmt::format("{}{:016X}.png", directory, key);
+}
+
+void FilteredTextureCache::Insert(u64 key, std::shared_ptr<const Entry> entry) {
+    if (memory.count(key) != 0) {
+        return;
+    }
+
+    const std::size_t size = entry->pixels.size();
+    while (!lru.empty() && memory_size + size > MEMORY_BUDGET) {
+        const auto iter = memory.find(lru.back());
+        memory_size -= iter->second.entry->pixels.size();
+        memory.erase(iter);
+        lru.pop_back();
+    }
+
+    lru.push_front(key);
+    memory.emplace(key, MemoryEntry{std::move(entry), lru.begin()});
+    memory_size += size;
+}
+
+void FilteredTextureCache::WorkerThread() {
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, directory,
+        [this](u64*, const std::string&, const std::string& virtual_name) {
+            if (virtual_name.size() != 20 || virtual_name.substr(16) != ".png" ||
+                virtual_name.find_first_not_of("0123456789ABCDEF") != 16) {
+                return true;
+            }
+
+            std::lock_guard lock(mutex);
+            stored_keys.insert(std::stoull(virtual_name.substr(0, 16), nullptr, 16));
+            return true;
+        });
+
+    while (true) {
+        Job job = jobs.PopWait();
+
+        switch (job.type) {
+        case Job::Type::Load: {
+            const std::string path = GetPath(job.key);
+            int width = 0;
+            int height = 0;
+            u8* pixels = stbi_load(path.c_str(), &width, &height, nullptr, 4);
+
+            std::lock_guard lock(mutex);
+            loading_keys.erase(job.key);
+
+            if (pixels == nullptr) {
+                LOG_ERROR(Render_OpenGL, "Failed to load {}", path);
+                stored_keys.erase(job.key);
+                FileUtil::Delete(path);
+                break;
+            }
+
+            auto entry = std::make_shared<Entry>();
+            entry->width = static_cast<u32>(width);
+            entry->height = static_cast<u32>(height);
+            entry->pixels.assign(pixels, pixels + width * height * 4);
+            stbi_image_free(pixels);
+
+            Insert(job.key, std::move(entry));
+            break;
+        }
+
+        case Job::Type::Save: {
+            const std::string path = GetPath(job.key);
+            const Entry& entry = *job.entry;
+            if (stbi_write_png(path.c_str(), static_cast<int>(entry.width),
+                               static_cast<int>(entry.height), 4, entry.pixels.data(),
+                               static_cast<int>(entry.width) * 4) == 0) {
+                LOG_ERROR(Render_OpenGL, "Failed to save {}", path);
+
+                std::lock_guard lock(mutex);
+                stored_keys.erase(job.key);
+            }
+            break;
+        }
+
+        case Job::Type::Exit:
+            return;
+        }
+    }
+}
+
+} // namespace OpenGL
@@ -0,0 +1,109 @@
+// Copyright 2020 vvctre project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_surface_params.h"
+
+namespace OpenGL {
+
+/**
+ * Keeps the results of a texture filter, so that textures that were filtered once (in this or in
+ * a previous session) don't have to be filtered again.
+ *
+ * Filtered textures are read back without stalling the GPU, kept decoded in memory up to a budget,
+ * and saved as PNG files to <cache directory>/filtered_textures/<program ID>/<filter>/. Files are
+ * decoded and encoded on a worker thread, so a texture that is only on disk is filtered again the
+ * first time it's used, and uploaded from the cache once it's loaded.
+ */
+class FilteredTextureCache {
+public:
+    struct Entry {
+        u32 width = 0;
+        u32 height = 0;
+        std::vector<u8> pixels; ///< RGBA8, in OpenGL row order
+    };
+
+    explicit FilteredTextureCache(std::string_view filter_name);
+    ~FilteredTextureCache();
+
+    /// Returns the key of a texture, unscaled_data is the surface's gl_buffer
+    static u64 ComputeKey(const std::vector<u8>& unscaled_data,
+                          SurfaceParams::PixelFormat pixel_format, u32 width, u32 height,
+                          u16 res_scale);
+
+    /**
+     * Returns the filtered texture if it's in memory. If it's only on disk, starts loading it and
+     * returns nullptr.
+     */
+    std::shared_ptr<const Entry> Find(u64 key);
+
+    /**
+     * Starts reading back a texture that was just filtered, it's added to the cache by a later
+     * call to Poll once the GPU is done.
+     */
+    void Store(u64 key, GLuint texture, u32 width, u32 height, GLuint read_fb_handle);
+
+    /// Adds the read backs that are finished to the cache
+    void Poll();
+
+private:
+    struct Readback {
+        u64 key;
+        u32 width;
+        u32 height;
+        OGLBuffer buffer;
+        OGLSync sync;
+    };
+
+    struct Job {
+        enum class Type { Load, Save, Exit };
+
+        Type type = Type::Exit;
+        u64 key = 0;
+        std::shared_ptr<const Entry> entry; ///< Texture to save
+    };
+
+    struct MemoryEntry {
+        std::shared_ptr<const Entry> entry;
+        std::list<u64>::iterator lru_iterator;
+    };
+
+    std::string GetPath(u64 key) const;
+
+    /// Adds a texture to memory, evicting the least recently used ones if it's over the budget.
+    /// mutex must be held.
+    void Insert(u64 key, std::shared_ptr<const Entry> entry);
+
+    void WorkerThread();
+
+    std::string directory; ///< Empty if the cache is disabled
+    std::vector<Readback> readbacks;
+
+    // Shared with the worker thread
+    std::mutex mutex;
+    std::unordered_map<u64, MemoryEntry> memory;
+    std::list<u64> lru; ///< Keys in memory, most recently used first
+    std::size_t memory_size = 0;
+    std::unordered_set<u64> stored_keys;  ///< Keys on disk or being saved
+    std::unordered_set<u64> loading_keys; ///< Keys being loaded from disk
+
+    Common::SPSCQueue<Job> jobs;
+    std::thread worker_thread;
+};
+
+} // namespace OpenGL
@@ -61,6 +61,10 @@ bool TextureFilterer::IsNull() const {
     return filter == nullptr;
 }
 
+std::string_view TextureFilterer::GetFilterName() const {
+    return filter_name;
+}
+
 bool TextureFilterer::Filter(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint dst_tex,
                              const Common::Rectangle<u32>& dst_rect,
                              SurfaceParams::SurfaceType type, GLuint read_fb_handle,
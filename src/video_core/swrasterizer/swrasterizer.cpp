@@ -4,6 +4,7 @@
 
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/video_core.h"
 
 namespace VideoCore {
 
@@ -13,4 +14,11 @@ void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::DrawTriangles() {
+    // The triangles were already rasterized as they were added
+    if (g_draw_callback) {
+        g_draw_callback();
+    }
+}
+
 } // namespace VideoCore
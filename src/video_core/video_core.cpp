@@ -25,6 +25,7 @@ std::atomic<bool> g_renderer_screenshot_requested;
 void* g_screenshot_bits;
 std::function<void()> g_screenshot_complete_callback;
 Layout::FramebufferLayout g_screenshot_framebuffer_layout;
+std::function<void()> g_draw_callback;
 Memory::MemorySystem* g_memory;
 
 void Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory) {
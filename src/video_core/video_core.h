@@ -35,6 +35,10 @@ extern std::function<void()> g_screenshot_complete_callback;
 extern Layout::FramebufferLayout g_screenshot_framebuffer_layout;
 extern Memory::MemorySystem* g_memory;
 
+/// Called after the rasterizer issued a draw when set, used by the GPU trace player to time draws.
+/// Software processed triangles count once their batch is drawn, which can merge several draws.
+extern std::function<void()> g_draw_callback;
+
 void Init(Frontend::EmuWindow& emu_window, Memory::MemorySystem& memory);
 
 void Shutdown();
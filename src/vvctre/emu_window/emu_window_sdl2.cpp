@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <cfloat>
 #include <csignal>
 #include <cstdlib>
 #include <ctime>
@@ -44,6 +46,8 @@
 #include "core/file_sys/archive_extsavedata.h"
 #include "core/file_sys/archive_source_sd_savedata.h"
 #include "core/file_sys/ncch_container.h"
+#include "core/frame_dumper.h"
+#include "core/gpu_trace.h"
 #include "core/hle/applets/mii_selector.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cfg/cfg.h"
@@ -58,6 +62,7 @@
 #include "input_common/sdl/sdl.h"
 #include "network/room_member.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_call_counter.h"
 #include "video_core/renderer_opengl/texture_filters/texture_filterer.h"
 #include "video_core/video_core.h"
 #include "vvctre/common.h"
@@ -1044,6 +1049,36 @@ void EmuWindow_SDL2::SwapBuffers() {
             menu_open = true;
         }
 
+        if (OpenGL::GLCallCounter::IsEnabled()) {
+            const OpenGL::GLCallCounter::Counts& counts =
+                OpenGL::GLCallCounter::GetLastFrameCounts();
+            ImGui::TextColored(fps_color, "%llu GL calls, %llu draws, %llu batches",
+                               static_cast<unsigned long long>(counts.calls),
+                               static_cast<unsigned long long>(counts.draw_calls),
+                               static_cast<unsigned long long>(counts.batches));
+        }
+
+        if (show_frame_pacing) {
+            const Core::DurationHistogram& pacing_error =
+                system.frame_limiter.GetPacingErrorHistogram();
+            const Core::DurationHistogram& input_latency =
+                system.perf_stats->GetInputLatencyHistogram();
+            ImGui::TextColored(fps_color, "Pacing error: %lld us median, %lld us 99th percentile",
+                               static_cast<long long>(pacing_error.GetPercentile(50).count()),
+                               static_cast<long long>(pacing_error.GetPercentile(99).count()));
+            ImGui::TextColored(
+                fps_color, "Input to present: %lld ms median, %lld ms 99th percentile",
+                static_cast<long long>(input_latency.GetPercentile(50).count() / 1000),
+                static_cast<long long>(input_latency.GetPercentile(99).count() / 1000));
+
+            const auto buckets = input_latency.GetBuckets();
+            std::array<float, Core::DurationHistogram::NUM_BUCKETS> values;
+            std::copy(buckets.begin(), buckets.end(), values.begin());
+            ImGui::PlotHistogram("##Input To Present", values.data(),
+                                 static_cast<int>(values.size()), 0, "Input to present (1 ms bins)",
+                                 0.0f, FLT_MAX, ImVec2(0.0f, 50.0f));
+        }
+
         if (ImGui::BeginPopup("Menu")) {
             if (ImGui::BeginMenu("File")) {
                 if (ImGui::MenuItem("Load File")) {
@@ -1455,6 +1490,21 @@ void EmuWindow_SDL2::SwapBuffers() {
                         ImGui::EndTooltip();
                     }
 
+                    if (Settings::values.enable_core_2) {
+                        if (ImGui::Checkbox("Run Cores On Separate Threads",
+                                            &Settings::values.run_cores_on_separate_threads)) {
+                            request_reset = true;
+                        }
+                        if (ImGui::IsItemHovered()) {
+                            ImGui::BeginTooltip();
+                            ImGui::PushTextWrapPos(io.DisplaySize.x * 0.5f);
+                            ImGui::TextUnformatted("Runs both cores at the same time on "
+                                                   "separate host threads. Requires CPU JIT.");
+                            ImGui::PopTextWrapPos();
+                            ImGui::EndTooltip();
+                        }
+                    }
+
                     ImGui::PushTextWrapPos();
                     ImGui::TextUnformatted("If you enable or disable core 2, emulation will "
                                            "restart when the menu is closed.");
@@ -1470,6 +1520,18 @@ void EmuWindow_SDL2::SwapBuffers() {
                     if (Settings::values.limit_speed) {
                         ImGui::InputScalar("Speed Limit", ImGuiDataType_U16,
                                            &Settings::values.speed_limit, nullptr, nullptr, "%d%%");
+                        ImGui::Checkbox("Precise Frame Pacing",
+                                        &Settings::values.precise_frame_pacing);
+                        if (ImGui::IsItemHovered()) {
+                            ImGui::BeginTooltip();
+                            ImGui::PushTextWrapPos(io.DisplaySize.x * 0.5f);
+                            ImGui::TextUnformatted("Sleeps until shortly before the next frame is "
+                                                   "due and waits the rest of the time, which "
+                                                   "uses more CPU but reduces stutter. Without "
+                                                   "VSync, also waits before presenting frames.");
+                            ImGui::PopTextWrapPos();
+                            ImGui::EndTooltip();
+                        }
                     }
 
                     if (Settings::values.use_custom_cpu_ticks) {
@@ -3598,6 +3660,12 @@ void EmuWindow_SDL2::SwapBuffers() {
                             ImGui::EndTooltip();
                         }
 
+                        ImGui::Checkbox("Use Uber Shader While Compiling",
+                                        &Settings::values.use_uber_shader_while_compiling);
+
+                        ImGui::Checkbox("Always Use Uber Shader",
+                                        &Settings::values.always_use_uber_shader);
+
                         ImGui::Checkbox("Use Custom Textures",
                                         &Settings::values.use_custom_textures);
 
@@ -3657,6 +3725,15 @@ void EmuWindow_SDL2::SwapBuffers() {
                             ImGui::EndCombo();
                         }
 
+                        ImGui::Checkbox("Cache Filtered Textures",
+                                        &Settings::values.cache_filtered_textures);
+                        if (ImGui::IsItemHovered()) {
+                            ImGui::BeginTooltip();
+                            ImGui::TextUnformatted("Saves filtered textures to the cache folder "
+                                                   "and reuses them instead of filtering again");
+                            ImGui::EndTooltip();
+                        }
+
                         ImGui::Unindent();
                     }
 
@@ -3980,6 +4057,16 @@ void EmuWindow_SDL2::SwapBuffers() {
 
                 ImGui::Checkbox("Cheats", &show_cheats_window);
 
+                bool gl_call_counters = OpenGL::GLCallCounter::IsEnabled();
+                if (ImGui::Checkbox("GL Call Counters", &gl_call_counters)) {
+                    OpenGL::GLCallCounter::SetEnabled(gl_call_counters);
+                }
+
+                if (ImGui::Checkbox("Frame Pacing", &show_frame_pacing) && show_frame_pacing) {
+                    system.frame_limiter.ResetPacingErrorHistogram();
+                    system.perf_stats->ResetInputLatencyHistogram();
+                }
+
                 if (ImGui::Checkbox("IPC Recorder", &show_ipc_recorder_window)) {
                     if (!show_ipc_recorder_window) {
                         IPC::Recorder& r = system.Kernel().GetIPCRecorder();
@@ -4315,6 +4402,34 @@ void EmuWindow_SDL2::SwapBuffers() {
                     ImGui::EndMenu();
                 }
 
+                if (ImGui::BeginMenu("Frame Dumping")) {
+                    Core::FrameDumper& dumper = Core::System::GetInstance().FrameDumper();
+
+                    const auto start = [&](Core::FrameDumper::Format format) {
+                        const std::string folder = pfd::select_folder("Dump Frames").result();
+                        if (!folder.empty() &&
+                            !dumper.StartDumping(folder, format, GetFramebufferLayout())) {
+                            pfd::message("vvctre", "Failed to start dumping frames",
+                                         pfd::choice::ok, pfd::icon::error);
+                        }
+                    };
+
+                    if (ImGui::MenuItem("Start (PNG Sequence)", nullptr, nullptr,
+                                        !dumper.IsDumping())) {
+                        start(Core::FrameDumper::Format::PNG);
+                    }
+
+                    if (ImGui::MenuItem("Start (Y4M)", nullptr, nullptr, !dumper.IsDumping())) {
+                        start(Core::FrameDumper::Format::Y4M);
+                    }
+
+                    if (ImGui::MenuItem("Stop", nullptr, nullptr, dumper.IsDumping())) {
+                        dumper.StopDumping();
+                    }
+
+                    ImGui::EndMenu();
+                }
+
                 if (ImGui::BeginMenu("Movie")) {
                     auto& movie = Core::Movie::GetInstance();
 
@@ -4395,6 +4510,41 @@ void EmuWindow_SDL2::SwapBuffers() {
                     ImGui::EndMenu();
                 }
 
+                if (ImGui::BeginMenu("GPU Trace")) {
+                    Core::GPUTraceRecorder& recorder = system.GPUTraceRecorder();
+
+                    const auto record = [&](u32 frame_count) {
+                        const std::string path =
+                            pfd::save_file("Record GPU Trace", "trace.vgpt",
+                                           {"GPU Trace", "*.vgpt"})
+                                .result();
+                        if (!path.empty()) {
+                            recorder.Start(path, frame_count);
+                        }
+                    };
+
+                    if (ImGui::MenuItem("Record 1 Frame", nullptr, nullptr,
+                                        !recorder.IsRecording())) {
+                        record(1);
+                    }
+
+                    if (ImGui::MenuItem("Record 10 Frames", nullptr, nullptr,
+                                        !recorder.IsRecording())) {
+                        record(10);
+                    }
+
+                    if (ImGui::MenuItem("Record Until Stopped", nullptr, nullptr,
+                                        !recorder.IsRecording())) {
+                        record(0);
+                    }
+
+                    if (ImGui::MenuItem("Stop", nullptr, nullptr, recorder.IsRecording())) {
+                        recorder.Stop();
+                    }
+
+                    ImGui::EndMenu();
+                }
+
                 ImGui::EndMenu();
             }
 
@@ -5175,6 +5325,15 @@ void EmuWindow_SDL2::SwapBuffers() {
                 }
             }
 
+            ImGui::Checkbox("Run On VBlank", &Settings::values.run_cheats_on_vblank);
+            if (!Settings::values.run_cheats_on_vblank) {
+                if (ImGui::InputScalar("Interval", ImGuiDataType_U64,
+                                       &Settings::values.cheats_run_interval) &&
+                    Settings::values.cheats_run_interval == 0) {
+                    Settings::values.cheats_run_interval = 1;
+                }
+            }
+
             if (ImGui::BeginChildFrame(ImGui::GetID("Cheats"), ImVec2(-1.0f, -1.0f),
                                        ImGuiWindowFlags_HorizontalScrollbar)) {
                 const std::vector<std::shared_ptr<Cheats::CheatBase>>& cheats =
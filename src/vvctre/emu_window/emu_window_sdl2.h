@@ -80,6 +80,9 @@ private:
     // Default: Green
     ImVec4 fps_color{0.0f, 1.0f, 0.0f, 1.0f};
 
+    // Shows the frame pacing error and input latency below the FPS
+    bool show_frame_pacing = false;
+
     // IPC recorder
     IPC::CallbackHandle ipc_recorder_callback;
     std::vector<IPC::RequestRecord> all_ipc_records;
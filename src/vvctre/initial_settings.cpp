@@ -418,6 +418,18 @@ InitialSettings::InitialSettings(PluginManager& plugin_manager, SDL_Window* wind
                         ImGui::PopTextWrapPos();
                         ImGui::EndTooltip();
                     }
+                    if (Settings::values.enable_core_2) {
+                        ImGui::Checkbox("Run Cores On Separate Threads",
+                                        &Settings::values.run_cores_on_separate_threads);
+                        if (ImGui::IsItemHovered()) {
+                            ImGui::BeginTooltip();
+                            ImGui::PushTextWrapPos(io.DisplaySize.x * 0.5f);
+                            ImGui::TextUnformatted("Runs both cores at the same time on "
+                                                   "separate host threads. Requires CPU JIT.");
+                            ImGui::PopTextWrapPos();
+                            ImGui::EndTooltip();
+                        }
+                    }
                     ImGui::Checkbox("Limit Speed", &Settings::values.limit_speed);
                     ImGui::Checkbox("Enable Custom CPU Ticks",
                                     &Settings::values.use_custom_cpu_ticks);
@@ -425,6 +437,18 @@ InitialSettings::InitialSettings(PluginManager& plugin_manager, SDL_Window* wind
                     if (Settings::values.limit_speed) {
                         ImGui::InputScalar("Speed Limit", ImGuiDataType_U16,
                                            &Settings::values.speed_limit, nullptr, nullptr, "%d%%");
+                        ImGui::Checkbox("Precise Frame Pacing",
+                                        &Settings::values.precise_frame_pacing);
+                        if (ImGui::IsItemHovered()) {
+                            ImGui::BeginTooltip();
+                            ImGui::PushTextWrapPos(io.DisplaySize.x * 0.5f);
+                            ImGui::TextUnformatted("Sleeps until shortly before the next frame is "
+                                                   "due and waits the rest of the time, which "
+                                                   "uses more CPU but reduces stutter. Without "
+                                                   "VSync, also waits before presenting frames.");
+                            ImGui::PopTextWrapPos();
+                            ImGui::EndTooltip();
+                        }
                     }
 
                     if (Settings::values.use_custom_cpu_ticks) {
@@ -437,6 +461,15 @@ InitialSettings::InitialSettings(PluginManager& plugin_manager, SDL_Window* wind
                     ImGui::SliderScalar("CPU Clock Percentage", ImGuiDataType_U32,
                                         &Settings::values.cpu_clock_percentage, &min, &max, "%d%%");
 
+                    ImGui::Checkbox("Run Cheats On VBlank", &Settings::values.run_cheats_on_vblank);
+                    if (!Settings::values.run_cheats_on_vblank) {
+                        if (ImGui::InputScalar("Cheats Run Interval", ImGuiDataType_U64,
+                                               &Settings::values.cheats_run_interval) &&
+                            Settings::values.cheats_run_interval == 0) {
+                            Settings::values.cheats_run_interval = 1;
+                        }
+                    }
+
                     ImGui::NewLine();
 
                     ImGui::TextUnformatted("Core::System::Run()");
@@ -2297,6 +2330,12 @@ InitialSettings::InitialSettings(PluginManager& plugin_manager, SDL_Window* wind
                         ImGui::Checkbox("Sharper Distant Objects",
                                         &Settings::values.sharper_distant_objects);
 
+                        ImGui::Checkbox("Use Uber Shader While Compiling",
+                                        &Settings::values.use_uber_shader_while_compiling);
+
+                        ImGui::Checkbox("Always Use Uber Shader",
+                                        &Settings::values.always_use_uber_shader);
+
                         ImGui::Checkbox("Use Custom Textures",
                                         &Settings::values.use_custom_textures);
 
@@ -2355,6 +2394,15 @@ InitialSettings::InitialSettings(PluginManager& plugin_manager, SDL_Window* wind
                             ImGui::EndCombo();
                         }
 
+                        ImGui::Checkbox("Cache Filtered Textures",
+                                        &Settings::values.cache_filtered_textures);
+                        if (ImGui::IsItemHovered()) {
+                            ImGui::BeginTooltip();
+                            ImGui::TextUnformatted("Saves filtered textures to the cache folder "
+                                                   "and reuses them instead of filtering again");
+                            ImGui::EndTooltip();
+                        }
+
                         ImGui::Unindent();
                     }
 
@@ -24,6 +24,9 @@
 #include "core/cheats/cheats.h"
 #include "core/cheats/gateway_cheat.h"
 #include "core/core.h"
+#include "core/frame_dumper.h"
+#include "core/frame_feed.h"
+#include "core/gpu_trace.h"
 #include "core/hle/kernel/ipc_recorder.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cam/cam.h"
@@ -2696,6 +2699,61 @@ void vvctre_movie_stop() {
     Core::Movie::GetInstance().Shutdown();
 }
 
+// Format: 0 = PNG sequence, 1 = Y4M
+bool vvctre_frame_dumping_start(void* core, const char* directory, int format) {
+    Core::System* system = static_cast<Core::System*>(core);
+    return system->FrameDumper().StartDumping(
+        std::string(directory), static_cast<Core::FrameDumper::Format>(format),
+        system->Renderer().GetRenderWindow().GetFramebufferLayout());
+}
+
+bool vvctre_frame_dumping_is_dumping(void* core) {
+    return static_cast<Core::System*>(core)->FrameDumper().IsDumping();
+}
+
+void vvctre_frame_dumping_stop(void* core) {
+    static_cast<Core::System*>(core)->FrameDumper().StopDumping();
+}
+
+// Returns the start of the feed's memory, see core/frame_feed.h for the layout.
+// If name isn't empty, external processes can open the memory as a named shared memory object.
+void* vvctre_frame_feed_start(void* core, const char* name) {
+    Core::System* system = static_cast<Core::System*>(core);
+    Core::FrameFeed& feed = system->FrameFeed();
+    const Layout::FramebufferLayout& layout =
+        system->Renderer().GetRenderWindow().GetFramebufferLayout();
+    if (!feed.Start(std::string(name), layout)) {
+        return nullptr;
+    }
+    return feed.GetMemory();
+}
+
+void* vvctre_frame_feed_get_memory(void* core) {
+    return static_cast<Core::System*>(core)->FrameFeed().GetMemory();
+}
+
+std::size_t vvctre_frame_feed_get_memory_size(void* core) {
+    return static_cast<Core::System*>(core)->FrameFeed().GetMemorySize();
+}
+
+void vvctre_frame_feed_stop(void* core) {
+    static_cast<Core::System*>(core)->FrameFeed().Stop();
+}
+
+// Recording starts at the next VBlank. If frame_count is 0, records until
+// vvctre_gpu_trace_stop is called.
+void vvctre_gpu_trace_start(void* core, const char* path, u32 frame_count) {
+    static_cast<Core::System*>(core)->GPUTraceRecorder().Start(std::string(path), frame_count);
+}
+
+bool vvctre_gpu_trace_is_recording(void* core) {
+    return static_cast<Core::System*>(core)->GPUTraceRecorder().IsRecording();
+}
+
+void vvctre_gpu_trace_stop(void* core) {
+    static_cast<Core::System*>(core)->GPUTraceRecorder().Stop();
+}
+
 void vvctre_set_frame_advancing_enabled(void* core, bool enabled) {
     static_cast<Core::System*>(core)->frame_limiter.SetFrameAdvancing(enabled);
 }
@@ -3084,6 +3142,14 @@ bool vvctre_settings_get_enable_core_2() {
     return Settings::values.enable_core_2;
 }
 
+void vvctre_settings_set_run_cores_on_separate_threads(bool value) {
+    Settings::values.run_cores_on_separate_threads = value;
+}
+
+bool vvctre_settings_get_run_cores_on_separate_threads() {
+    return Settings::values.run_cores_on_separate_threads;
+}
+
 void vvctre_settings_set_limit_speed(bool value) {
     Settings::values.limit_speed = value;
 }
@@ -3092,6 +3158,14 @@ bool vvctre_settings_get_limit_speed() {
     return Settings::values.limit_speed;
 }
 
+void vvctre_settings_set_precise_frame_pacing(bool value) {
+    Settings::values.precise_frame_pacing = value;
+}
+
+bool vvctre_settings_get_precise_frame_pacing() {
+    return Settings::values.precise_frame_pacing;
+}
+
 void vvctre_settings_set_speed_limit(u16 value) {
     Settings::values.speed_limit = value;
 }
@@ -3124,6 +3198,26 @@ u32 vvctre_settings_get_cpu_clock_percentage() {
     return Settings::values.cpu_clock_percentage;
 }
 
+void vvctre_settings_set_run_cheats_on_vblank(bool value) {
+    Settings::values.run_cheats_on_vblank = value;
+}
+
+bool vvctre_settings_get_run_cheats_on_vblank() {
+    return Settings::values.run_cheats_on_vblank;
+}
+
+void vvctre_settings_set_cheats_run_interval(u64 value) {
+    // The cheats can't run every 0 ticks
+    if (value == 0) {
+        return;
+    }
+    Settings::values.cheats_run_interval = value;
+}
+
+u64 vvctre_settings_get_cheats_run_interval() {
+    return Settings::values.cheats_run_interval;
+}
+
 void vvctre_settings_set_core_system_run_default_max_slice_value(s64 value) {
     Settings::values.core_system_run_default_max_slice_value = value;
 }
@@ -3436,6 +3530,22 @@ bool vvctre_settings_get_sharper_distant_objects() {
     return Settings::values.sharper_distant_objects;
 }
 
+void vvctre_settings_set_use_uber_shader_while_compiling(bool value) {
+    Settings::values.use_uber_shader_while_compiling = value;
+}
+
+bool vvctre_settings_get_use_uber_shader_while_compiling() {
+    return Settings::values.use_uber_shader_while_compiling;
+}
+
+void vvctre_settings_set_always_use_uber_shader(bool value) {
+    Settings::values.always_use_uber_shader = value;
+}
+
+bool vvctre_settings_get_always_use_uber_shader() {
+    return Settings::values.always_use_uber_shader;
+}
+
 void vvctre_settings_set_resolution(u16 value) {
     Settings::values.resolution = value;
 }
@@ -3484,6 +3594,14 @@ const char* vvctre_settings_get_texture_filter() {
     return Settings::values.texture_filter.c_str();
 }
 
+void vvctre_settings_set_cache_filtered_textures(bool value) {
+    Settings::values.cache_filtered_textures = value;
+}
+
+bool vvctre_settings_get_cache_filtered_textures() {
+    return Settings::values.cache_filtered_textures;
+}
+
 void vvctre_settings_set_render_3d(Settings::StereoRenderOption value) {
     Settings::values.render_3d = value;
 }
@@ -3891,6 +4009,10 @@ void vvctre_multiplayer_create_room(const char* ip, u16 port, u32 member_slots)
     new Network::Room(ip, port, member_slots);
 }
 
+void vvctre_multiplayer_create_low_latency_room(const char* ip, u16 port, u32 member_slots) {
+    new Network::Room(ip, port, member_slots, true);
+}
+
 void* vvctre_coretiming_register_event(void* core, const char* name,
                                        void (*callback)(std::uintptr_t user_data,
                                                         int cycles_late)) {
@@ -4648,6 +4770,16 @@ std::unordered_map<std::string, void*> PluginManager::function_map = {
     {"vvctre_movie_is_playing", (void*)&vvctre_movie_is_playing},
     {"vvctre_movie_is_recording", (void*)&vvctre_movie_is_recording},
     {"vvctre_movie_stop", (void*)&vvctre_movie_stop},
+    {"vvctre_frame_dumping_start", (void*)&vvctre_frame_dumping_start},
+    {"vvctre_frame_dumping_is_dumping", (void*)&vvctre_frame_dumping_is_dumping},
+    {"vvctre_frame_dumping_stop", (void*)&vvctre_frame_dumping_stop},
+    {"vvctre_frame_feed_start", (void*)&vvctre_frame_feed_start},
+    {"vvctre_frame_feed_get_memory", (void*)&vvctre_frame_feed_get_memory},
+    {"vvctre_frame_feed_get_memory_size", (void*)&vvctre_frame_feed_get_memory_size},
+    {"vvctre_frame_feed_stop", (void*)&vvctre_frame_feed_stop},
+    {"vvctre_gpu_trace_start", (void*)&vvctre_gpu_trace_start},
+    {"vvctre_gpu_trace_is_recording", (void*)&vvctre_gpu_trace_is_recording},
+    {"vvctre_gpu_trace_stop", (void*)&vvctre_gpu_trace_stop},
     {"vvctre_set_frame_advancing_enabled", (void*)&vvctre_set_frame_advancing_enabled},
     {"vvctre_get_frame_advancing_enabled", (void*)&vvctre_get_frame_advancing_enabled},
     {"vvctre_advance_frame", (void*)&vvctre_advance_frame},
@@ -4697,8 +4829,16 @@ std::unordered_map<std::string, void*> PluginManager::function_map = {
     {"vvctre_settings_get_use_cpu_jit", (void*)&vvctre_settings_get_use_cpu_jit},
     {"vvctre_settings_set_enable_core_2", (void*)&vvctre_settings_set_enable_core_2},
     {"vvctre_settings_get_enable_core_2", (void*)&vvctre_settings_get_enable_core_2},
+    {"vvctre_settings_set_run_cores_on_separate_threads",
+     (void*)&vvctre_settings_set_run_cores_on_separate_threads},
+    {"vvctre_settings_get_run_cores_on_separate_threads",
+     (void*)&vvctre_settings_get_run_cores_on_separate_threads},
     {"vvctre_settings_set_limit_speed", (void*)&vvctre_settings_set_limit_speed},
     {"vvctre_settings_get_limit_speed", (void*)&vvctre_settings_get_limit_speed},
+    {"vvctre_settings_set_precise_frame_pacing",
+     (void*)&vvctre_settings_set_precise_frame_pacing},
+    {"vvctre_settings_get_precise_frame_pacing",
+     (void*)&vvctre_settings_get_precise_frame_pacing},
     {"vvctre_settings_set_speed_limit", (void*)&vvctre_settings_set_speed_limit},
     {"vvctre_settings_get_speed_limit", (void*)&vvctre_settings_get_speed_limit},
     {"vvctre_settings_set_use_custom_cpu_ticks", (void*)&vvctre_settings_set_use_custom_cpu_ticks},
@@ -4707,6 +4847,10 @@ std::unordered_map<std::string, void*> PluginManager::function_map = {
     {"vvctre_settings_get_custom_cpu_ticks", (void*)&vvctre_settings_get_custom_cpu_ticks},
     {"vvctre_settings_set_cpu_clock_percentage", (void*)&vvctre_settings_set_cpu_clock_percentage},
     {"vvctre_settings_get_cpu_clock_percentage", (void*)&vvctre_settings_get_cpu_clock_percentage},
+    {"vvctre_settings_set_run_cheats_on_vblank", (void*)&vvctre_settings_set_run_cheats_on_vblank},
+    {"vvctre_settings_get_run_cheats_on_vblank", (void*)&vvctre_settings_get_run_cheats_on_vblank},
+    {"vvctre_settings_set_cheats_run_interval", (void*)&vvctre_settings_set_cheats_run_interval},
+    {"vvctre_settings_get_cheats_run_interval", (void*)&vvctre_settings_get_cheats_run_interval},
     {"vvctre_settings_set_core_system_run_default_max_slice_value",
      (void*)&vvctre_settings_set_core_system_run_default_max_slice_value},
     {"vvctre_settings_get_core_system_run_default_max_slice_value",
@@ -4812,6 +4956,14 @@ std::unordered_map<std::string, void*> PluginManager::function_map = {
      (void*)&vvctre_settings_set_sharper_distant_objects},
     {"vvctre_settings_get_sharper_distant_objects",
      (void*)&vvctre_settings_get_sharper_distant_objects},
+    {"vvctre_settings_set_use_uber_shader_while_compiling",
+     (void*)&vvctre_settings_set_use_uber_shader_while_compiling},
+    {"vvctre_settings_get_use_uber_shader_while_compiling",
+     (void*)&vvctre_settings_get_use_uber_shader_while_compiling},
+    {"vvctre_settings_set_always_use_uber_shader",
+     (void*)&vvctre_settings_set_always_use_uber_shader},
+    {"vvctre_settings_get_always_use_uber_shader",
+     (void*)&vvctre_settings_get_always_use_uber_shader},
     {"vvctre_settings_set_resolution", (void*)&vvctre_settings_set_resolution},
     {"vvctre_settings_get_resolution", (void*)&vvctre_settings_get_resolution},
     {"vvctre_settings_set_background_color_red", (void*)&vvctre_settings_set_background_color_red},
@@ -4830,6 +4982,10 @@ std::unordered_map<std::string, void*> PluginManager::function_map = {
      (void*)&vvctre_settings_get_post_processing_shader},
     {"vvctre_settings_set_texture_filter", (void*)&vvctre_settings_set_texture_filter},
     {"vvctre_settings_get_texture_filter", (void*)&vvctre_settings_get_texture_filter},
+    {"vvctre_settings_set_cache_filtered_textures",
+     (void*)&vvctre_settings_set_cache_filtered_textures},
+    {"vvctre_settings_get_cache_filtered_textures",
+     (void*)&vvctre_settings_get_cache_filtered_textures},
     {"vvctre_settings_set_render_3d", (void*)&vvctre_settings_set_render_3d},
     {"vvctre_settings_get_render_3d", (void*)&vvctre_settings_get_render_3d},
     {"vvctre_settings_set_factor_3d", (void*)&vvctre_settings_set_factor_3d},
@@ -4929,6 +5085,8 @@ std::unordered_map<std::string, void*> PluginManager::function_map = {
     {"vvctre_multiplayer_on_information_change", (void*)&vvctre_multiplayer_on_information_change},
     {"vvctre_multiplayer_on_state_change", (void*)&vvctre_multiplayer_on_state_change},
     {"vvctre_multiplayer_create_room", (void*)&vvctre_multiplayer_create_room},
+    {"vvctre_multiplayer_create_low_latency_room",
+     (void*)&vvctre_multiplayer_create_low_latency_room},
     {"vvctre_coretiming_register_event", (void*)&vvctre_coretiming_register_event},
     {"vvctre_coretiming_remove_event", (void*)&vvctre_coretiming_remove_event},
     {"vvctre_coretiming_schedule_event", (void*)&vvctre_coretiming_schedule_event},
@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include "flags.h"
 
@@ -36,6 +38,7 @@
 #include "common/scope_exit.h"
 #include "core/3ds.h"
 #include "core/core.h"
+#include "core/gpu_trace.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/cfg/cfg.h"
 #include "core/loader/loader.h"
@@ -53,6 +56,14 @@
 #include "vvctre/initial_settings.h"
 #include "vvctre/plugins.h"
 
+#ifdef HAVE_BENCHMARKS
+#include "core/arm/dyncom/arm_dyncom_benchmark.h"
+#include "core/core_timing_benchmark.h"
+#include "core/gdbstub/gdbstub.h"
+#include "core/hle/service/service_benchmark.h"
+#include "network/room_benchmark.h"
+#endif
+
 #ifndef _MSC_VER
 #include <unistd.h>
 #endif
@@ -66,7 +77,190 @@ __declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
 
 static std::function<void()> play_movie_loop_callback;
 
+// Replays a GPU trace and prints the frame and draw timings as CSV
+static int ReplayGPUTrace(Core::System& system, EmuWindow_SDL2& emu_window,
+                          const std::string& path, u32 repeat_count) {
+    Core::GPUTracePlayer player;
+    if (!player.Load(path)) {
+        pfd::message("vvctre",
+                     "Failed to load the GPU trace.\nCheck the console window for more details.",
+                     pfd::choice::ok, pfd::icon::error);
+        return 1;
+    }
+
+    // Only measure the renderer
+    Settings::values.limit_speed = false;
+    Settings::values.enable_disk_shader_cache = false;
+    Settings::values.use_custom_textures = false;
+    SDL_GL_SetSwapInterval(0);
+
+    if (system.InitForGPUTraceReplay(emu_window) != Core::System::ResultStatus::Success) {
+        pfd::message("vvctre", "Failed to initialize the system", pfd::choice::ok,
+                     pfd::icon::error);
+        return 1;
+    }
+
+    const Core::GPUTracePlayer::Report report = player.Replay(repeat_count);
+
+    const auto us = [](std::chrono::nanoseconds time) { return time.count() / 1000.0; };
+    fmt::print("frame,draw,min_us,median_us,max_us\n");
+    std::size_t draw = 0;
+    for (std::size_t frame = 0; frame < report.frames.size(); ++frame) {
+        const Core::GPUTracePlayer::Timing& timing = report.frames[frame];
+        fmt::print("{},,{:.1f},{:.1f},{:.1f}\n", frame, us(timing.min), us(timing.median),
+                   us(timing.max));
+        for (; draw < report.draws.size() && report.draws[draw].frame == frame; ++draw) {
+            const Core::GPUTracePlayer::Timing& draw_timing = report.draws[draw].timing;
+            fmt::print("{},{},{:.1f},{:.1f},{:.1f}\n", frame, draw, us(draw_timing.min),
+                       us(draw_timing.median), us(draw_timing.max));
+        }
+    }
+
+    // On stderr, to keep stdout valid CSV
+    if (report.command_list_words != 0) {
+        const double seconds = std::chrono::duration<double>(report.command_list_time).count();
+        fmt::print(stderr,
+                   "command lists: {}, words: {}, in {:.3f} s ({:.0f} words/s, {:.1f} ns/word)\n",
+                   report.command_lists, report.command_list_words, seconds,
+                   report.command_list_words / seconds,
+                   static_cast<double>(report.command_list_time.count()) /
+                       report.command_list_words);
+    }
+
+    return 0;
+}
+
+#ifdef HAVE_BENCHMARKS
+// Runs the room load generator and prints the results
+static int BenchmarkRoom(const flags::args& args, u32 member_count) {
+    const bool low_latency = args.get<bool>("low-latency", false);
+    const std::optional<Network::RoomBenchmarkResult> result = Network::BenchmarkRoom(
+        args.get<u16>("port", Network::DEFAULT_PORT), member_count, args.get<u32>("rounds", 1000),
+        args.get<std::size_t>("payload-size", 1024), low_latency);
+    if (!result) {
+        fmt::print("Room benchmark failed\n");
+        return 1;
+    }
+
+    const auto us = [](std::chrono::nanoseconds time) { return time.count() / 1000.0; };
+    fmt::print("members: {}, low latency: {}\n", member_count, low_latency);
+    fmt::print("packets sent: {}, received: {}, in {:.3f} s ({:.0f} packets/s)\n",
+               result->packets_sent, result->packets_received, result->seconds,
+               result->packets_per_second);
+    fmt::print("latency min: {:.1f} us, median: {:.1f} us, 99th percentile: {:.1f} us, max: "
+               "{:.1f} us\n",
+               us(result->latency_min), us(result->latency_median),
+               us(result->latency_99th_percentile), us(result->latency_max));
+
+    return 0;
+}
+
+// Runs the interpreter benchmark in ARM and Thumb mode and prints the results
+static int BenchmarkInterpreter(u32 million_instructions) {
+    for (const bool thumb : {false, true}) {
+        const InterpreterBenchmarkResult result =
+            ::BenchmarkInterpreter(million_instructions * u64{1000000}, thumb);
+        fmt::print("{}: {} instructions in {:.3f} s ({:.1f} MIPS)\n", thumb ? "Thumb" : "ARM",
+                   result.instructions, result.seconds, result.mips);
+    }
+
+    return 0;
+}
+
+// Runs the cross-thread timing event queue benchmark and prints the results
+static int BenchmarkTimingQueue(const flags::args& args, u32 producer_count) {
+    const Core::TimingQueueBenchmarkResult result =
+        Core::BenchmarkTimingQueue(producer_count, args.get<u64>("events", 1000000));
+    fmt::print("producers: {}, events: {}\n", producer_count, result.events);
+    fmt::print("bounded queue: {:.3f} s ({:.0f} events/s), {} events overflowed\n",
+               result.bounded_seconds, result.bounded_events_per_second,
+               result.overflowed_events);
+    fmt::print("locked queue: {:.3f} s ({:.0f} events/s)\n", result.locked_seconds,
+               result.locked_events_per_second);
+
+    return 0;
+}
+
+// Runs the timing event queue benchmark and prints the results
+static int BenchmarkEventQueue(const flags::args& args, u32 million_operations) {
+    const Core::EventQueueBenchmarkResult result = Core::BenchmarkEventQueue(
+        million_operations * u64{1000000}, args.get<u32>("userdata-per-type", 4));
+    fmt::print("operations: {}\n", result.operations);
+    fmt::print("indexed queue: {:.3f} s, heap: {:.3f} s\n", result.indexed_seconds,
+               result.heap_seconds);
+    if (!result.same_order) {
+        fmt::print("The queues popped the events in different orders\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+// Runs the service dispatch benchmark and prints the results
+static int BenchmarkServiceDispatch(const flags::args& args, u32 million_requests) {
+    const u32 command_count = args.get<u32>("commands", 64);
+    const Service::ServiceDispatchBenchmarkResult result =
+        Service::BenchmarkServiceDispatch(million_requests * u64{1000000}, command_count);
+    fmt::print("commands: {}\n", command_count);
+    fmt::print("requests: {} in {:.3f} s ({:.0f} round trips/s)\n", result.requests,
+               result.seconds, result.requests_per_second);
+    if (result.failed_requests != 0) {
+        fmt::print("{} requests got the wrong response\n", result.failed_requests);
+        return 1;
+    }
+
+    return 0;
+}
+
+// Runs the gdbstub memory transfer benchmark and prints the results
+static int BenchmarkGdbStub(const flags::args& args, u32 mebibytes) {
+    const GDBStub::MemoryTransferBenchmarkResult result = GDBStub::BenchmarkMemoryTransfer(
+        mebibytes * 0x100000, args.get<u32>("breakpoints", 16));
+    const auto print = [&](const char* name, double seconds, u64 packets) {
+        fmt::print("{}: {:.3f} s ({:.1f} MiB/s), {} packets\n", name, seconds,
+                   result.bytes / seconds / 0x100000, packets);
+    };
+    fmt::print("bytes: {}\n", result.bytes);
+    print("m replies before", result.nibble_seconds, result.nibble_packets);
+    print("m replies", result.hex_seconds, result.hex_packets);
+    print("x replies", result.binary_seconds, result.binary_packets);
+    fmt::print("read breakpoint checks: {} in {:.3f} s ({:.0f} checks/s)\n",
+               result.breakpoint_checks, result.breakpoint_seconds,
+               result.breakpoint_checks / result.breakpoint_seconds);
+    if (result.breakpoint_hits != result.breakpoint_checks) {
+        fmt::print("{} of the words weren't covered by a breakpoint\n",
+                   result.breakpoint_checks - result.breakpoint_hits);
+        return 1;
+    }
+
+    return 0;
+}
+#endif // HAVE_BENCHMARKS
+
 int main(int argc, char** argv) {
+    const flags::args args(argc, argv);
+#ifdef HAVE_BENCHMARKS
+    if (const std::optional<u32> member_count = args.get<u32>("benchmark-room")) {
+        return BenchmarkRoom(args, *member_count);
+    }
+    if (const std::optional<u32> million_instructions = args.get<u32>("benchmark-interpreter")) {
+        return BenchmarkInterpreter(*million_instructions);
+    }
+    if (const std::optional<u32> producer_count = args.get<u32>("benchmark-timing-queue")) {
+        return BenchmarkTimingQueue(args, *producer_count);
+    }
+    if (const std::optional<u32> million_operations = args.get<u32>("benchmark-event-queue")) {
+        return BenchmarkEventQueue(args, *million_operations);
+    }
+    if (const std::optional<u32> million_requests =
+            args.get<u32>("benchmark-service-dispatch")) {
+        return BenchmarkServiceDispatch(args, *million_requests);
+    }
+    if (const std::optional<u32> mebibytes = args.get<u32>("benchmark-gdbstub")) {
+        return BenchmarkGdbStub(args, *mebibytes);
+    }
+#endif
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
         pfd::message("vvctre", fmt::format("Failed to initialize SDL2: {}", SDL_GetError()),
                      pfd::choice::ok, pfd::icon::error);
@@ -134,7 +328,6 @@ int main(int argc, char** argv) {
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
     Core::System& system = Core::System::GetInstance();
-    const flags::args args(argc, argv);
     PluginManager plugin_manager(system, window, args);
     system.SetEmulationStartingAfterFirstTime(
         [&plugin_manager] { plugin_manager.EmulationStartingAfterFirstTime(); });
@@ -174,7 +367,10 @@ int main(int argc, char** argv) {
     plugin_manager.InitialSettingsOpening();
     std::atomic<bool> update_found{false};
     bool ok_multiplayer = false;
-    if (args.positional().empty()) {
+    const std::optional<std::string> gpu_trace = args.get<std::string>("replay-gpu-trace");
+    if (gpu_trace) {
+        Settings::Apply();
+    } else if (args.positional().empty()) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
             ImGui_ImplSDL2_ProcessEvent(&event);
@@ -455,6 +651,13 @@ int main(int argc, char** argv) {
     system.RegisterMiiSelector(std::make_shared<Frontend::SDL2_MiiSelector>(*emu_window));
     Camera::RegisterFactory("image", std::make_unique<Camera::ImageCameraFactory>());
 
+    if (gpu_trace) {
+        const int result = ReplayGPUTrace(system, *emu_window, *gpu_trace,
+                                          args.get<u32>("replay-count", 10));
+        vvctreShutdown(&plugin_manager);
+        return result;
+    }
+
     plugin_manager.BeforeLoading();
     cfg.reset();
     plugin_manager.cfg = nullptr;